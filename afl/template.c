@@ -18,40 +18,40 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <wchar.h>
+#include <string.h>
 #include <err.h>
 #include <locale.h>
 
 #include "prwd.h"
 #include "template.h"
 
-extern wchar_t cfg_template[MAX_OUTPUT_LEN];
-wchar_t	 home[MAXPATHLEN];
+extern char cfg_template[MAX_OUTPUT_LEN];
+char	 home[MAXPATHLEN];
 
 
 static void
-prwd_template(wchar_t *t)
+prwd_template(char *t)
 {
-	wchar_t output[MAX_OUTPUT_LEN];
+	char output[MAX_OUTPUT_LEN];
 	int i;
-	const wchar_t *errstr;
+	const char *errstr;
 
 	i = template_render(t, output, MAX_OUTPUT_LEN, &errstr);
 	if (errstr != NULL)
-		errx(1, "template error: %ls", errstr);
+		errx(1, "template error: %s", errstr);
 
-	wprintf(L"%ls\n", output);
+	printf("%s\n", output);
 }
 
 int
 main(void)
 {
-	char buf[4096];
+	size_t n;
 
 	setlocale(LC_ALL, "");
 
-	fread(buf, sizeof(char), 4096, stdin);
-	mbstowcs(cfg_template, buf, MAX_OUTPUT_LEN);
+	n = fread(cfg_template, sizeof(char), MAX_OUTPUT_LEN - 1, stdin);
+	cfg_template[n] = '\0';
 
 	prwd_template(cfg_template);
 
@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Benchmark of the hot paths of prwd on synthetic environments: deep trees,
+ * git and mercurial repositories, a git worktree, many tags in packed-refs and
+ * a full set of nested aliases.  Each benchmark runs a number of iterations
+ * from a cold state (no facts, no memoized commands) and its latency
+ * percentiles are written one line per benchmark, to be compared between
+ * commits:
+ *
+ *	# name iterations min p50 p90 p99 max (nanoseconds)
+ *	render-git 2000 10250 10870 11950 15431 40210
+ */
+
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <err.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "alias.h"
+#include "cmd-path.h"
+#include "facts.h"
+#include "findr.h"
+#include "prwd.h"
+#include "strlcpy.h"
+#include "strtonum.h"
+#include "template.h"
+
+#define DEFAULT_ITERATIONS	2000
+#define MAX_ITERATIONS		100000
+#define TREE_DEPTH		40
+#define TAG_COUNT		5000
+#define BENCH_TEMPLATE		"${hostname}:${branch}${sep :}${path -l 24}${uid} "
+
+char	 home[MAXPATHLEN];
+
+static char	 fixture[MAXPATHLEN];
+static char	 deep_leaf[MAXPATHLEN];
+static char	 git_leaf[MAXPATHLEN];
+static char	 worktree_leaf[MAXPATHLEN];
+static char	 hg_leaf[MAXPATHLEN];
+static size_t	 iterations = DEFAULT_ITERATIONS;
+static long long samples[MAX_ITERATIONS];
+static FILE	*results;
+
+static long long
+now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((long long)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+static int
+cmp_samples(const void *a, const void *b)
+{
+	long long x = *(const long long *)a, y = *(const long long *)b;
+
+	return ((x > y) - (x < y));
+}
+
+/*
+ * Run fn for all the iterations and write the latency percentiles of the
+ * benchmark to the results.
+ */
+static void
+bench_run(const char *name, void (*fn)(void))
+{
+	long long start;
+	size_t i;
+
+	for (i = 0; i < iterations; i++) {
+		start = now_ns();
+		fn();
+		samples[i] = now_ns() - start;
+	}
+
+	qsort(samples, iterations, sizeof(samples[0]), cmp_samples);
+	fprintf(results, "%s %zu %lld %lld %lld %lld %lld\n", name,
+	    iterations, samples[0], samples[iterations / 2],
+	    samples[iterations * 90 / 100], samples[iterations * 99 / 100],
+	    samples[iterations - 1]);
+	fprintf(stderr, "%-24s p50 %8lldns  p99 %8lldns\n", name,
+	    samples[iterations / 2], samples[iterations * 99 / 100]);
+}
+
+/*
+ * Fixtures
+ */
+
+static void
+write_file(const char *dir, const char *name, const char *content)
+{
+	char path[MAXPATHLEN];
+	FILE *fp;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	if ((fp = fopen(path, "w")) == NULL)
+		err(1, "%s", path);
+	fputs(content, fp);
+	fclose(fp);
+}
+
+/*
+ * Append s to the path, there is no strlcat(3) everywhere.
+ */
+static void
+strlcat_path(char *path, const char *s, size_t len)
+{
+	size_t n = strlen(path);
+
+	strlcpy(path + n, s, len - n);
+}
+
+/*
+ * Create 'depth' nested directories under base, path is set to the deepest.
+ */
+static void
+make_tree(const char *base, size_t depth, char *path, size_t len)
+{
+	char name[16];
+	size_t i;
+
+	strlcpy(path, base, len);
+	mkdir(path, 0700);
+	for (i = 0; i < depth; i++) {
+		snprintf(name, sizeof(name), "/dir%02zu", i);
+		strlcat_path(path, name, len);
+		if (mkdir(path, 0700) == -1)
+			err(1, "mkdir %s", path);
+	}
+}
+
+/*
+ * Pretend the fixtures were created a while ago, the directories modified
+ * within the last second are never cached.
+ */
+static int
+age_entry(const char *path, const struct stat *sb, int flag,
+    struct FTW *ftw)
+{
+	struct timeval tv[2];
+
+	(void)sb;
+	(void)flag;
+	(void)ftw;
+	tv[0].tv_sec = tv[1].tv_sec = time(NULL) - 60;
+	tv[0].tv_usec = tv[1].tv_usec = 0;
+	utimes(path, tv);
+
+	return (0);
+}
+
+static void
+make_fixtures(void)
+{
+	char dir[MAXPATHLEN], path[MAXPATHLEN];
+	FILE *fp;
+	size_t i;
+
+	strlcpy(fixture, "/tmp/prwd-bench-XXXXXX", sizeof(fixture));
+	if (mkdtemp(fixture) == NULL)
+		err(1, "mkdtemp");
+
+	snprintf(dir, sizeof(dir), "%s/deep", fixture);
+	make_tree(dir, TREE_DEPTH, deep_leaf, sizeof(deep_leaf));
+
+	/* A git repository with a lot of tags. */
+	snprintf(dir, sizeof(dir), "%s/git", fixture);
+	make_tree(dir, TREE_DEPTH / 4, git_leaf, sizeof(git_leaf));
+	strlcat_path(dir, "/.git", sizeof(dir));
+	mkdir(dir, 0700);
+	write_file(dir, "HEAD", "ref: refs/heads/master\n");
+	snprintf(path, sizeof(path), "%s/packed-refs", dir);
+	if ((fp = fopen(path, "w")) == NULL)
+		err(1, "%s", path);
+	fputs("# pack-refs with: peeled fully-peeled sorted\n", fp);
+	for (i = 0; i < TAG_COUNT; i++)
+		fprintf(fp, "%040zx refs/tags/v%zu.%zu\n", i, i / 100, i % 100);
+	fclose(fp);
+
+	/* A worktree of the above, its .git is a file. */
+	snprintf(dir, sizeof(dir), "%s/worktree", fixture);
+	make_tree(dir, TREE_DEPTH / 4, worktree_leaf, sizeof(worktree_leaf));
+	snprintf(path, sizeof(path), "gitdir: %s/git/.git/worktrees/wt\n",
+	    fixture);
+	write_file(dir, ".git", path);
+
+	/* A mercurial repository. */
+	snprintf(dir, sizeof(dir), "%s/hg", fixture);
+	make_tree(dir, TREE_DEPTH / 4, hg_leaf, sizeof(hg_leaf));
+	strlcat_path(dir, "/.hg", sizeof(dir));
+	mkdir(dir, 0700);
+	write_file(dir, "branch", "default\n");
+
+	nftw(fixture, age_entry, 16, FTW_PHYS);
+}
+
+/*
+ * As many aliases as we can hold, each one nested in the previous one along
+ * the deep tree.
+ */
+static void
+make_aliases(void)
+{
+	char name[ALIAS_NAME_LEN], value[MAXPATHLEN];
+	const char *errstr;
+	size_t i;
+
+	/* The table keeps a slot for "~". */
+	for (i = 0; i < MAX_ALIASES - 1; i++) {
+		snprintf(name, sizeof(name), "$a%02zu", i);
+		if (i == 0)
+			snprintf(value, sizeof(value), "%s/deep", fixture);
+		else if (i <= TREE_DEPTH)
+			snprintf(value, sizeof(value), "$a%02zu/dir%02zu",
+			    i - 1, i - 1);
+		else
+			snprintf(value, sizeof(value), "%s/elsewhere/%zu",
+			    fixture, i);
+		alias_add(name, value, &errstr);
+		if (errstr != NULL)
+			errx(1, "alias_add %s: %s", name, errstr);
+	}
+}
+
+static int
+remove_entry(const char *path, const struct stat *sb, int flag,
+    struct FTW *ftw)
+{
+	(void)sb;
+	(void)flag;
+	(void)ftw;
+	return (remove(path));
+}
+
+/*
+ * Benchmarks
+ */
+
+static void
+bench_render(void)
+{
+	char out[MAX_OUTPUT_LEN];
+	const char *errstr;
+
+	facts_purge_all();
+	template_memo_purge_all();
+	if (template_render(BENCH_TEMPLATE, out, sizeof(out), &errstr) == -1)
+		errx(1, "template error: %s", errstr);
+}
+
+static void
+bench_alias_replace(void)
+{
+	char out[MAXPATHLEN];
+
+	alias_replace_recursive(out, deep_leaf, sizeof(out));
+}
+
+static struct path_index pi;
+
+static void
+bench_path_cleancut(void)
+{
+	char out[MAX_OUTPUT_LEN];
+
+	path_index_build(&pi, deep_leaf);
+	path_cleancut(out, &pi, sizeof(out), 24, "...");
+}
+
+static void
+bench_path_quickcut(void)
+{
+	char out[MAX_OUTPUT_LEN];
+
+	path_index_build(&pi, deep_leaf);
+	path_quickcut(out, &pi, sizeof(out), 24, "...");
+}
+
+static void
+bench_path_newsgroupize(void)
+{
+	char out[MAX_OUTPUT_LEN];
+
+	path_index_build(&pi, deep_leaf);
+	path_newsgroupize(out, &pi, sizeof(out));
+}
+
+static void
+bench_path_uniqueize(void)
+{
+	char out[MAX_OUTPUT_LEN];
+
+	path_index_build(&pi, deep_leaf);
+	path_uniqueize(out, &pi, deep_leaf, sizeof(out));
+}
+
+static void
+bench_findr(void)
+{
+	facts_purge_all();
+	findr(NULL);
+}
+
+static void
+bench_findr_target(void)
+{
+	facts_purge_all();
+	findr("packed-refs");
+}
+
+/*
+ * Move to the given directory the way a shell would.
+ */
+static void
+enter(const char *dir)
+{
+	if (chdir(dir) == -1)
+		err(1, "chdir %s", dir);
+	setenv("PWD", dir, 1);
+}
+
+int
+main(int argc, char **argv)
+{
+	char runtime[MAXPATHLEN];
+	const char *errstr, *output = "bench_output.txt";
+	int ch, devnull, saved;
+
+	while ((ch = getopt(argc, argv, "n:o:")) != -1) {
+		switch (ch) {
+		case 'n':
+			iterations = strtonum(optarg, 1, MAX_ITERATIONS,
+			    &errstr);
+			if (errstr != NULL)
+				errx(1, "iterations %s: %s", optarg, errstr);
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		default:
+			fprintf(stderr, "usage: bench [-n iterations] "
+			    "[-o output]\n");
+			return (1);
+		}
+	}
+
+	setlocale(LC_ALL, "");
+
+	make_fixtures();
+	strlcpy(home, fixture, sizeof(home));
+	snprintf(runtime, sizeof(runtime), "%s/run", fixture);
+	mkdir(runtime, 0700);
+	setenv("XDG_RUNTIME_DIR", runtime, 1);
+
+	if ((results = fopen(output, "w")) == NULL)
+		err(1, "%s", output);
+	fprintf(results, "# prwd %s, %zu iterations\n", VERSION, iterations);
+	fprintf(results, "# name iterations min p50 p90 p99 max "
+	    "(nanoseconds)\n");
+
+	enter(deep_leaf);
+	bench_run("render-deep", bench_render);
+	enter(git_leaf);
+	bench_run("render-git", bench_render);
+	enter(worktree_leaf);
+	bench_run("render-worktree", bench_render);
+	enter(hg_leaf);
+	bench_run("render-hg", bench_render);
+
+	bench_run("path-cleancut", bench_path_cleancut);
+	bench_run("path-quickcut", bench_path_quickcut);
+	bench_run("path-newsgroupize", bench_path_newsgroupize);
+	bench_run("path-uniqueize", bench_path_uniqueize);
+
+	make_aliases();
+	bench_run("alias-replace", bench_alias_replace);
+	enter(deep_leaf);
+	bench_run("render-deep-aliases", bench_render);
+
+	/* findr prints the root it found, keep it out of the way. */
+	enter(git_leaf);
+	fflush(stdout);
+	saved = dup(STDOUT_FILENO);
+	if ((devnull = open("/dev/null", O_WRONLY)) == -1)
+		err(1, "/dev/null");
+	dup2(devnull, STDOUT_FILENO);
+	bench_run("findr", bench_findr);
+	bench_run("findr-target", bench_findr_target);
+	fflush(stdout);
+	dup2(saved, STDOUT_FILENO);
+	close(devnull);
+	close(saved);
+
+	fclose(results);
+
+	if (chdir("/") == 0)
+		nftw(fixture, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+
+	return (0);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Every line of the input but the last one is an alias ("name path"), the
+ * last line is the path given to alias_replace_recursive().
+ */
+
+#include <sys/param.h>
+
+#include <string.h>
+
+#include "alias.h"
+#include "fuzz.h"
+
+char	 home[MAXPATHLEN];
+
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	char line[MAXPATHLEN], out[MAXPATHLEN], *path;
+	const char *errstr;
+	size_t i, n;
+
+	alias_purge_all();
+
+	for (i = 0; i < size; i += n + 1) {
+		for (n = 0; i + n < size && data[i + n] != '\n'; n++)
+			;
+		if (n >= sizeof(line))
+			return (0);
+		memcpy(line, data + i, n);
+		line[n] = '\0';
+
+		/* The last line is the path. */
+		if (i + n >= size) {
+			alias_replace_recursive(out, line, sizeof(out));
+			break;
+		}
+
+		if ((path = strchr(line, ' ')) == NULL)
+			continue;
+		*path++ = '\0';
+		alias_add(line, path, &errstr);
+	}
+
+	return (0);
+}
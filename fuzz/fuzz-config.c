@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Feed each line of the input to process_config_line(), the way read_config()
+ * does, starting from an empty configuration every time.
+ */
+
+#include <sys/param.h>
+
+#include <string.h>
+
+#include "alias.h"
+#include "config.h"
+#include "context.h"
+#include "fuzz.h"
+#include "prwd.h"
+
+extern char	 cfg_template[MAX_OUTPUT_LEN];
+extern char	 cfg_rtemplate[MAX_OUTPUT_LEN];
+extern char	 cfg_title[MAX_OUTPUT_LEN];
+
+char	 home[MAXPATHLEN] = "/home/fuzz";
+
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	char line[MAX_OUTPUT_LEN];
+	const char *errstr;
+	size_t i, n;
+
+	alias_purge_all();
+	context_purge_all();
+	cfg_template[0] = cfg_rtemplate[0] = cfg_title[0] = '\0';
+
+	for (i = 0; i < size; i += n + 1) {
+		for (n = 0; i + n < size && data[i + n] != '\n'; n++)
+			;
+		if (n >= sizeof(line))
+			continue;
+		memcpy(line, data + i, n);
+		line[n] = '\0';
+		process_config_line(line, &errstr);
+	}
+
+	return (0);
+}
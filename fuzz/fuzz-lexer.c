@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * template_variable_lexer() on the raw input: the command is a span which is
+ * not NUL-terminated, any read past its end is caught by the sanitizers.
+ */
+
+#include <sys/param.h>
+
+#include "fuzz.h"
+#include "arena.h"
+#include "template.h"
+
+char	 home[MAXPATHLEN];
+
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	struct arglist al;
+	const char *errstr;
+	size_t mark;
+
+	mark = arena_mark();
+	template_arglist_init(&al);
+	template_variable_lexer((const char *)data, size, &al, &errstr);
+	arena_release(mark);
+
+	return (0);
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Shorten the input path with all the path functions, the first byte of the
+ * input is the maximum length.
+ */
+
+#include <sys/param.h>
+
+#include <string.h>
+
+#include "cmd-path.h"
+#include "fuzz.h"
+#include "prwd.h"
+
+char	 home[MAXPATHLEN];
+
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	char path[MAX_OUTPUT_LEN], out[MAX_OUTPUT_LEN];
+	struct path_index pi;
+	size_t maxlen;
+
+	if (size < 1 || size - 1 >= sizeof(path))
+		return (0);
+	maxlen = data[0];
+	memcpy(path, data + 1, size - 1);
+	path[size - 1] = '\0';
+
+	path_index_build(&pi, path);
+	path_cleancut(out, &pi, sizeof(out), maxlen, "...");
+	path_quickcut(out, &pi, sizeof(out), maxlen, "...");
+	path_newsgroupize(out, &pi, sizeof(out));
+
+	return (0);
+}
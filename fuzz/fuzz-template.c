@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Tokenize and render a whole template.  Templates running  are
+ * skipped, the fuzzer would end up running arbitrary commands.
+ */
+
+#include <sys/param.h>
+
+#include <string.h>
+
+#include "facts.h"
+#include "fuzz.h"
+#include "prwd.h"
+#include "template.h"
+
+char	 home[MAXPATHLEN];
+
+static char	 tmpl[MAX_FUZZ_INPUT + 1];
+
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	char out[MAX_OUTPUT_LEN];
+	struct token tok;
+	const char *errstr;
+	size_t pos = 0;
+
+	if (size > MAX_FUZZ_INPUT)
+		return (0);
+	memcpy(tmpl, data, size);
+	tmpl[size] = '\0';
+	if (strstr(tmpl, "exec") != NULL)
+		return (0);
+
+	while (template_tokenize(tmpl, &pos, &tok))
+		;
+
+	facts_purge_all();
+	template_memo_purge_all();
+	template_render(tmpl, out, sizeof(out), &errstr);
+
+	return (0);
+}
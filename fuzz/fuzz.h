@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Shared by the in-process fuzz targets: each of them defines
+ * LLVMFuzzerTestOneInput(), which libFuzzer calls for every input.  The same
+ * targets link with replay.c to run a corpus without libFuzzer.
+ */
+
+#ifndef _FUZZ_H_
+#define _FUZZ_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Largest input given to the targets, larger ones are ignored. */
+#define MAX_FUZZ_INPUT (64 * 1024)
+
+int	 LLVMFuzzerTestOneInput(const uint8_t *, size_t);
+
+#endif /* ifndef _FUZZ_H_ */
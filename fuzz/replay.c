@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Minimal driver replacing libFuzzer: feed the files given as arguments to the
+ * fuzz target, one input per file.  This is how the corpora are replayed with
+ * compilers that do not ship libFuzzer.
+ */
+
+#include <err.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fuzz.h"
+
+static uint8_t	 input[MAX_FUZZ_INPUT];
+
+int
+main(int argc, char **argv)
+{
+	FILE *fp;
+	size_t n;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if ((fp = fopen(argv[i], "r")) == NULL)
+			err(1, "%s", argv[i]);
+		n = fread(input, 1, sizeof(input), fp);
+		fclose(fp);
+		LLVMFuzzerTestOneInput(input, n);
+	}
+
+	printf("%d inputs\n", argc - 1);
+
+	return (0);
+}
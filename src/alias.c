@@ -17,12 +17,14 @@
 #include <sys/param.h>
 
 #include <err.h>
-#include <wchar.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "alias.h"
+#include "arena.h"
 #include "prwd.h"
 #include "utils.h"
-#include "wcslcpy.h"
+#include "strlcpy.h"
 
 
 struct alias aliases[MAX_ALIASES];
@@ -34,32 +36,32 @@ int alias_count = 0;
  * error occured and the alias was not added.
  */
 void
-alias_add(wchar_t *name, wchar_t *path, const wchar_t **errstrp)
+alias_add(char *name, char *path, const char **errstrp)
 {
 	*errstrp = NULL;
 
 	if (alias_count >= MAX_ALIASES - 1) {
-		*errstrp = L"too many aliases";
+		*errstrp = "too many aliases";
 		return;
 	}
 
-	if (wcslen(path) > (MAXPATHLEN - 1)) {
-		*errstrp = L"alias path is too long";
+	if (strlen(path) > (MAXPATHLEN - 1)) {
+		*errstrp = "alias path is too long";
 		return;
 	}
 
-	if (wcslen(path) < wcslen(name)) {
-		*errstrp = L"alias name longer than its path";
+	if (strlen(path) < strlen(name)) {
+		*errstrp = "alias name longer than its path";
 		return;
 	}
 
-	if (wcschr(name, '/') != NULL) {
-		*errstrp = L"alias name contains '/'";
+	if (strchr(name, '/') != NULL) {
+		*errstrp = "alias name contains '/'";
 		return;
 	}
 
-	wcslcpy(aliases[alias_count].name, name, ALIAS_NAME_LEN);
-	wcslcpy(aliases[alias_count].path, path, MAXPATHLEN);
+	strlcpy(aliases[alias_count].name, name, ALIAS_NAME_LEN);
+	strlcpy(aliases[alias_count].path, path, MAXPATHLEN);
 	alias_count++;
 }
 
@@ -77,13 +79,13 @@ alias_purge_all()
  * Return an alias given its name or NULL if not found.
  */
 struct alias *
-alias_get(wchar_t *name)
+alias_get(char *name)
 {
 	int i;
 	struct alias *alias = NULL;
 
 	for (i = 0; i < alias_count; i++) {
-		if (wcscmp(aliases[i].name, name) == 0) {
+		if (strcmp(aliases[i].name, name) == 0) {
 			alias = &aliases[i];
 			break;
 		}
@@ -97,10 +99,10 @@ alias_get(wchar_t *name)
  * could become "/var/lib/foo/fruits".
  */
 void
-alias_expand_prefix(wchar_t *input, wchar_t *output)
+alias_expand_prefix(char *input, char *output)
 {
 	struct alias *alias;
-	wchar_t name[MAX_OUTPUT_LEN];
+	char name[MAX_OUTPUT_LEN];
 	size_t i = 0;
 
 	tokcpy(input, name);
@@ -109,14 +111,14 @@ alias_expand_prefix(wchar_t *input, wchar_t *output)
 	if (alias == NULL)
 		goto finish;
 
-	i = wcslcpy(output, alias->path, MAX_OUTPUT_LEN);
+	i = strlcpy(output, alias->path, MAX_OUTPUT_LEN);
 	if (i >= MAX_OUTPUT_LEN)
 		return;
 
-	input += wcslen(alias->name);
+	input += strlen(alias->name);
 
 finish:
-	wcslcpy(output + i, input, MAX_OUTPUT_LEN - i);
+	strlcpy(output + i, input, MAX_OUTPUT_LEN - i);
 }
 
 /*
@@ -129,7 +131,7 @@ finish:
  * returns NULL if no alias was found.
  */
 struct alias *
-alias_get_by_path(wchar_t *path)
+alias_get_by_path(char *path)
 {
 	struct alias *alias = NULL;
 	size_t len, max;
@@ -137,8 +139,8 @@ alias_get_by_path(wchar_t *path)
 
 	max = 0;
 	for (i = 0; i < alias_count; i++) {
-		len = wcslen(aliases[i].path);
-		if (wcsncmp(aliases[i].path, path, len) == 0) {
+		len = strlen(aliases[i].path);
+		if (strncmp(aliases[i].path, path, len) == 0) {
 			if (len > max) {
 				alias = &aliases[i];
 				max = len;
@@ -161,16 +163,16 @@ void
 alias_dump_vars(void)
 {
 	int i;
-	wchar_t path[MAX_OUTPUT_LEN], output[MAX_OUTPUT_LEN];
+	char path[MAX_OUTPUT_LEN], output[MAX_OUTPUT_LEN];
 
 	for (i = 0; i < alias_count; i++) {
 		if (aliases[i].name[0] == '$') {
-			wcslcpy(path, aliases[i].path, MAX_OUTPUT_LEN);
+			strlcpy(path, aliases[i].path, MAX_OUTPUT_LEN);
 			alias_expand_prefix(path, output);
-			if (!wc_path_is_valid(output))
+			if (!path_is_valid(output))
 				continue;
 			/* Skip the '$' */
-			wprintf(L"export %ls=\"%ls\"\n", aliases[i].name + 1,
+			printf("export %s=\"%s\"\n", aliases[i].name + 1,
 					output);
 		}
 	}
@@ -180,42 +182,52 @@ alias_dump_vars(void)
  * Find the best match to get the shortest path as possible.
  */
 void
-alias_replace(wchar_t *out, wchar_t *path, size_t len)
+alias_replace(char *out, char *path, size_t len)
 {
 	size_t nlen, plen;
 	struct alias *alias;
 
 	alias = alias_get_by_path(path);
 	if (alias == NULL) {
-		wcslcpy(out, path, len);
+		strlcpy(out, path, len);
 		return;
 	}
 
-	plen = wcslen(alias->path);
-	nlen = wcslen(alias->name);
+	plen = strlen(alias->path);
+	nlen = strlen(alias->name);
 
-	if (wcslcpy(out, alias->name, len) != nlen)
+	if (strlcpy(out, alias->name, len) != nlen)
 		return;
 
-	wcslcpy(out + nlen, path + plen, len - nlen);
+	strlcpy(out + nlen, path + plen, len - nlen);
 }
 
 /*
  * Keep on calling alias_replace until we are done finding aliases.
  */
 void
-alias_replace_recursive(wchar_t *out, wchar_t *path, size_t len)
+alias_replace_recursive(char *out, const char *path, size_t len)
 {
-	wchar_t buf[MAXPATHLEN], *s = path;
+	const char *s = path;
+	size_t mark;
+	char *buf;
 	int i;
 
+	mark = arena_mark();
+	if ((buf = arena_alloc(len)) == NULL) {
+		strlcpy(out, path, len);
+		return;
+	}
+
 	for (i = 0; i < 100; i++) {
-		wcslcpy(buf, s, len);
+		strlcpy(buf, s, len);
 		alias_replace(out, buf, len);
-		if (wcscmp(buf, out) == 0)
-			return;
+		if (strcmp(buf, out) == 0)
+			break;
 		s = out;
 	}
+	arena_release(mark);
 
-	warnx("reached maximum alias_replace() recursion");
+	if (i == 100)
+		warnx("reached maximum alias_replace() recursion");
 }
@@ -19,23 +19,21 @@
 
 #include <sys/param.h>
 
-#include <wchar.h>
-
 #define MAX_ALIASES 64
 #define ALIAS_NAME_LEN 32
 
 struct alias {
-	wchar_t	name[ALIAS_NAME_LEN];
-	wchar_t	path[MAXPATHLEN];
+	char	name[ALIAS_NAME_LEN];
+	char	path[MAXPATHLEN];
 };
 
-void		 alias_add(wchar_t *, wchar_t *, const wchar_t **);
+void		 alias_add(char *, char *, const char **);
 void		 alias_purge_all(void);
-void		 alias_expand_prefix(wchar_t *, wchar_t *);
+void		 alias_expand_prefix(char *, char *);
 void		 alias_dump_vars(void);
-struct alias 	*alias_get(wchar_t *);
-struct alias	*alias_get_by_path(wchar_t *);
-void		 alias_replace(wchar_t *, wchar_t *, size_t);
-void		 alias_replace_recursive(wchar_t *, wchar_t *, size_t);
+struct alias 	*alias_get(char *);
+struct alias	*alias_get_by_path(char *);
+void		 alias_replace(char *, char *, size_t);
+void		 alias_replace_recursive(char *, const char *, size_t);
 
 #endif /* ifndef _ALIAS_H_ */
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stddef.h>
+
+#include "arena.h"
+
+static union {
+	char		 buf[ARENA_SIZE];
+	long double	 ld;
+	long long	 ll;
+	void		*p;
+} arena;
+
+static size_t used = 0;
+
+/*
+ * Return len bytes of uninitialized memory or NULL if the arena is full.
+ */
+void *
+arena_alloc(size_t len)
+{
+	void *p;
+
+	if (len > ARENA_SIZE - used)
+		return (NULL);
+	len = (len + ARENA_ALIGN - 1) & ~((size_t)ARENA_ALIGN - 1);
+	if (len > ARENA_SIZE - used)
+		return (NULL);
+
+	p = arena.buf + used;
+	used += len;
+
+	return (p);
+}
+
+/*
+ * Current position in the arena, to pass to arena_release().
+ */
+size_t
+arena_mark(void)
+{
+	return (used);
+}
+
+/*
+ * Free everything allocated since the given mark was taken.
+ */
+void
+arena_release(size_t mark)
+{
+	if (mark < used)
+		used = mark;
+}
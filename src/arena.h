@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Scratch memory for the work done while rendering (argument lists, path
+ * buffers), taken from a single static region by moving a pointer forward.
+ * Callers note the current position with arena_mark() and give back all they
+ * allocated since with arena_release(), each command and each render does so
+ * when it is done.  Only the part of the region actually used is ever touched.
+ */
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stddef.h>
+
+/* Size of the region, the most a single render can hold at once (bytes) */
+#define ARENA_SIZE	(1024 * 1024)
+
+/* Every allocation starts on a multiple of this (bytes) */
+#define ARENA_ALIGN	16
+
+void	*arena_alloc(size_t);
+size_t	 arena_mark(void);
+void	 arena_release(size_t);
+
+#endif /* ifndef _ARENA_H_ */
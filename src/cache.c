@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cache.h"
+#include "strlcpy.h"
+#include "trace.h"
+
+/*
+ * Outcome of the last cache_dir() check, the directory is only checked (and
+ * created) once per process unless its path changes.
+ */
+static struct {
+	char	 path[MAXPATHLEN];
+	int	 ret;
+} checked;
+
+/*
+ * Find (and create if needed) the cache directory.  It has to be a real
+ * directory owned by us and not writable by anyone else, or we don't use it.
+ * Returns -1 if no cache directory is available.
+ */
+static int
+cache_dir(char *path, size_t len)
+{
+	struct stat sb;
+	const char *runtime;
+	int n;
+
+	runtime = getenv("XDG_RUNTIME_DIR");
+	if (runtime != NULL && *runtime == '/')
+		n = snprintf(path, len, "%s/prwd", runtime);
+	else
+		n = snprintf(path, len, "/tmp/prwd-%lu",
+		    (unsigned long)getuid());
+	if (n < 0 || (size_t)n >= len)
+		return (-1);
+
+	if (strcmp(checked.path, path) == 0)
+		return (checked.ret);
+	strlcpy(checked.path, path, sizeof(checked.path));
+	checked.ret = -1;
+
+	TRACE_FS();
+	if (mkdir(path, 0700) == -1 && errno != EEXIST)
+		return (-1);
+
+	TRACE_FS();
+	if (lstat(path, &sb) == -1)
+		return (-1);
+	if (!S_ISDIR(sb.st_mode) || sb.st_uid != getuid() ||
+	    (sb.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+		return (-1);
+
+	checked.ret = 0;
+	return (0);
+}
+
+/*
+ * Write the full path of the cache entry 'name' on path.  Returns -1 if
+ * there is no usable cache directory.
+ */
+int
+cache_path(const char *name, char *path, size_t len)
+{
+	char dir[MAXPATHLEN];
+	int n;
+
+	if (cache_dir(dir, sizeof(dir)) == -1)
+		return (-1);
+
+	n = snprintf(path, len, "%s/%s", dir, name);
+	if (n < 0 || (size_t)n >= len)
+		return (-1);
+
+	return (0);
+}
+
+/*
+ * Read the cache entry 'name' in buf, up to len bytes.  Returns the number of
+ * bytes read or -1 if the entry does not exist or could not be read.
+ */
+ssize_t
+cache_read(const char *name, char *buf, size_t len)
+{
+	char path[MAXPATHLEN];
+	ssize_t n, total = 0;
+	int fd;
+
+	if (cache_path(name, path, sizeof(path)) == -1)
+		return (-1);
+
+	TRACE_FS();
+	if ((fd = open(path, O_RDONLY)) == -1)
+		return (-1);
+
+	while ((size_t)total < len) {
+		n = read(fd, buf + total, len - total);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			close(fd);
+			return (-1);
+		}
+		if (n == 0)
+			break;
+		total += n;
+	}
+
+	close(fd);
+
+	return (total);
+}
+
+/*
+ * Replace the cache entry 'name' with the len bytes of buf.  The entry is
+ * written aside and renamed so concurrent prompts never see a partial entry.
+ * Returns -1 on failure, which callers are free to ignore.
+ */
+int
+cache_write(const char *name, const char *buf, size_t len)
+{
+	char path[MAXPATHLEN], tmp[MAXPATHLEN];
+	ssize_t n;
+	size_t done = 0;
+	int fd;
+
+	if (cache_path(name, path, sizeof(path)) == -1)
+		return (-1);
+
+	n = snprintf(tmp, sizeof(tmp), "%s.%ld", path, (long)getpid());
+	if (n < 0 || (size_t)n >= sizeof(tmp))
+		return (-1);
+
+	TRACE_FS();
+	if ((fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600)) == -1)
+		return (-1);
+
+	while (done < len) {
+		n = write(fd, buf + done, len - done);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			close(fd);
+			unlink(tmp);
+			return (-1);
+		}
+		done += n;
+	}
+
+	if (close(fd) == -1 || rename(tmp, path) == -1) {
+		unlink(tmp);
+		return (-1);
+	}
+
+	return (0);
+}
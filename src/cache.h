@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Small persistent cache shared by the commands which would otherwise redo
+ * the same costly work for every prompt.  Entries are plain files in a
+ * private runtime directory: $XDG_RUNTIME_DIR/prwd or /tmp/prwd-<uid>.
+ */
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+#include <sys/types.h>
+
+#include <stddef.h>
+
+int	 cache_path(const char *, char *, size_t);
+ssize_t	 cache_read(const char *, char *, size_t);
+int	 cache_write(const char *, const char *, size_t);
+
+#endif /* ifndef _CACHE_H_ */
@@ -19,16 +19,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <unistd.h>
-#include <wchar.h>
 
 #include "cmd-branch.h"
+#include "facts.h"
 #include "strlcpy.h"
 #include "utils.h"
-#include "wcslcpy.h"
-
-/* How much to read of the branch file (e.g. HEAD, .hg/branch, etc.) */
-#define BRANCH_FILE_BUFSIZE 1024
 
 /*
  * Extract a branch name from *data and save it to *out.  Since the .hg/branch
@@ -36,21 +31,21 @@
  * character.
  */
 static void
-parse_hg_branch(wchar_t *out, char *data, size_t len)
+parse_hg_branch(char *out, char *data, size_t len)
 {
 	char *c;
 
 	if ((c = strchr(data, '\n')) != NULL)
 		*c = '\0';
 
-	mbstowcs(out, data, len);
+	strlcpy(out, data, len);
 }
 
 /*
  * Extract a git branch name from *data and save it to *out.
  */
 static void
-parse_git_head(wchar_t *out, char *data, size_t len)
+parse_git_head(char *out, char *data, size_t len)
 {
 	char *c;
 
@@ -78,7 +73,7 @@ done:
 	if ((c = strchr(data, '\n')) != NULL)
 		*c = '\0';
 
-	mbstowcs(out, data, len);
+	strlcpy(out, data, len);
 }
 
 /*
@@ -87,59 +82,26 @@ done:
  * help them understand or correct the issue.
  */
 void
-cmd_branch_exec(int argc, wchar_t **argv, wchar_t *out, size_t len)
+cmd_branch_run(char *out, size_t len)
 {
-	FILE *fp;
-	char *c, pwd[MAXPATHLEN], path[MAXPATHLEN], buf[BRANCH_FILE_BUFSIZE];
-	size_t s;
-	enum vcs_types type = VCS_NONE;
-	(void)argc;
-	(void)argv;
-
-	/*
-	 * Recurse our way up from the current dir and find clues that we are
-	 * within a source control repository.
-	 */
-	if (getcwd(pwd, MAXPATHLEN) == NULL) {
-		wcslcpy(out, L"<branch-cwd-error>", len);
-		return;
-	}
-
-	for (;;) {
-		snprintf(path, MAXPATHLEN, "%s/.hg/branch", pwd);
-		if (path_is_valid(path)) {
-			type = VCS_MERCURIAL;
-			break;
-		}
-
-		snprintf(path, MAXPATHLEN, "%s/.git/HEAD", pwd);
-		if (path_is_valid(path)) {
-			type = VCS_GIT;
-			break;
-		}
-
-		if ((c = strrchr(pwd, '/')) == NULL)
-			break;
-
-		*c = '\0';
-	}
-
-	if (type == VCS_NONE) {
-		out[0] = L'\0';
-		return;
-	}
-
-	fp = fopen(path, "r");
-	if (fp == NULL) {
-		wcslcpy(out, L"<branch-io-error>", len);
+	char buf[BRANCH_FILE_BUFSIZE];
+	const char *head;
+	const char *errstr;
+	enum vcs_types type;
+
+	type = fact_vcs(&head, &errstr);
+	if (errstr != NULL) {
+		strlcpy(out, errstr, len);
 		return;
 	}
 
-	s = fread(buf, 1, BRANCH_FILE_BUFSIZE, fp);
-	fclose(fp);
-	buf[s] = '\0';
+	/* The parsers below are destructive, work on a copy. */
+	strlcpy(buf, head, BRANCH_FILE_BUFSIZE);
 
 	switch (type) {
+	case VCS_NONE:
+		out[0] = '\0';
+		break;
 	case VCS_MERCURIAL:
 		parse_hg_branch(out, buf, len);
 		break;
@@ -147,7 +109,19 @@ cmd_branch_exec(int argc, wchar_t **argv, wchar_t *out, size_t len)
 		parse_git_head(out, buf, len);
 		break;
 	default:
-		wcslcpy(out, L"<branch-bad-vcs>", len);
+		strlcpy(out, "<branch-bad-vcs>", len);
 		break;
 	}
 }
+
+/*
+ * The branch command takes no argument, any is ignored.
+ */
+void
+cmd_branch_exec(int argc, char **argv, char *out, size_t len)
+{
+	(void)argc;
+	(void)argv;
+
+	cmd_branch_run(out, len);
+}
@@ -17,10 +17,9 @@
 #ifndef _BRANCH_H_
 #define _BRANCH_H_
 
-#include <wchar.h>
+#include <stddef.h>
 
-enum vcs_types { VCS_NONE, VCS_MERCURIAL, VCS_GIT };
-
-void	 cmd_branch_exec(int, wchar_t **, wchar_t *, size_t);
+void	 cmd_branch_run(char *, size_t);
+void	 cmd_branch_exec(int, char **, char *, size_t);
 
 #endif /* #ifndef _BRANCH_H_ */
@@ -16,18 +16,273 @@
 
 #include <sys/param.h>
 
+#include <ctype.h>
+#include <limits.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <wchar.h>
 
 #include "cmd-color.h"
+#include "facts.h"
+#include "pgetopt.h"
+#include "shell.h"
 #include "strlcpy.h"
+#include "strtonum.h"
 #include "utils.h"
-#include "wcslcpy.h"
-#include "wcstonum.h"
 
-#define ERR_BAD_ARG L"<color-bad-arg>"
-#define ERR_BAD_CODE L"<color-bad-code>"
+#define ERR_BAD_ARG "<color-bad-arg>"
+#define ERR_BAD_CODE "<color-bad-code>"
+
+#define SEQ_RESET "\033[0;0m"
+
+/* Maximum length of the color parameters of a sequence (e.g. "38;5;208") */
+#define MAX_SGR_LEN 20
+
+/*
+ * The 16 colors all terminals have, in the order of the palette.
+ */
+static const char *color_names[16] = {
+	"black", "red", "green", "yellow",
+	"blue", "magenta", "cyan", "white",
+	"brightblack", "brightred", "brightgreen", "brightyellow",
+	"brightblue", "brightmagenta", "brightcyan", "brightwhite",
+};
+
+/*
+ * RGB values of these 16 colors, as xterm displays them.
+ */
+static const int base_rgb[16][3] = {
+	{ 0, 0, 0 }, { 205, 0, 0 }, { 0, 205, 0 }, { 205, 205, 0 },
+	{ 0, 0, 238 }, { 205, 0, 205 }, { 0, 205, 205 }, { 229, 229, 229 },
+	{ 127, 127, 127 }, { 255, 0, 0 }, { 0, 255, 0 }, { 255, 255, 0 },
+	{ 92, 92, 255 }, { 255, 0, 255 }, { 0, 255, 255 }, { 255, 255, 255 },
+};
+
+/* Intensities of each channel in the 6x6x6 cube of the 256-color palette */
+static const int cube_levels[6] = { 0, 95, 135, 175, 215, 255 };
+
+/*
+ * Set rgb to the color of the given index of the 256-color palette.
+ */
+static void
+palette_rgb(int code, int rgb[3])
+{
+	if (code < 16) {
+		memcpy(rgb, base_rgb[code], sizeof(base_rgb[code]));
+	} else if (code < 232) {
+		code -= 16;
+		rgb[0] = cube_levels[code / 36];
+		rgb[1] = cube_levels[(code / 6) % 6];
+		rgb[2] = cube_levels[code % 6];
+	} else {
+		rgb[0] = rgb[1] = rgb[2] = 8 + (code - 232) * 10;
+	}
+}
+
+static int
+distance(const int a[3], const int b[3])
+{
+	return ((a[0] - b[0]) * (a[0] - b[0]) +
+	    (a[1] - b[1]) * (a[1] - b[1]) +
+	    (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+/*
+ * Return the index of the closest color among the 16 basic ones.
+ */
+static int
+nearest_16(const int rgb[3])
+{
+	int i, d, c[3], best = 0, bestd = INT_MAX;
+
+	for (i = 0; i < 16; i++) {
+		palette_rgb(i, c);
+		if ((d = distance(rgb, c)) < bestd) {
+			best = i;
+			bestd = d;
+		}
+	}
+
+	return (best);
+}
+
+/*
+ * Return the index of the closest color of the 256-color palette, either in
+ * the cube or on the gray ramp.  The 16 basic colors are left out, their
+ * values depend too much on the terminal.
+ */
+static int
+nearest_256(const int rgb[3])
+{
+	int i, avg, cube, gray, level[3], c[3];
+
+	for (i = 0; i < 3; i++) {
+		if (rgb[i] < 48)
+			level[i] = 0;
+		else if (rgb[i] < 115)
+			level[i] = 1;
+		else
+			level[i] = (rgb[i] - 35) / 40;
+	}
+	cube = 16 + 36 * level[0] + 6 * level[1] + level[2];
+
+	avg = (rgb[0] + rgb[1] + rgb[2]) / 3;
+	if (avg > 238)
+		gray = 255;
+	else if (avg < 8)
+		gray = 232;
+	else
+		gray = 232 + (avg - 3) / 10;
+
+	palette_rgb(cube, c);
+	i = distance(rgb, c);
+	palette_rgb(gray, c);
+
+	return (distance(rgb, c) < i ? gray : cube);
+}
+
+/*
+ * Parse a "#rrggbb" color in rgb, returns -1 if it is not one.
+ */
+static int
+parse_hex(const char *s, int rgb[3])
+{
+	int i, j, c;
+
+	if (s[0] != '#' || strlen(s) != 7)
+		return (-1);
+
+	for (i = 0; i < 3; i++) {
+		rgb[i] = 0;
+		for (j = 0; j < 2; j++) {
+			c = (unsigned char)s[1 + i * 2 + j];
+			if (!isxdigit(c))
+				return (-1);
+			c = isdigit(c) ? c - '0' : tolower(c) - 'a' + 10;
+			rgb[i] = rgb[i] * 16 + c;
+		}
+	}
+
+	return (0);
+}
+
+/*
+ * Write the parameters selecting one of the 16 basic colors as foreground.
+ */
+static void
+sgr_16(int code, char *buf, size_t len)
+{
+	snprintf(buf, len, "%d", code < 8 ? 30 + code : 90 + code - 8);
+}
+
+/*
+ * Write in buf the parameters of the escape sequence selecting the given
+ * color (name, palette index or "#rrggbb") as foreground, as precisely as the
+ * terminal can display it.  Returns -1 if the color is invalid.
+ */
+static int
+color_resolve(const char *arg, char *buf, size_t len)
+{
+	const char *errstr = NULL;
+	int i, code, rgb[3];
+
+	for (i = 0; i < 16; i++) {
+		if (strcmp(color_names[i], arg) == 0) {
+			sgr_16(i, buf, len);
+			return (0);
+		}
+	}
+
+	if (arg[0] == '#') {
+		if (parse_hex(arg, rgb) == -1)
+			return (-1);
+		switch (fact_colors()) {
+		case COLORS_TRUE:
+			snprintf(buf, len, "38;2;%d;%d;%d", rgb[0], rgb[1],
+			    rgb[2]);
+			break;
+		case COLORS_256:
+			snprintf(buf, len, "38;5;%d", nearest_256(rgb));
+			break;
+		case COLORS_16:
+			sgr_16(nearest_16(rgb), buf, len);
+			break;
+		}
+		return (0);
+	}
+
+	code = strtonum(arg, 0, 255, &errstr);
+	if (errstr != NULL)
+		return (-1);
+
+	if (fact_colors() != COLORS_16) {
+		snprintf(buf, len, "38;5;%d", code);
+	} else {
+		if (code >= 16) {
+			palette_rgb(code, rgb);
+			code = nearest_16(rgb);
+		}
+		sgr_16(code, buf, len);
+	}
+
+	return (0);
+}
+
+/*
+ * Parse the arguments of the color command in o.  The escape sequence is
+ * entirely built here, for the colors the terminal supports and marked as
+ * non-printing for the shell.  Returns NULL or the error string to display
+ * instead of the escape sequence.
+ */
+const char *
+cmd_color_parse(int argc, char **argv, struct color_opts *o)
+{
+	char attrs[8], sgr[MAX_SGR_LEN] = "";
+	const char *mopen, *mclose;
+	int ch, bold = 0, underline = 0;
+
+	o->seq[0] = '\0';
+
+	poptreset = 1;
+	poptind = 0;
+	popterr = 0;
+	while ((ch = pgetopt(argc, argv, "bu")) != -1) {
+		switch (ch) {
+		case 'b':
+			bold = 1;
+			break;
+		case 'u':
+			underline = 1;
+			break;
+		default:
+			return (ERR_BAD_ARG);
+		}
+	}
+	argc -= poptind;
+	argv += poptind;
+
+	if (argc > 1 || (argc == 0 && !bold && !underline))
+		return (ERR_BAD_ARG);
+
+	shell_markers(&mopen, &mclose);
+	if (argc == 1 && strcmp(argv[0], "reset") == 0) {
+		if (bold || underline)
+			return (ERR_BAD_ARG);
+		snprintf(o->seq, sizeof(o->seq), "%s%s%s", mopen, SEQ_RESET,
+		    mclose);
+		return (NULL);
+	}
+
+	if (argc == 1 && color_resolve(argv[0], sgr, sizeof(sgr)) == -1)
+		return (ERR_BAD_CODE);
+
+	snprintf(attrs, sizeof(attrs), "%s%s%s", bold ? "1" : "",
+	    bold && underline ? ";" : "", underline ? "4" : "");
+	snprintf(o->seq, sizeof(o->seq), "%s\033[%s%s%sm%s", mopen, attrs,
+	    attrs[0] != '\0' && sgr[0] != '\0' ? ";" : "", sgr, mclose);
+
+	return (NULL);
+}
 
 /*
  * This module should never crash and will always return a value on *out.  If
@@ -35,28 +290,21 @@
  * readable format on *out.
  */
 void
-cmd_color_exec(int argc, wchar_t **argv, wchar_t *out, size_t len)
+cmd_color_run(const struct color_opts *o, char *out, size_t len)
 {
-	(void)argc;
-	(void)argv;
-	long long code;
-	const wchar_t *errstr = NULL;
-
-	if (argc != 2) {
-		wcslcpy(out, ERR_BAD_ARG, len);
-		return;
-	}
+	strlcpy(out, o->seq, len);
+}
 
-	if (wcscmp(argv[1], L"reset") == 0) {
-		wcslcpy(out, L"[0;0m", len);
-		return;
-	}
+void
+cmd_color_exec(int argc, char **argv, char *out, size_t len)
+{
+	struct color_opts o;
+	const char *errstr;
 
-	code = wcstonum(argv[1], 0, 255, &errstr);
-	if (errstr != NULL) {
-		wcslcpy(out, ERR_BAD_CODE, len);
+	if ((errstr = cmd_color_parse(argc, argv, &o)) != NULL) {
+		strlcpy(out, errstr, len);
 		return;
 	}
 
-	swprintf(out, len, L"[38;5;%dm", code);
+	cmd_color_run(&o, out, len);
 }
@@ -14,8 +14,22 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
+#ifndef _CMD_COLOR_H_
+#define _CMD_COLOR_H_
+
+#include <stddef.h>
 
 #define MAX_COLOR_LEN 32
 
-void	 cmd_color_exec(int, wchar_t **, wchar_t *, size_t);
+/*
+ * seq: escape sequence, resolved for the terminal when the command is parsed
+ */
+struct color_opts {
+	char	 seq[MAX_COLOR_LEN];
+};
+
+const char *cmd_color_parse(int, char **, struct color_opts *);
+void	 cmd_color_run(const struct color_opts *, char *, size_t);
+void	 cmd_color_exec(int, char **, char *, size_t);
+
+#endif /* ifndef _CMD_COLOR_H_ */
@@ -19,18 +19,33 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
-#include <wchar.h>
 
 #include "cmd-date.h"
 #include "strlcpy.h"
 #include "utils.h"
-#include "wcslcpy.h"
 
-#define ERR_BAD_ARG L"<date-bad-arg>"
-#define ERR_BAD_CHARSET L"<date-bad-charset>"
-#define ERR_BAD_DATE L"<date-bad-format>"
-#define ERR_BAD_TIME L"<date-bad-time>"
-#define ERR_GENERIC L"<date-error>"
+#define ERR_BAD_ARG "<date-bad-arg>"
+#define ERR_BAD_DATE "<date-bad-format>"
+#define ERR_BAD_TIME "<date-bad-time>"
+#define ERR_GENERIC "<date-error>"
+
+/*
+ * Parse the arguments of the date command in o.  Returns NULL or the error
+ * string to display instead of the date.
+ */
+const char *
+cmd_date_parse(int argc, char **argv, struct date_opts *o)
+{
+	o->fmt = "%H:%M:%S";
+
+	if (argc > 2)
+		return (ERR_BAD_ARG);
+
+	if (argc == 2)
+		o->fmt = argv[1];
+
+	return (NULL);
+}
 
 /*
  * This module should never crash and will always return a value on *out.  If
@@ -38,41 +53,32 @@
  * readable format on *out.
  */
 void
-cmd_date_exec(int argc, wchar_t **argv, wchar_t *out, size_t len)
+cmd_date_run(const struct date_opts *o, char *out, size_t len)
 {
-	(void)argc;
-	(void)argv;
-	char buf[MAX_DATE_LEN];
-	char fmt[MAX_DATE_LEN];
 	time_t t;
 	struct tm *tm;
 
-	if (argc > 2) {
-		wcslcpy(out, ERR_BAD_ARG, len);
-		return;
-	}
-
-	if (argc == 2) {
-		if (wcstombs(fmt, argv[1], MAX_DATE_LEN) == (size_t)-1) {
-			wcslcpy(out, ERR_BAD_CHARSET, len);
-			return;
-		}
-	} else {
-		strlcpy(fmt, "%H:%M:%S", MAX_DATE_LEN);
-	}
-
 	t = time(NULL);
 	tm = localtime(&t);
 	if (tm == NULL) {
-		wcslcpy(out, ERR_BAD_TIME, len);
+		strlcpy(out, ERR_BAD_TIME, len);
 		return;
 	}
 
-	if (strftime(buf, MAX_DATE_LEN, fmt, tm) == 0) {
-		wcslcpy(out, ERR_BAD_DATE, len);
+	if (strftime(out, len, o->fmt, tm) == 0)
+		strlcpy(out, ERR_BAD_DATE, len);
+}
+
+void
+cmd_date_exec(int argc, char **argv, char *out, size_t len)
+{
+	struct date_opts o;
+	const char *errstr;
+
+	if ((errstr = cmd_date_parse(argc, argv, &o)) != NULL) {
+		strlcpy(out, errstr, len);
 		return;
 	}
 
-	if (mbstowcs(out, buf, len) == (size_t)-1)
-		wcslcpy(out, ERR_BAD_CHARSET, len);
+	cmd_date_run(&o, out, len);
 }
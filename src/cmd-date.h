@@ -14,8 +14,22 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
+#ifndef _CMD_DATE_H_
+#define _CMD_DATE_H_
+
+#include <stddef.h>
 
 #define MAX_DATE_LEN 128
 
-void	 cmd_date_exec(int, wchar_t **, wchar_t *, size_t);
+/*
+ * fmt: strftime(3) format, points in the arguments
+ */
+struct date_opts {
+	const char	*fmt;
+};
+
+const char *cmd_date_parse(int, char **, struct date_opts *);
+void	 cmd_date_run(const struct date_opts *, char *, size_t);
+void	 cmd_date_exec(int, char **, char *, size_t);
+
+#endif /* ifndef _CMD_DATE_H_ */
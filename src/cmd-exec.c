@@ -0,0 +1,431 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * The exec command runs an external program and shows its output.  Programs
+ * are spawned directly (no shell) and killed if they don't finish in time.
+ * With a TTL, the output is kept in the persistent cache, keyed by the
+ * command line, the current directory and the chosen environment variables.
+ * A stale output is shown right away while a detached process refreshes it
+ * for the next prompts.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/param.h>
+#include <sys/wait.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cache.h"
+#include "cmd-exec.h"
+#include "facts.h"
+#include "pgetopt.h"
+#include "prwd.h"
+#include "strlcpy.h"
+#include "strtonum.h"
+#include "template.h"
+#include "utils.h"
+
+#define ERR_BAD_ARG "<exec-bad-arg>"
+#define ERR_FAILED "<exec-failed>"
+#define ERR_TIMEOUT "<exec-timeout>"
+
+extern char **environ;
+
+/*
+ * Milliseconds elapsed on a monotonic clock.
+ */
+static long long
+now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/*
+ * Run the command argv (NULL-terminated, looked up in $PATH) and write its
+ * standard output on out, without the trailing newlines and truncated to the
+ * size of out.  The command is killed if it didn't finish within timeout
+ * milliseconds.  Returns -1 and sets *errstrp to a replacement string on
+ * failure.
+ */
+int
+exec_run(char **argv, char *out, size_t len, int timeout,
+    const char **errstrp)
+{
+	posix_spawn_file_actions_t fa;
+	struct pollfd pfd;
+	char discard[256];
+	long long deadline, remaining;
+	size_t used = 0;
+	ssize_t n;
+	pid_t pid;
+	int fds[2], r, timedout = 0;
+
+	*errstrp = ERR_FAILED;
+	if (len == 0 || pipe(fds) == -1)
+		return (-1);
+
+	posix_spawn_file_actions_init(&fa);
+	posix_spawn_file_actions_addopen(&fa, STDIN_FILENO, "/dev/null",
+	    O_RDONLY, 0);
+	posix_spawn_file_actions_adddup2(&fa, fds[1], STDOUT_FILENO);
+	posix_spawn_file_actions_addopen(&fa, STDERR_FILENO, "/dev/null",
+	    O_WRONLY, 0);
+	posix_spawn_file_actions_addclose(&fa, fds[0]);
+	posix_spawn_file_actions_addclose(&fa, fds[1]);
+	r = posix_spawnp(&pid, argv[0], &fa, NULL, argv, environ);
+	posix_spawn_file_actions_destroy(&fa);
+	close(fds[1]);
+	if (r != 0) {
+		close(fds[0]);
+		return (-1);
+	}
+
+	deadline = now_ms() + timeout;
+	pfd.fd = fds[0];
+	pfd.events = POLLIN;
+	for (;;) {
+		if ((remaining = deadline - now_ms()) <= 0) {
+			timedout = 1;
+			break;
+		}
+		r = poll(&pfd, 1, (int)remaining);
+		if (r == -1 && errno == EINTR)
+			continue;
+		if (r <= 0) {
+			timedout = (r == 0);
+			break;
+		}
+
+		/* Keep reading past the end of out, or the command blocks. */
+		if (used < len - 1)
+			n = read(fds[0], out + used, len - 1 - used);
+		else
+			n = read(fds[0], discard, sizeof(discard));
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		if (used < len - 1)
+			used += n;
+	}
+	close(fds[0]);
+
+	/* The command may close its output and keep running, same deadline. */
+	while (!timedout) {
+		r = waitpid(pid, NULL, WNOHANG);
+		if (r == pid || (r == -1 && errno != EINTR))
+			break;
+		if (deadline - now_ms() <= 0)
+			timedout = 1;
+		else if (r == 0)
+			poll(NULL, 0, 1);
+	}
+
+	if (timedout) {
+		kill(pid, SIGKILL);
+		while (waitpid(pid, NULL, 0) == -1 && errno == EINTR)
+			;
+	}
+
+	if (timedout) {
+		*errstrp = ERR_TIMEOUT;
+		return (-1);
+	}
+
+	while (used > 0 && (out[used - 1] == '\n' || out[used - 1] == '\r'))
+		used--;
+	out[used] = '\0';
+	*errstrp = NULL;
+
+	return (0);
+}
+
+/*
+ * Name of the cache entry of a command: a FNV-1a hash of the command line,
+ * the current directory and the given environment variables.
+ */
+static void
+cache_name(char **cmdv, char *const *envv, size_t envc, char *name,
+    size_t len)
+{
+	uint64_t h = 14695981039346656037ULL;
+	const char *s, *cwd, *errstr;
+	size_t i;
+
+#define HASH(str) do {						\
+	for (s = (str); ; s++) {				\
+		h = (h ^ (unsigned char)*s) * 1099511628211ULL;	\
+		if (*s == '\0')					\
+			break;					\
+	}							\
+} while (0)
+
+	for (i = 0; cmdv[i] != NULL; i++)
+		HASH(cmdv[i]);
+	if ((cwd = fact_cwd(&errstr)) != NULL)
+		HASH(cwd);
+	for (i = 0; i < envc; i++) {
+		HASH(envv[i]);
+		if ((s = getenv(envv[i])) != NULL)
+			HASH(s);
+	}
+
+#undef HASH
+
+	snprintf(name, len, "exec-%016llx", (unsigned long long)h);
+}
+
+/*
+ * Take the refresh lock of a cache entry, only one process refreshes a given
+ * command at a time.  A lock older than the refresh timeout was left behind
+ * by a dead process and is taken over.  Returns -1 if the lock is busy.
+ */
+static int
+refresh_lock(const char *name, char *path, size_t len)
+{
+	struct stat sb;
+	char lock[MAXPATHLEN];
+	int fd;
+
+	snprintf(lock, sizeof(lock), "%s.lock", name);
+	if (cache_path(lock, path, len) == -1)
+		return (-1);
+
+	if ((fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600)) == -1) {
+		if (errno != EEXIST || stat(path, &sb) == -1 ||
+		    time(NULL) - sb.st_mtime <= EXEC_REFRESH_TIMEOUT_MS / 1000)
+			return (-1);
+		unlink(path);
+		if ((fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600)) == -1)
+			return (-1);
+	}
+
+	close(fd);
+
+	return (0);
+}
+
+/*
+ * Fork a detached process running the command and saving its output in the
+ * cache entry 'name'.  If fdp is not NULL, it is set to a pipe on which the
+ * output (or the replacement string of an error) is sent as well.  Returns -1
+ * if another process is already refreshing this entry or on error.
+ */
+static pid_t
+refresh(char **cmdv, const char *name, int *fdp)
+{
+	char lock[MAXPATHLEN], output[MAX_OUTPUT_LEN], buf[MAX_OUTPUT_LEN + 32];
+	const char *errstr, *result;
+	pid_t pid;
+	int fds[2], n;
+
+	if (refresh_lock(name, lock, sizeof(lock)) == -1)
+		return (-1);
+
+	if (pipe(fds) == -1) {
+		unlink(lock);
+		return (-1);
+	}
+
+	switch ((pid = fork())) {
+	case -1:
+		close(fds[0]);
+		close(fds[1]);
+		unlink(lock);
+		return (-1);
+	case 0:
+		close(fds[0]);
+		signal(SIGPIPE, SIG_IGN);
+		detach_stdio();
+
+		if (exec_run(cmdv, output, sizeof(output),
+		    EXEC_REFRESH_TIMEOUT_MS, &errstr) == 0) {
+			n = snprintf(buf, sizeof(buf), "%lld\n%s",
+			    (long long)time(NULL), output);
+			cache_write(name, buf, n);
+			result = output;
+		} else {
+			result = errstr;
+		}
+
+		unlink(lock);
+		if (write(fds[1], result, strlen(result)) == -1)
+			_exit(1);
+		_exit(0);
+	default:
+		break;
+	}
+
+	close(fds[1]);
+	if (fdp != NULL)
+		*fdp = fds[0];
+	else
+		close(fds[0]);
+
+	return (pid);
+}
+
+/*
+ * Output of a command with a TTL: from the cache if we have it (refreshed in
+ * the background once stale), else from a refresh we wait on for at most
+ * 'timeout' milliseconds.
+ */
+static void
+exec_cached(char **cmdv, char *const *envv, size_t envc, long long ttl,
+    int timeout, char *out, size_t len)
+{
+	struct pollfd pfd;
+	char name[64], buf[MAX_OUTPUT_LEN + 32], *body;
+	const char *errstr;
+	long long stamp;
+	ssize_t n;
+	pid_t pid;
+	int fd;
+
+	cache_name(cmdv, envv, envc, name, sizeof(name));
+
+	n = cache_read(name, buf, sizeof(buf) - 1);
+	if (n > 0) {
+		buf[n] = '\0';
+		stamp = strtoll(buf, &body, 10);
+		if (*body == '\n') {
+			strlcpy(out, body + 1, len);
+			if (time(NULL) - stamp >= ttl)
+				refresh(cmdv, name, NULL);
+			return;
+		}
+	}
+
+	/* Nothing cached (or already being refreshed), run it ourselves. */
+	if ((pid = refresh(cmdv, name, &fd)) == -1) {
+		if (exec_run(cmdv, out, len, timeout, &errstr) == -1)
+			strlcpy(out, errstr, len);
+		return;
+	}
+
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	n = -1;
+	if (poll(&pfd, 1, timeout) == 1)
+		n = read(fd, out, len - 1);
+	close(fd);
+
+	/* A slow command keeps running, the next prompts will have it. */
+	if (n < 0) {
+		strlcpy(out, ERR_TIMEOUT, len);
+		return;
+	}
+
+	out[n] = '\0';
+	waitpid(pid, NULL, 0);
+}
+
+/*
+ * Parse the arguments of the exec command in o.  Returns NULL or the error
+ * string to display instead of the output of the program.
+ */
+const char *
+cmd_exec_parse(int argc, char **argv, struct exec_opts *o)
+{
+	const char *errstr = NULL;
+	int ch;
+
+	o->cmdv = NULL;
+	o->envc = 0;
+	o->ttl = 0;
+	o->timeout = EXEC_DEFAULT_TIMEOUT_MS;
+
+	poptreset = 1;
+	poptind = 0;
+	popterr = 0;
+	while ((ch = pgetopt(argc, argv, "+e:t:w:")) != -1) {
+		switch (ch) {
+		case 'e':
+			if (o->envc >= MAX_EXEC_ENV)
+				return (ERR_BAD_ARG);
+			o->envv[o->envc++] = poptarg;
+			break;
+		case 't':
+			o->ttl = strtonum(poptarg, 1, 86400 * 365, &errstr);
+			break;
+		case 'w':
+			o->timeout = strtonum(poptarg, 1, 60000, &errstr);
+			break;
+		default:
+			return (ERR_BAD_ARG);
+		}
+		if (errstr != NULL)
+			return (ERR_BAD_ARG);
+	}
+
+	if (poptind >= argc)
+		return (ERR_BAD_ARG);
+
+	/* argv is NULL-terminated, as execvp(3) wants it. */
+	o->cmdv = argv + poptind;
+
+	return (NULL);
+}
+
+/*
+ * This module should never crash and will always return a value on *out.  If
+ * any error occur during its runtime, it should be represented in a user
+ * readable format on *out.
+ */
+void
+cmd_exec_run(const struct exec_opts *o, char *out, size_t len)
+{
+	const char *errstr;
+
+	if (o->ttl > 0) {
+		exec_cached(o->cmdv, o->envv, o->envc, o->ttl, o->timeout,
+		    out, len);
+		return;
+	}
+
+	if (exec_run(o->cmdv, out, len, o->timeout, &errstr) == -1)
+		strlcpy(out, errstr, len);
+}
+
+void
+cmd_exec_exec(int argc, char **argv, char *out, size_t len)
+{
+	struct exec_opts o;
+	const char *errstr;
+
+	if ((errstr = cmd_exec_parse(argc, argv, &o)) != NULL) {
+		strlcpy(out, errstr, len);
+		return;
+	}
+
+	cmd_exec_run(&o, out, len);
+}
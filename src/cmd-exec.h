@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _CMD_EXEC_H_
+#define _CMD_EXEC_H_
+
+#include <stddef.h>
+
+/* Default time given to a command before it is killed (milliseconds) */
+#define EXEC_DEFAULT_TIMEOUT_MS 500
+
+/* Time given to a command refreshing the cache in the background */
+#define EXEC_REFRESH_TIMEOUT_MS 30000
+
+/* Maximum number of environment variables in the cache key (-e) */
+#define MAX_EXEC_ENV 8
+
+/*
+ * cmdv: program and its arguments, NULL-terminated, points in the arguments
+ * envv, envc: environment variables part of the cache key (-e)
+ * ttl: how long the output is cached (seconds), 0 if not cached (-t)
+ * timeout: time given to the program (milliseconds, -w)
+ */
+struct exec_opts {
+	char		**cmdv;
+	char		*envv[MAX_EXEC_ENV];
+	size_t		 envc;
+	long long	 ttl;
+	int		 timeout;
+};
+
+int	 exec_run(char **, char *, size_t, int, const char **);
+const char *cmd_exec_parse(int, char **, struct exec_opts *);
+void	 cmd_exec_run(const struct exec_opts *, char *, size_t);
+void	 cmd_exec_exec(int, char **, char *, size_t);
+
+#endif /* ifndef _CMD_EXEC_H_ */
@@ -18,16 +18,45 @@
 
 #include <string.h>
 #include <stdlib.h>
-#include <wchar.h>
 
 #include "cmd-hostname.h"
+#include "facts.h"
+#include "pgetopt.h"
+#include "strlcpy.h"
 #include "utils.h"
-#include "wcslcpy.h"
-#include "wgetopt.h"
 
-#define ERR_BAD_ARG L"<hostname-bad-arg>"
-#define ERR_BAD_CHARSET L"<hostname-bad-charset>"
-#define ERR_GENERIC L"<hostname-error>"
+#define ERR_BAD_ARG "<hostname-bad-arg>"
+#define ERR_GENERIC "<hostname-error>"
+
+/*
+ * Parse the arguments of the hostname command in o.  Returns NULL or the error
+ * string to display instead of the hostname.
+ */
+const char *
+cmd_hostname_parse(int argc, char **argv, struct hostname_opts *o)
+{
+	int ch;
+
+	o->longform = o->fqdn = 0;
+
+	poptreset = 1;
+	poptind = 0;
+	popterr = 0;
+	while ((ch = pgetopt(argc, argv, "fl")) != -1) {
+		switch (ch) {
+		case 'f':
+			o->fqdn = 1;
+			break;
+		case 'l':
+			o->longform = 1;
+			break;
+		default:
+			return (ERR_BAD_ARG);
+		}
+	}
+
+	return (NULL);
+}
 
 /*
  * This module should never crash and will always return a value on *out.  If
@@ -35,35 +64,39 @@
  * readable format on *out.
  */
 void
-cmd_hostname_exec(int argc, wchar_t **argv, wchar_t *out, size_t len)
+cmd_hostname_run(const struct hostname_opts *o, char *out, size_t len)
 {
-	int longform = 0;
-	wchar_t ch;
-	char buf[MAXHOSTNAMELEN], *c;
+	const char *hostname, *c;
 
-	if (lgethostname(buf, MAXHOSTNAMELEN) != 0) {
-		wcslcpy(out, ERR_GENERIC, len);
+	if ((hostname = fact_hostname()) == NULL) {
+		strlcpy(out, ERR_GENERIC, len);
 		return;
 	}
 
-	woptreset = 1;
-	woptind = 0;
-	wopterr = 0;
-	while ((ch = wgetopt(argc, argv, L"l")) != -1) {
-		switch (ch) {
-		case L'l':
-			longform = 1;
-			break;
-		default:
-			wcslcpy(out, ERR_BAD_ARG, len);
-			return;
-		}
+	if (o->fqdn && (hostname = fact_fqdn()) == NULL) {
+		strlcpy(out, ERR_GENERIC, len);
+		return;
 	}
 
 	/* Find the first dot and stop right here for the short hostname.. */
-	if (!longform && (c = strchr(buf, '.')) != NULL)
-		*c = '\0';
+	if (!o->longform && !o->fqdn && (c = strchr(hostname, '.')) != NULL &&
+	    (size_t)(c - hostname) < len) {
+		len = c - hostname + 1;
+	}
+
+	strlcpy(out, hostname, len);
+}
+
+void
+cmd_hostname_exec(int argc, char **argv, char *out, size_t len)
+{
+	struct hostname_opts o;
+	const char *errstr;
+
+	if ((errstr = cmd_hostname_parse(argc, argv, &o)) != NULL) {
+		strlcpy(out, errstr, len);
+		return;
+	}
 
-	if (mbstowcs(out, buf, len) == (size_t)-1)
-		wcslcpy(out, ERR_BAD_CHARSET, len);
+	cmd_hostname_run(&o, out, len);
 }
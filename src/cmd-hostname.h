@@ -14,6 +14,22 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
+#ifndef _CMD_HOSTNAME_H_
+#define _CMD_HOSTNAME_H_
 
-void	 cmd_hostname_exec(int, wchar_t **, wchar_t *, size_t);
+#include <stddef.h>
+
+/*
+ * longform: show the full hostname (-l)
+ * fqdn: show the fully qualified domain name (-f)
+ */
+struct hostname_opts {
+	int	 longform;
+	int	 fqdn;
+};
+
+const char *cmd_hostname_parse(int, char **, struct hostname_opts *);
+void	 cmd_hostname_run(const struct hostname_opts *, char *, size_t);
+void	 cmd_hostname_exec(int, char **, char *, size_t);
+
+#endif /* ifndef _CMD_HOSTNAME_H_ */
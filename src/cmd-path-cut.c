@@ -14,45 +14,43 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
 #include <err.h>
+#include <string.h>
 
 #include "cmd-path.h"
 #include "prwd.h"
-#include "wcslcpy.h"
+#include "strlcpy.h"
+#include "utf8width.h"
+#include "utils.h"
 
-#define ERR_NULL_PATH L"<path-null>"
+#define ERR_NULL_PATH "<path-null>"
 
 /*
- * Reduce the provided string to the smallest it could get to fit within the
+ * Reduce the provided path to the smallest it could get to fit within the
  * global max length and without cutting any path element. For example
- * "/usr/local/share/doc" is reduced to ".../share/doc".
+ * "/usr/local/share/doc" is reduced to ".../share/doc".  Lengths are counted in
+ * terminal columns, len is the size of out in bytes.
  */
 void
-path_cleancut(wchar_t *out, wchar_t *path, size_t len, size_t maxlen,
-    wchar_t *filler)
+path_cleancut(char *out, const struct path_index *pi, size_t len,
+    size_t maxlen, const char *filler)
 {
-	size_t maxplen, flen;
-	wchar_t *c;
+	size_t maxplen, flen, used, i;
 
 	if (len == 0 || out == NULL)
 		errx(1, "path_cleancut: invalid output");
-	if (path == NULL)
+	if (pi == NULL || pi->path == NULL)
 		errx(1, "path_cleancut: null input");
 
-	/* Normalize len instead dealing with two limits. */
-	if (maxlen + 1 > len)
-		errx(1, "path_cleancut: maxlen too long");
-	len = maxlen + 1;
-
 	/* Path is already short enough. */
-	if (wcslen(path) <= maxlen) {
-		wcslcpy(out, path, len);
+	if (path_index_width_from(pi, 0) <= maxlen) {
+		strlcpy(out, pi->path, len);
 		return;
 	}
 
 	/* Copy the filler, everyone needs that. */
-	flen = wcslcpy(out, filler, len);
+	utf8_ncpy(out, filler, len, maxlen);
+	flen = utf8_width(out);
 
 	/* We already reached the max, leave here, there is nothing to add. */
 	if (flen >= maxlen)
@@ -60,22 +58,22 @@ path_cleancut(wchar_t *out, wchar_t *path, size_t len, size_t maxlen,
 
 	maxplen = maxlen - flen;
 
-	/* Keep triming until 'path' is smaller than maxplen. */
-	for (c = path; wcslen(c) > maxplen;) {
-		if (*c == L'/')
-			c++;
-		c = wcschr(c, '/');
-		/*
-		 * If we reached the end of the string before we truncated the
-		 * path enough, just truncate it.
-		 */
-		if (c == NULL) {
-			path_quickcut(out, path, len, maxlen, filler);
-			return;
-		}
+	/* First component from which the rest of the path fits. */
+	for (i = 1; i < pi->count; i++) {
+		if (path_index_width_from(pi, i) <= maxplen)
+			break;
+	}
+
+	/*
+	 * If even the last component is too large, just truncate it.
+	 */
+	if (i >= pi->count) {
+		path_quickcut(out, pi, len, maxlen, filler);
+		return;
 	}
 
-	wcsncpy(out + flen, c, len - flen);
+	used = strlen(out);
+	strlcpy(out + used, pi->path + pi->off[i], len - used);
 }
 
 /*
@@ -84,36 +82,31 @@ path_cleancut(wchar_t *out, wchar_t *path, size_t len, size_t maxlen,
  * the path would be transformed to "..e/doc"
  */
 void
-path_quickcut(wchar_t *out, wchar_t *path, size_t len, size_t maxlen,
-    wchar_t *filler)
+path_quickcut(char *out, const struct path_index *pi, size_t len,
+    size_t maxlen, const char *filler)
 {
-	size_t plen, offset, excess;
+	size_t plen, flen, used;
 
 	if (len == 0 || out == NULL)
 		errx(1, "path_quickcut: invalid output");
-	if (path == NULL)
+	if (pi == NULL || pi->path == NULL)
 		errx(1, "path_quickcut: null input");
 
-	/* Normalize len instead dealing with two limits. */
-	if (maxlen + 1 > len)
-		errx(1, "path_quickcut: maxlen too long");
-	len = maxlen + 1;
-
-	plen = wcslen(path);
+	plen = path_index_width_from(pi, 0);
 	if (plen <= maxlen) {
-		wcslcpy(out, path, len);
+		strlcpy(out, pi->path, len);
 		return;
 	}
 
 	/* Copy the filler, everyone needs that. */
-	offset = wcslcpy(out, filler, len);
+	utf8_ncpy(out, filler, len, maxlen);
+	flen = utf8_width(out);
 
 	/* We already reached the max, leave here, there is nothing to add. */
-	if (offset >= maxlen)
+	if (flen >= maxlen)
 		return;
 
-	excess = plen - maxlen;
-	path += excess + offset;
-
-	wcslcpy(out + offset, path, len - offset);
+	used = strlen(out);
+	strlcpy(out + used, path_index_skip(pi, plen - (maxlen - flen)),
+	    len - used);
 }
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * A path index describes where each component of a path starts and how wide
+ * everything before it is on the terminal.  It is built once with a single
+ * scan of the path, the shortening modes (cleancut, quickcut, newsgroupize)
+ * then only look at the index instead of rescanning the path for each
+ * component.  Pure ASCII paths, by far the most common, are detected up
+ * front and never decoded: their widths are their byte offsets.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "cmd-path.h"
+#include "utf8width.h"
+
+/*
+ * Index the given path.  A component starts at each slash and runs until the
+ * next one, except for a trailing slash which stays on the last component.
+ * Anything before the first slash (e.g. "~" or "$alias") is a component of
+ * its own.  Widths are counted in terminal columns.  If the path has more
+ * than MAX_PATH_COMPONENTS components, the last one holds all the remaining
+ * ones.
+ */
+void
+path_index_build(struct path_index *pi, const char *path)
+{
+	const char *c;
+	uint32_t cp;
+	size_t width = 0, len;
+
+	len = strlen(path);
+	pi->path = path;
+	pi->count = 0;
+	pi->ascii = utf8_is_ascii(path, len);
+
+	for (c = path; *c != '\0';) {
+		if (c == path || (*c == '/' && *(c + 1) != '\0' &&
+		    pi->count < MAX_PATH_COMPONENTS)) {
+			pi->off[pi->count] = c - path;
+			pi->width[pi->count] = pi->ascii ? (size_t)(c - path) :
+			    width;
+			pi->count++;
+		}
+		if (pi->ascii) {
+			c = strchr(c + 1, '/');
+			if (c == NULL)
+				break;
+			continue;
+		}
+		c += utf8_decode(c, &cp);
+		width += utf8_cpwidth(cp);
+	}
+
+	pi->off[pi->count] = len;
+	pi->width[pi->count] = pi->ascii ? len : width;
+}
+
+/*
+ * Width of the whole path from the start of component i.
+ */
+size_t
+path_index_width_from(const struct path_index *pi, size_t i)
+{
+	return (pi->width[pi->count] - pi->width[i]);
+}
+
+/*
+ * Return a pointer to the first character starting at or after column n of
+ * the path.  A wide character straddling column n is skipped entirely and so
+ * are the zero-width characters (e.g. combining marks) following the cut, a
+ * character is never split from its accents.  The component holding column n
+ * is found with a binary search on the widths, only this component is
+ * scanned.
+ */
+const char *
+path_index_skip(const struct path_index *pi, size_t n)
+{
+	const char *c, *next;
+	uint32_t cp;
+	size_t lo = 0, hi = pi->count, mid, col;
+
+	if (pi->count == 0 || n >= pi->width[pi->count])
+		return (pi->path + pi->off[pi->count]);
+
+	if (pi->ascii)
+		return (pi->path + n);
+
+	/* Last component starting at or before column n. */
+	while (hi - lo > 1) {
+		mid = (lo + hi) / 2;
+		if (pi->width[mid] <= n)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	col = pi->width[lo];
+	c = pi->path + pi->off[lo];
+	while (*c != '\0' && col < n) {
+		c += utf8_decode(c, &cp);
+		col += utf8_cpwidth(cp);
+	}
+	while (*c != '\0') {
+		next = c + utf8_decode(c, &cp);
+		if (utf8_cpwidth(cp) != 0)
+			break;
+		c = next;
+	}
+
+	return (c);
+}
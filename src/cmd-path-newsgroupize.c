@@ -14,11 +14,12 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
+#include <string.h>
 
 #include "prwd.h"
 #include "cmd-path.h"
-#include "wcslcpy.h"
+#include "strlcpy.h"
+#include "utils.h"
 
 /*
  * Replace all the path parts by their first letters, except the last one. For
@@ -26,55 +27,36 @@
  * result to output.
  */
 void
-path_newsgroupize(wchar_t *output, const wchar_t *path, size_t len)
+path_newsgroupize(char *output, const struct path_index *pi, size_t len)
 {
-	const wchar_t *last = NULL, *c = path;
-	size_t idx = 0;
+	const char *c;
+	size_t idx = 0, i, n;
 
 	if (len < 1)
 		return;
-	if (path == NULL)
+	output[0] = '\0';
+	if (pi == NULL || pi->path == NULL || pi->count == 0)
 		return;
 
-	/*
-	 * The path doesn't start with a '/', could be an alias, could be '~'.
-	 * Copy everything until the first slash.
-	 */
-	if (*path != L'/') {
-		do {
-			if (idx >= len) {
-				output[idx] = L'\0';
-				return;
-			}
-			output[idx] = *(c++);
-			idx++;
-		} while (*c != L'/' && *c != L'\0');
+	for (i = 0; i < pi->count - 1; i++) {
+		c = pi->path + pi->off[i];
+
+		/*
+		 * The path doesn't start with a '/', could be an alias, could
+		 * be '~'.  Keep this first component whole.
+		 */
+		if (*c != '/') {
+			n = pi->off[i + 1] - pi->off[i];
+		} else if (pi->off[i + 1] - pi->off[i] == 1) {
+			n = 1;
+		} else {
+			n = utf8_skip(c + 1, 1) - c;
+		}
+		if (bufappend(output, &idx, len, c, n) == -1)
+			return;
 	}
 
-	/* Nothing to shorten, we reached the end without finding a '/'. */
-	if (*c == L'\0') {
-		output[idx] = L'\0';
-		return;
-	}
-
-	/* For every component, add the first letter and a slash. */
-	for (;;) {
-		/* Copy the slash and keep the first letter in 'last' */
-		output[idx++] = *(c++);
-		last = c;
-
-		/* Try to move to the next path part */
-		if ((c = wcschr(c, L'/')) == NULL)
-			break;
-
-		/* This last slash is a trailing one, stop here. */
-		if (*(c + 1) == L'\0')
-			break;
-
-		/* Copy the character right after the slash. */
-		output[idx++] = *last;
-	}
-
-	/* Copy whatever is left (override the trailing NUL-byte on buffer) */
-	wcslcpy(output + idx, last, len - idx);
+	/* Copy the last component, possibly with a trailing slash. */
+	bufappend(output, &idx, len, pi->path + pi->off[i],
+	    pi->off[i + 1] - pi->off[i]);
 }
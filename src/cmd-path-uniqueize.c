@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/param.h>
+
+#include <string.h>
+
+#include "cmd-path.h"
+#include "dircache.h"
+#include "strlcpy.h"
+#include "utils.h"
+
+/*
+ * Length in bytes of the shortest prefix of name which is not the prefix of
+ * any other of the NUL-separated names (len bytes).  The prefix always ends
+ * on a character boundary, it is the whole name if no prefix is unique.
+ */
+static size_t
+unique_prefix(const char *name, const char *names, size_t len)
+{
+	const char *c, *end = names + len;
+	size_t nlen, lcp, max = 0;
+
+	nlen = strlen(name);
+	for (c = names; c < end; c += strlen(c) + 1) {
+		if (strcmp(c, name) == 0)
+			continue;
+		for (lcp = 0; name[lcp] != '\0' && name[lcp] == c[lcp]; lcp++)
+			;
+		if (lcp > max)
+			max = lcp;
+	}
+
+	if (max >= nlen)
+		return (nlen);
+
+	while (max > 0 && (name[max] & 0xC0) == 0x80)
+		max--;
+
+	return (utf8_skip(name + max, 1) - name);
+}
+
+/*
+ * Shorten the component i of the displayed path 'pi' to its unique prefix
+ * among its siblings.  The displayed path may start with an alias, its last
+ * components are matched with the last components of the real path 'real'
+ * to find the directory to list.  Returns the length of the component to
+ * keep, including its slash.
+ */
+static size_t
+shorten(const struct path_index *pi, const struct path_index *real,
+    size_t i)
+{
+	char dir[MAXPATHLEN], name[MAXPATHLEN];
+	const char *c, *names;
+	size_t clen, k, off, nlen;
+
+	c = pi->path + pi->off[i];
+	clen = pi->off[i + 1] - pi->off[i];
+	if (*c != '/' || clen < 2 || pi->count - i > real->count)
+		return (clen);
+
+	/* Same component in the real path, or we don't know where it is. */
+	k = real->count - (pi->count - i);
+	if (real->off[k + 1] - real->off[k] != clen ||
+	    memcmp(real->path + real->off[k], c, clen) != 0)
+		return (clen);
+
+	off = real->off[k];
+	if (off == 0) {
+		strlcpy(dir, "/", sizeof(dir));
+	} else {
+		if (off >= sizeof(dir))
+			return (clen);
+		memcpy(dir, real->path, off);
+		dir[off] = '\0';
+	}
+	memcpy(name, c + 1, clen - 1);
+	name[clen - 1] = '\0';
+
+	if ((names = dircache_names(dir, &nlen)) == NULL)
+		return (clen);
+
+	return (1 + unique_prefix(name, names, nlen));
+}
+
+/*
+ * Replace all the path parts but the last one by the shortest prefix that
+ * none of their siblings share.  For example "/usr/local/share/doc" is turned
+ * into "/u/lo/s/doc" if /usr/lib exists.  An alias at the start of the path
+ * is kept as is.  The real path 'cwd' is used to list the sibling directories.
+ */
+void
+path_uniqueize(char *output, const struct path_index *pi, const char *cwd,
+    size_t len)
+{
+	struct path_index real;
+	size_t idx = 0, i;
+
+	if (len < 1)
+		return;
+	output[0] = '\0';
+	if (pi == NULL || pi->path == NULL || pi->count == 0)
+		return;
+
+	path_index_build(&real, cwd);
+
+	for (i = 0; i < pi->count - 1; i++) {
+		if (bufappend(output, &idx, len, pi->path + pi->off[i],
+		    shorten(pi, &real, i)) == -1)
+			return;
+	}
+
+	bufappend(output, &idx, len, pi->path + pi->off[i],
+	    pi->off[i + 1] - pi->off[i]);
+}
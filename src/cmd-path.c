@@ -21,79 +21,135 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
-#include <wchar.h>
 
 #include "alias.h"
+#include "arena.h"
 #include "cmd-path.h"
+#include "facts.h"
 #include "prwd.h"
+#include "pgetopt.h"
 #include "strlcpy.h"
-#include "wcslcpy.h"
-#include "wcstonum.h"
-#include "wgetopt.h"
+#include "strtonum.h"
+#include "trace.h"
+#include "utils.h"
 
-#define ERR_NO_ACCESS L"<path-no-access>"
-#define ERR_NOT_FOUND L"<path-not-found>"
-#define ERR_BAD_CHARSET L"<path-bad-charset>"
-#define ERR_BAD_ARG L"<path-bad-arg>"
-#define ERR_GENERIC L"<path-error>"
+#define ERR_NO_ACCESS "<path-no-access>"
+#define ERR_NOT_FOUND "<path-not-found>"
+#define ERR_BAD_ARG "<path-bad-arg>"
+#define ERR_GENERIC "<path-error>"
+
+#ifndef REGRESS
+/*
+ * Replacement string for a failed stat(2) or getcwd(3).
+ */
+static const char *
+cwd_errstr(int error)
+{
+	switch (error) {
+	case EACCES:
+		return (ERR_NO_ACCESS);
+	case ENOENT:
+		return (ERR_NOT_FOUND);
+	default:
+		return (ERR_GENERIC);
+	}
+}
 
 /*
- * Return a wide-char version of the current path.  If any error occurs,
+ * Write the current path to wd and its stat(2) to sb.  If any error occurs,
  * *errstr is set to a replacement string to be used instead of the path.
+ *
+ * The shell keeps the current path in $PWD, if it turns out to be the same
+ * directory as "." we use it as is: it costs a single stat(2) and provides
+ * more context if the shell is located in a symlink.  Only if it doesn't
+ * match do we pay for getcwd(3).  On most platforms getcwd(3) fails if the
+ * directory you are currently in was removed, in which case we have nothing
+ * better to display.
  */
-#ifndef REGRESS
 void
-path_wcswd(wchar_t *wcswd, size_t len, const wchar_t **errstr)
+path_cwd(char *wd, size_t len, struct stat *sb, const char **errstr)
 {
-	char wd[MAXPATHLEN], *wd_env;
-	struct stat sa, sb;
+	char *wd_env;
+	struct stat pb;
 
 	*errstr = NULL;
 
-	/*
-	 * On most platform getcwd() returns NULL if the directory is missing.
-	 * This could happen if the directory you are currently in was removed.
-	 * If this occurs, we don't need to go any further, we have nothing
-	 * better to display.
-	 */
-	if (getcwd(wd, MAXPATHLEN) == NULL) {
-		switch (errno) {
-		case EACCES:
-			*errstr = ERR_NO_ACCESS;
-			break;
-		case ENOENT:
-			*errstr = ERR_NOT_FOUND;
-			break;
-		default:
-			*errstr = ERR_GENERIC;
-			break;
-		}
+	TRACE_FS();
+	if (stat(".", sb) == -1) {
+		*errstr = cwd_errstr(errno);
 		return;
 	}
 
-	if (stat(wd, &sa) == -1) {
-		*errstr = ERR_GENERIC;
+	wd_env = getenv("PWD");
+	TRACE_FS();
+	if (wd_env != NULL && *wd_env == '/' && stat(wd_env, &pb) == 0 &&
+	    pb.st_ino == sb->st_ino && pb.st_dev == sb->st_dev &&
+	    strlcpy(wd, wd_env, len) < len)
 		return;
-	}
 
-	/*
-	 * If we can get a valid PWD from the environment, that turns out to be
-	 * the same directory, then we should use it, it provides more context
-	 * if the shell is located in a symlink.
-	 */
-	wd_env = getenv("PWD");
-	if (wd_env != NULL && stat(wd_env, &sb) == 0) {
-		if (sa.st_ino == sb.st_ino && sa.st_dev == sb.st_dev) {
-			strlcpy(wd, wd_env, MAXPATHLEN);
+	TRACE_FS();
+	if (getcwd(wd, len) == NULL)
+		*errstr = cwd_errstr(errno);
+}
+
+/*
+ * Write the physical path of the current directory to wd, symbolic links
+ * resolved.  Unlike the path from path_cwd(), its parents are the directories
+ * ".." leads to, which is what searches walking up the tree need.
+ */
+void
+path_cwd_physical(char *wd, size_t len, const char **errstr)
+{
+	*errstr = NULL;
+
+	TRACE_FS();
+	if (getcwd(wd, len) == NULL)
+		*errstr = cwd_errstr(errno);
+}
+#endif /* ifndef REGRESS */
+
+/*
+ * Parse the arguments of the path command in o.  Returns NULL or the error
+ * string to display instead of the path.
+ */
+const char *
+cmd_path_parse(int argc, char **argv, struct path_opts *o)
+{
+	const char *errstr = NULL;
+	int ch;
+
+	memset(o, 0, sizeof(*o));
+	strlcpy(o->filler, DEFAULT_FILLER, MAX_FILLER_LEN);
+
+	poptreset = 1;
+	poptind = 0;
+	popterr = 0;
+	while ((ch = pgetopt(argc, argv, "cl:f:nu")) != -1) {
+		switch (ch) {
+		case 'c':
+			o->cleancut = 1;
+			break;
+		case 'l':
+			o->maxlen = strtonum(poptarg, 1, 255, &errstr);
+			if (o->maxlen == 0)
+				return (ERR_BAD_ARG);
+			break;
+		case 'f':
+			strlcpy(o->filler, poptarg, MAX_FILLER_LEN);
+			break;
+		case 'n':
+			o->newsgroupize = 1;
+			break;
+		case 'u':
+			o->uniqueize = 1;
+			break;
+		default:
+			return (ERR_BAD_ARG);
 		}
 	}
 
-	if (mbstowcs(wcswd, wd, len) == (size_t)-1) {
-		*errstr = ERR_BAD_CHARSET;
-		return;
-	}
+	return (NULL);
 }
-#endif /* ifndef REGRESS */
 
 /*
  * This module should never crash and will always return a value on out.  If
@@ -102,64 +158,58 @@ path_wcswd(wchar_t *wcswd, size_t len, const wchar_t **errstr)
  * the prompt output).
  */
 void
-cmd_path_exec(int argc, wchar_t **argv, wchar_t *out, size_t len)
+cmd_path_run(const struct path_opts *o, char *out, size_t len)
 {
-	int cleancut = 0;
-	int newsgroupize = 0;
-	size_t maxlen = 0;
-	const wchar_t *errstr = NULL;
-	wchar_t ch, wcswd[MAXPATHLEN];
-	wchar_t buf[MAX_OUTPUT_LEN];
-	wchar_t filler[MAX_FILLER_LEN] = DEFAULT_FILLER;
-
-	path_wcswd(wcswd, MAXPATHLEN, &errstr);
-	if (errstr != NULL) {
-		wcslcpy(out, errstr, len);
+	const char *errstr = NULL;
+	const char *cwd;
+	struct path_index pi;
+	char *buf;
+
+	if ((cwd = fact_cwd(&errstr)) == NULL) {
+		strlcpy(out, errstr, len);
 		return;
 	}
 
-	woptreset = 1;
-	woptind = 0;
-	wopterr = 0;
-	while ((ch = wgetopt(argc, argv, L"cl:f:n")) != -1) {
-		switch (ch) {
-		case L'c':
-			cleancut = 1;
-			break;
-		case L'l':
-			maxlen = wcstonum(woptarg, 1, 255, &errstr);
-			if (maxlen == 0) {
-				wcslcpy(out, ERR_BAD_ARG, len);
-				return;
-			}
-			break;
-		case L'f':
-			wcslcpy(filler, woptarg, MAX_FILLER_LEN);
-			break;
-		case L'n':
-			newsgroupize = 1;
-			break;
-		default:
-			wcslcpy(out, ERR_BAD_ARG, len);
-			return;
-		}
+	/* Released by template_exec_cmd(), as everything the command took. */
+	if ((buf = arena_alloc(len)) == NULL) {
+		strlcpy(out, ERR_GENERIC, len);
+		return;
 	}
+	alias_replace_recursive(buf, cwd, len);
+	path_index_build(&pi, buf);
 
-	alias_replace_recursive(buf, wcswd, MAX_OUTPUT_LEN);
+	if (o->newsgroupize) {
+		path_newsgroupize(out, &pi, len);
+		return;
+	}
 
-	if (newsgroupize) {
-		path_newsgroupize(out, buf, len);
+	if (o->uniqueize) {
+		path_uniqueize(out, &pi, cwd, len);
 		return;
 	}
 
-	if (maxlen > 0 && wcslen(buf) > maxlen) {
-		if (cleancut) {
-			path_cleancut(out, buf, len, maxlen, filler);
+	if (o->maxlen > 0 && path_index_width_from(&pi, 0) > o->maxlen) {
+		if (o->cleancut) {
+			path_cleancut(out, &pi, len, o->maxlen, o->filler);
 		} else {
-			path_quickcut(out, buf, len, maxlen, filler);
+			path_quickcut(out, &pi, len, o->maxlen, o->filler);
 		}
 		return;
 	}
 
-	wcslcpy(out, buf, len);
+	strlcpy(out, buf, len);
+}
+
+void
+cmd_path_exec(int argc, char **argv, char *out, size_t len)
+{
+	struct path_opts o;
+	const char *errstr;
+
+	if ((errstr = cmd_path_parse(argc, argv, &o)) != NULL) {
+		strlcpy(out, errstr, len);
+		return;
+	}
+
+	cmd_path_run(&o, out, len);
 }
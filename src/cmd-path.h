@@ -17,7 +17,41 @@
 #ifndef _PATH_H_
 #define _PATH_H_
 
-#include <wchar.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stddef.h>
+
+#include "prwd.h"
+
+/* Maximum number of components in an indexed path */
+#define MAX_PATH_COMPONENTS (MAX_OUTPUT_LEN / 2)
+
+/*
+ * path: the indexed path
+ * count: number of components
+ * ascii: whether the path is pure ASCII (one column per byte)
+ * off: byte offset of each component, off[count] is the length of the path
+ * width: columns before each component, width[count] is the path width
+ */
+struct path_index {
+	const char	*path;
+	size_t		 count;
+	int		 ascii;
+	size_t		 off[MAX_PATH_COMPONENTS + 1];
+	size_t		 width[MAX_PATH_COMPONENTS + 1];
+};
+
+/*
+ * Options of the path command, see prwd.1.
+ */
+struct path_opts {
+	int		 cleancut;
+	int		 newsgroupize;
+	int		 uniqueize;
+	size_t		 maxlen;
+	char		 filler[MAX_FILLER_LEN];
+};
 
 enum {
 	ERR_NO_ACCESS = 1,
@@ -27,9 +61,19 @@ enum {
 	ERR_GENERIC
 };
 
-void	 path_wcswd(wchar_t *, size_t, const wchar_t **);
-void	 cmd_path_exec(int, wchar_t **, wchar_t *, size_t);
-void	 path_newsgroupize(wchar_t *, const wchar_t *, size_t);
-void	 path_cleancut(wchar_t *, wchar_t *, size_t, size_t, wchar_t *);
-void	 path_quickcut(wchar_t *, wchar_t *, size_t, size_t, wchar_t *);
+void	 path_cwd(char *, size_t, struct stat *, const char **);
+void	 path_cwd_physical(char *, size_t, const char **);
+const char *cmd_path_parse(int, char **, struct path_opts *);
+void	 cmd_path_run(const struct path_opts *, char *, size_t);
+void	 cmd_path_exec(int, char **, char *, size_t);
+void	 path_index_build(struct path_index *, const char *);
+size_t	 path_index_width_from(const struct path_index *, size_t);
+const char *path_index_skip(const struct path_index *, size_t);
+void	 path_newsgroupize(char *, const struct path_index *, size_t);
+void	 path_uniqueize(char *, const struct path_index *, const char *,
+	    size_t);
+void	 path_cleancut(char *, const struct path_index *, size_t, size_t,
+	    const char *);
+void	 path_quickcut(char *, const struct path_index *, size_t, size_t,
+	    const char *);
 #endif /* #ifndef _PATH_H_ */
@@ -14,12 +14,29 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
+#include <string.h>
 
 #include "cmd-sep.h"
-#include "wcslcpy.h"
+#include "strlcpy.h"
 
-#define ERR_BAD_ARG L"<sep-bad-arg>"
+#define ERR_BAD_ARG "<sep-bad-arg>"
+
+/*
+ * Parse the arguments of the sep command in o.  Returns NULL or the error
+ * string to display instead of the separator.
+ */
+const char *
+cmd_sep_parse(int argc, char **argv, struct sep_opts *o)
+{
+	o->text = NULL;
+
+	if (argc != 2)
+		return (ERR_BAD_ARG);
+
+	o->text = argv[1];
+
+	return (NULL);
+}
 
 /*
  * This module should never crash and will always return a value on *out.  If
@@ -27,15 +44,21 @@
  * readable format on *out.
  */
 void
-cmd_sep_exec(int argc, wchar_t **argv, wchar_t *out, size_t len)
+cmd_sep_run(const struct sep_opts *o, char *out, size_t len)
+{
+	strlcpy(out, o->text, len);
+}
+
+void
+cmd_sep_exec(int argc, char **argv, char *out, size_t len)
 {
-	(void)argc;
-	(void)argv;
+	struct sep_opts o;
+	const char *errstr;
 
-	if (argc != 2) {
-		wcslcpy(out, ERR_BAD_ARG, len);
+	if ((errstr = cmd_sep_parse(argc, argv, &o)) != NULL) {
+		strlcpy(out, errstr, len);
 		return;
 	}
 
-	swprintf(out, len, L"%ls", argv[1]);
+	cmd_sep_run(&o, out, len);
 }
@@ -14,4 +14,20 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-void	 cmd_sep_exec(int, wchar_t **, wchar_t *, size_t);
+#ifndef _CMD_SEP_H_
+#define _CMD_SEP_H_
+
+#include <stddef.h>
+
+/*
+ * text: separator, points in the arguments
+ */
+struct sep_opts {
+	const char	*text;
+};
+
+const char *cmd_sep_parse(int, char **, struct sep_opts *);
+void	 cmd_sep_run(const struct sep_opts *, char *, size_t);
+void	 cmd_sep_exec(int, char **, char *, size_t);
+
+#endif /* ifndef _CMD_SEP_H_ */
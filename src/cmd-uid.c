@@ -16,17 +16,39 @@
 
 #include <sys/param.h>
 
+#include <string.h>
 #include <unistd.h>
-#include <wchar.h>
 
 #include "cmd-uid.h"
-#include "wcslcpy.h"
-#include "wgetopt.h"
+#include "pgetopt.h"
+#include "strlcpy.h"
 
-#define ERR_BAD_ARG L"<uid-bad-arg>"
+#define ERR_BAD_ARG "<uid-bad-arg>"
 
 /*
- * Return a string of wide-characters representing the current UID.  The
+ * The uid command takes no option.  Returns NULL or the error string to
+ * display instead of the indicator.
+ */
+const char *
+cmd_uid_parse(int argc, char **argv)
+{
+	int ch;
+
+	poptreset = 1;
+	poptind = 0;
+	popterr = 0;
+	while ((ch = pgetopt(argc, argv, "")) != -1) {
+		switch (ch) {
+		default:
+			return (ERR_BAD_ARG);
+		}
+	}
+
+	return (NULL);
+}
+
+/*
+ * Return a string representing the current UID.  The
  * default settings show a hash sign '#' when the user is root (uid=0) and a
  * dollar sign for all other users.
  *
@@ -35,27 +57,23 @@
  * readable format on *out.
  */
 void
-cmd_uid_exec(int argc, wchar_t **argv, wchar_t *out, size_t len)
+cmd_uid_run(char *out, size_t len)
 {
-	wchar_t ch;
+	(void)len;
 
-	woptreset = 1;
-	woptind = 0;
-	wopterr = 0;
-	while ((ch = wgetopt(argc, argv, L"")) != -1) {
-		switch (ch) {
-		default:
-			wcslcpy(out, ERR_BAD_ARG, len);
-			return;
-		}
-	}
+	out[0] = getuid() == 0 ? '#' : '$';
+	out[1] = '\0';
+}
+
+void
+cmd_uid_exec(int argc, char **argv, char *out, size_t len)
+{
+	const char *errstr;
 
-	if (getuid() == 0) {
-		ch = L'#';
-	} else {
-		ch = L'$';
+	if ((errstr = cmd_uid_parse(argc, argv)) != NULL) {
+		strlcpy(out, errstr, len);
+		return;
 	}
 
-	out[0] = ch;
-	out[1] = L'\0';
+	cmd_uid_run(out, len);
 }
@@ -14,4 +14,6 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-void	 cmd_uid_exec(int, wchar_t **, wchar_t *, size_t);
+const char *cmd_uid_parse(int, char **);
+void	 cmd_uid_run(char *, size_t);
+void	 cmd_uid_exec(int, char **, char *, size_t);
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "cmd-branch.h"
+#include "cmd-uid.h"
+#include "command.h"
+#include "strlcpy.h"
+
+static const struct {
+	const char		*name;
+	enum command_type	 type;
+} commands[] = {
+	{ "branch",	CMD_BRANCH },
+	{ "color",	CMD_COLOR },
+	{ "date",	CMD_DATE },
+	{ "exec",	CMD_EXEC },
+	{ "hostname",	CMD_HOSTNAME },
+	{ "path",	CMD_PATH },
+	{ "sep",	CMD_SEP },
+	{ "uid",	CMD_UID },
+};
+
+/*
+ * Find the command named by argv[0] and parse the rest of the arguments into
+ * its options.  Invalid arguments are not an error here, they are recorded in
+ * cmd->error.  Returns -1 if there is no such command.
+ *
+ * The string options point in argv, which has to live as long as cmd.
+ */
+int
+command_parse(struct command *cmd, int argc, char **argv)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+		if (strcmp(commands[i].name, argv[0]) == 0)
+			break;
+	}
+	if (i == sizeof(commands) / sizeof(commands[0]))
+		return (-1);
+
+	cmd->type = commands[i].type;
+	cmd->error = NULL;
+
+	switch (cmd->type) {
+	case CMD_BRANCH:
+		break;
+	case CMD_COLOR:
+		cmd->error = cmd_color_parse(argc, argv, &cmd->opts.color);
+		break;
+	case CMD_DATE:
+		cmd->error = cmd_date_parse(argc, argv, &cmd->opts.date);
+		break;
+	case CMD_EXEC:
+		cmd->error = cmd_exec_parse(argc, argv, &cmd->opts.exec);
+		break;
+	case CMD_HOSTNAME:
+		cmd->error = cmd_hostname_parse(argc, argv,
+		    &cmd->opts.hostname);
+		break;
+	case CMD_PATH:
+		cmd->error = cmd_path_parse(argc, argv, &cmd->opts.path);
+		break;
+	case CMD_SEP:
+		cmd->error = cmd_sep_parse(argc, argv, &cmd->opts.sep);
+		break;
+	case CMD_UID:
+		cmd->error = cmd_uid_parse(argc, argv);
+		break;
+	}
+
+	return (0);
+}
+
+/*
+ * Write the output of the command on out.
+ */
+void
+command_run(const struct command *cmd, char *out, size_t len)
+{
+	if (cmd->error != NULL) {
+		strlcpy(out, cmd->error, len);
+		return;
+	}
+
+	switch (cmd->type) {
+	case CMD_BRANCH:
+		cmd_branch_run(out, len);
+		break;
+	case CMD_COLOR:
+		cmd_color_run(&cmd->opts.color, out, len);
+		break;
+	case CMD_DATE:
+		cmd_date_run(&cmd->opts.date, out, len);
+		break;
+	case CMD_EXEC:
+		cmd_exec_run(&cmd->opts.exec, out, len);
+		break;
+	case CMD_HOSTNAME:
+		cmd_hostname_run(&cmd->opts.hostname, out, len);
+		break;
+	case CMD_PATH:
+		cmd_path_run(&cmd->opts.path, out, len);
+		break;
+	case CMD_SEP:
+		cmd_sep_run(&cmd->opts.sep, out, len);
+		break;
+	case CMD_UID:
+		cmd_uid_run(out, len);
+		break;
+	}
+}
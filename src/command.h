@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * A command of a template (e.g. "path -l 24") with its arguments parsed once
+ * into the options of that command.  Running it only reads the options, the
+ * same command can be run by any number of renders.
+ */
+
+#ifndef _COMMAND_H_
+#define _COMMAND_H_
+
+#include <stddef.h>
+
+#include "cmd-color.h"
+#include "cmd-date.h"
+#include "cmd-exec.h"
+#include "cmd-hostname.h"
+#include "cmd-path.h"
+#include "cmd-sep.h"
+
+enum command_type {
+	CMD_BRANCH,
+	CMD_COLOR,
+	CMD_DATE,
+	CMD_EXEC,
+	CMD_HOSTNAME,
+	CMD_PATH,
+	CMD_SEP,
+	CMD_UID
+};
+
+/*
+ * type: which command
+ * error: if the arguments were invalid, the string to display instead of the
+ *        output of the command (e.g. "<path-bad-arg>"), else NULL
+ * opts: the parsed options of that command
+ */
+struct command {
+	enum command_type	 type;
+	const char		*error;
+	union {
+		struct color_opts	 color;
+		struct date_opts	 date;
+		struct exec_opts	 exec;
+		struct hostname_opts	 hostname;
+		struct path_opts	 path;
+		struct sep_opts		 sep;
+	} opts;
+};
+
+int	 command_parse(struct command *, int, char **);
+void	 command_run(const struct command *, char *, size_t);
+
+#endif /* ifndef _COMMAND_H_ */
@@ -19,14 +19,19 @@
 #include <err.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "alias.h"
 #include "config.h"
+#include "context.h"
+#include "probes.h"
 #include "prwd.h"
 #include "strdelim.h"
 #include "utils.h"
-#include "wcslcpy.h"
-#include "wcstonum.h"
+#include "strlcpy.h"
+#include "strtonum.h"
+#include "template.h"
+#include "trace.h"
 
 int 	 cfg_cleancut = 0;
 size_t	 cfg_maxpwdlen = MAXPWD_LEN;
@@ -35,10 +40,14 @@ int	 cfg_git = 1;
 int	 cfg_hostname = 1;
 int	 cfg_uid_indicator = 1;
 int	 cfg_newsgroup = 0;
-wchar_t	 cfg_filler[MAX_FILLER_LEN] = DEFAULT_FILLER;
-wchar_t	 cfg_template[MAX_OUTPUT_LEN] = L"";
+int	 cfg_stats = 0;
+int	 cfg_width = 0;
+char	 cfg_filler[MAX_FILLER_LEN] = DEFAULT_FILLER;
+char	 cfg_template[MAX_OUTPUT_LEN] = "";
+char	 cfg_rtemplate[MAX_OUTPUT_LEN] = "";
+char	 cfg_title[MAX_OUTPUT_LEN] = "";
 
-extern wchar_t	 home[MAXPATHLEN];
+extern char	 home[MAXPATHLEN];
 
 #define GET_BOOLEAN(v) (v != NULL && *v == 'o') ? 1 : 0
 
@@ -48,75 +57,115 @@ extern wchar_t	 home[MAXPATHLEN];
  * an error string, it is set to NULL otherwise.
  */
 static void
-set_variable(wchar_t *name, wchar_t *value, const wchar_t **errstrp)
+set_variable(char *name, char *value, const char **errstrp)
 {
 	*errstrp = NULL;
 
-	if (wcscmp(name, L"maxlength") == 0) {
-		if (value == NULL || *value == L'\0') {
-			*errstrp = L"no value for set maxlength";
+	if (strcmp(name, "maxlength") == 0) {
+		if (value == NULL || *value == '\0') {
+			*errstrp = "no value for set maxlength";
 			return;
 		}
 
-		cfg_maxpwdlen = wcstonum(value, 1, 255, errstrp);
+		cfg_maxpwdlen = strtonum(value, 1, 255, errstrp);
 		if (cfg_maxpwdlen == 0) {
-			*errstrp = L"invalid number for set maxlength";
+			*errstrp = "invalid number for set maxlength";
 			return;
 		}
 
 	/* set filler <string> */
-	} else if (wcscmp(name, L"filler") == 0) {
-		if (value == NULL || *value == L'\0') {
-			*cfg_filler = L'\0';
+	} else if (strcmp(name, "filler") == 0) {
+		if (value == NULL || *value == '\0') {
+			*cfg_filler = '\0';
 			return;
 		}
-		wcslcpy(cfg_filler, value, MAX_FILLER_LEN);
+		strlcpy(cfg_filler, value, MAX_FILLER_LEN);
 
 	/* set cleancut <bool> */
-	} else if (wcscmp(name, L"cleancut") == 0) {
+	} else if (strcmp(name, "cleancut") == 0) {
 		cfg_cleancut = GET_BOOLEAN(value);
 
 	/* set mercurial <bool> */
-	} else if (wcscmp(name, L"mercurial") == 0) {
+	} else if (strcmp(name, "mercurial") == 0) {
 		cfg_mercurial = GET_BOOLEAN(value);
 
 	/* set git <bool> */
-	} else if (wcscmp(name, L"git") == 0) {
+	} else if (strcmp(name, "git") == 0) {
 		cfg_git = GET_BOOLEAN(value);
 
 	/* set hostname <bool> */
-	} else if (wcscmp(name, L"hostname") == 0) {
+	} else if (strcmp(name, "hostname") == 0) {
 		cfg_hostname = GET_BOOLEAN(value);
 
 	/* set uid_indicator <bool> */
-	} else if (wcscmp(name, L"uid_indicator") == 0) {
+	} else if (strcmp(name, "uid_indicator") == 0) {
 		cfg_uid_indicator = GET_BOOLEAN(value);
 
 	/* set newsgroup <bool> */
-	} else if (wcscmp(name, L"newsgroup") == 0) {
+	} else if (strcmp(name, "newsgroup") == 0) {
 		cfg_newsgroup = GET_BOOLEAN(value);
 
+	/* set stats <bool> */
+	} else if (strcmp(name, "stats") == 0) {
+		cfg_stats = GET_BOOLEAN(value);
+
+	/* set width <percent> */
+	} else if (strcmp(name, "width") == 0) {
+		if (value == NULL || *value == '\0') {
+			*errstrp = "no value for set width";
+			return;
+		}
+
+		cfg_width = strtonum(value, 0, 100, errstrp);
+		if (*errstrp != NULL) {
+			*errstrp = "invalid percentage for set width";
+			return;
+		}
+
 	/* Unknown variable */
 	} else {
-		*errstrp = L"unknown variable for set";
+		*errstrp = "unknown variable for set";
 	}
 }
 
+/*
+ * Store the template found on the rest of the line to the given template
+ * variable, each template can only be defined once.  Its commands are parsed
+ * right away, invalid options are reported against this line.
+ */
+static void
+set_template(char *tmpl, char *line, const char **errstrp)
+{
+	char *value;
+
+	if ((value = strdelim(&line)) == NULL) {
+		*errstrp = "template without value";
+		return;
+	}
+	if (tmpl[0] != '\0') {
+		*errstrp = "template is already defined";
+		return;
+	}
+	strlcpy(tmpl, value, MAX_OUTPUT_LEN);
+	template_compile(tmpl, errstrp);
+}
+
 /*
  * Parse a single line of the configuration file.  If any error occurs, the
  * errstrp pointer is set to the error message, else it is set to NULL.
  */
 void
-process_config_line(wchar_t *line, const wchar_t **errstrp)
+process_config_line(char *line, const char **errstrp)
 {
+	struct context *ctx;
 	int len;
-	wchar_t *keyword, *name, *value;
+	char *keyword, *name, *value;
 
 	*errstrp = NULL;
 
         /* Strip trailing whitespace */
-	for (len = wcslen(line) - 1; len > 0; len--) {
-		if (wcschr(WHITESPACE, line[len]) == NULL)
+	for (len = strlen(line) - 1; len > 0; len--) {
+		if (strchr(WHITESPACE, line[len]) == NULL)
 			break;
 		line[len] = '\0';
 	}
@@ -134,10 +183,29 @@ process_config_line(wchar_t *line, const wchar_t **errstrp)
 	    *keyword == '\n' || *keyword == '#')
 		return;
 
+	/* Inside a context, everything but the templates is a condition. */
+	if ((ctx = context_current()) != NULL) {
+		if (strcmp(keyword, "}") == 0) {
+			context_close();
+		} else if (strcmp(keyword, "context") == 0) {
+			*errstrp = "context inside a context";
+		} else if (strcmp(keyword, "template") == 0) {
+			set_template(ctx->template, line, errstrp);
+		} else if (strcmp(keyword, "rtemplate") == 0) {
+			set_template(ctx->rtemplate, line, errstrp);
+		} else if (strcmp(keyword, "title") == 0) {
+			set_template(ctx->title, line, errstrp);
+		} else {
+			value = strdelim(&line);
+			context_add_condition(keyword, value, errstrp);
+		}
+		return;
+	}
+
 	/* set varname value */
-	if (wcscmp(keyword, L"set") == 0) {
+	if (strcmp(keyword, "set") == 0) {
 		if ((name = strdelim(&line)) == NULL) {
-			*errstrp = L"set without variable name";
+			*errstrp = "set without variable name";
 			return;
 		}
 		value = strdelim(&line);
@@ -145,31 +213,47 @@ process_config_line(wchar_t *line, const wchar_t **errstrp)
 		return;
 
 	/* alias short long */
-	} else if (wcscmp(keyword, L"alias") == 0) {
+	} else if (strcmp(keyword, "alias") == 0) {
 		if ((name = strdelim(&line)) == NULL) {
-			*errstrp = L"alias without name";
+			*errstrp = "alias without name";
+			return;
+		}
+		if ((value = strdelim(&line)) == NULL) {
+			*errstrp = "alias without path";
 			return;
 		}
-		value = strdelim(&line);
 		alias_add(name, value, errstrp);
 		if (*errstrp != NULL) {
 			return;
 		}
 
 	/* template value */
-	} else if (wcscmp(keyword, L"template") == 0) {
-		if ((value = strdelim(&line)) == NULL) {
-			*errstrp = L"template without value";
+	} else if (strcmp(keyword, "template") == 0) {
+		set_template(cfg_template, line, errstrp);
+
+	/* rtemplate value */
+	} else if (strcmp(keyword, "rtemplate") == 0) {
+		set_template(cfg_rtemplate, line, errstrp);
+
+	/* title value */
+	} else if (strcmp(keyword, "title") == 0) {
+		set_template(cfg_title, line, errstrp);
+
+	/* context name { */
+	} else if (strcmp(keyword, "context") == 0) {
+		if ((name = strdelim(&line)) == NULL || *name == '\0') {
+			*errstrp = "context without name";
 			return;
 		}
-		if (cfg_template[0] != L'\0') {
-			*errstrp = L"template is already defined";
+		value = strdelim(&line);
+		if (value == NULL || strcmp(value, "{") != 0) {
+			*errstrp = "context without {";
 			return;
 		}
-		wcslcpy(cfg_template, value, MAX_OUTPUT_LEN);
+		context_open(name, errstrp);
 
 	} else {
-		*errstrp = L"unknown command";
+		*errstrp = "unknown command";
 	}
 }
 
@@ -180,29 +264,36 @@ void
 read_config()
 {
 	FILE *fp;
-	char line[128], path[MAXPATHLEN];
-	const wchar_t *errstr;
-	wchar_t wline[128];
+	char line[MAX_OUTPUT_LEN], path[MAXPATHLEN];
+	const char *errstr;
 	int linenum = 1;
 
-	snprintf(path, MAXPATHLEN, "%ls/.prwdrc", home);
+	snprintf(path, MAXPATHLEN, "%s/.prwdrc", home);
+	PROBE_CONFIG_START(path);
 
+	TRACE_FS();
 	fp = fopen(path, "r");
-	if (fp == NULL)
+	if (fp == NULL) {
+		PROBE_CONFIG_END(path, 0);
 		return;
+	}
 
-	alias_add(L"~", home, &errstr);
+	alias_add("~", home, &errstr);
 	if (errstr != NULL)
-		errx(1, "failed to add default \"~\" alias: %ls", errstr);
+		errx(1, "failed to add default \"~\" alias: %s", errstr);
 
 	while (fgets(line, sizeof(line), fp)) {
-		mbstowcs(wline, line, 128);
-		process_config_line(wline, &errstr);
+		process_config_line(line, &errstr);
 		if (errstr != NULL) {
-			errx(1, "prwdrc:%d: %ls", linenum, errstr);
+			errx(1, "prwdrc:%d: %s", linenum, errstr);
 		}
 		linenum++;
 	}
 
 	fclose(fp);
+
+	if (context_current() != NULL)
+		errx(1, "prwdrc:%d: unterminated context", linenum);
+
+	PROBE_CONFIG_END(path, linenum - 1);
 }
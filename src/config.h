@@ -14,7 +14,7 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
+#include <stddef.h>
 
 void	 read_config(void);
-void	 process_config_line(wchar_t *, const wchar_t **);
+void	 process_config_line(char *, const char **);
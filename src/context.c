@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/param.h>
+
+#include <fnmatch.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "context.h"
+#include "facts.h"
+#include "strlcpy.h"
+#include "strtonum.h"
+
+extern char	 home[MAXPATHLEN];
+
+/*
+ * All the contexts in the order they were defined and the conditions they
+ * share.  A condition's result is -1 until it is evaluated.
+ */
+static struct context	 contexts[MAX_CONTEXTS];
+static size_t		 context_count = 0;
+static int		 context_opened = 0;
+static struct condition	 conditions[MAX_CONDITIONS];
+static size_t		 condition_count = 0;
+
+/*
+ * Start the definition of a new context, all the conditions and templates
+ * until context_close() belong to it.
+ */
+void
+context_open(const char *name, const char **errstrp)
+{
+	struct context *ctx;
+
+	*errstrp = NULL;
+
+	if (context_opened) {
+		*errstrp = "context inside a context";
+		return;
+	}
+	if (context_count >= MAX_CONTEXTS) {
+		*errstrp = "too many contexts";
+		return;
+	}
+
+	ctx = &contexts[context_count++];
+	memset(ctx, 0, sizeof(*ctx));
+	strlcpy(ctx->name, name, MAX_CONTEXT_NAME_LEN);
+	context_opened = 1;
+}
+
+/*
+ * Parse "HH:MM" into minutes since midnight, -1 on error.
+ */
+static long long
+parse_time_of_day(const char *s)
+{
+	char buf[8], *c;
+	const char *errstr;
+	long long h, m;
+
+	strlcpy(buf, s, sizeof(buf));
+	buf[strcspn(buf, "-")] = '\0';
+	if ((c = strchr(buf, ':')) == NULL)
+		return (-1);
+	*c = '\0';
+
+	h = strtonum(buf, 0, 23, &errstr);
+	if (errstr != NULL)
+		return (-1);
+	m = strtonum(c + 1, 0, 59, &errstr);
+	if (errstr != NULL)
+		return (-1);
+
+	return (h * 60 + m);
+}
+
+/*
+ * Fill the condition from its keyword and value (e.g. "uid" and "0"), both
+ * numbers and patterns are checked here so that evaluating it cannot fail.
+ */
+void
+condition_parse(struct condition *cond, const char *keyword,
+    const char *value, const char **errstrp)
+{
+	const char *dash;
+
+	*errstrp = NULL;
+	memset(cond, 0, sizeof(*cond));
+	cond->result = -1;
+
+	if (strlen(value) >= MAX_CONDITION_LEN) {
+		*errstrp = "condition too long";
+		return;
+	}
+
+	if (strcmp(keyword, "uid") == 0) {
+		cond->type = COND_UID;
+		cond->from = strtonum(value, 0, UINT_MAX, errstrp);
+		if (*errstrp != NULL)
+			*errstrp = "invalid uid";
+	} else if (strcmp(keyword, "hostname") == 0) {
+		cond->type = COND_HOSTNAME;
+	} else if (strcmp(keyword, "time") == 0) {
+		cond->type = COND_TIME;
+		if ((dash = strchr(value, '-')) == NULL ||
+		    (cond->from = parse_time_of_day(value)) == -1 ||
+		    (cond->to = parse_time_of_day(dash + 1)) == -1)
+			*errstrp = "invalid time range (HH:MM-HH:MM)";
+	} else if (strcmp(keyword, "user") == 0) {
+		cond->type = COND_USER;
+	} else if (strcmp(keyword, "path") == 0) {
+		cond->type = COND_PATH;
+		/* Expand "~" now, home will not change. */
+		if (value[0] == '~' && (value[1] == '/' || value[1] == '\0')) {
+			if (snprintf(cond->pattern, MAX_CONDITION_LEN, "%s%s",
+			    home, value + 1) >= MAX_CONDITION_LEN)
+				*errstrp = "condition too long";
+			return;
+		}
+	} else if (strcmp(keyword, "vcs") == 0) {
+		cond->type = COND_VCS;
+		if (strcmp(value, "git") != 0 && strcmp(value, "hg") != 0 &&
+		    strcmp(value, "any") != 0 && strcmp(value, "none") != 0)
+			*errstrp = "invalid vcs (git, hg, any or none)";
+	} else {
+		*errstrp = "unknown condition";
+	}
+
+	strlcpy(cond->pattern, value, MAX_CONDITION_LEN);
+}
+
+/*
+ * Add a condition to the context being defined.  Identical conditions are only
+ * stored once and the context keeps its conditions sorted by cost.
+ */
+void
+context_add_condition(const char *keyword, const char *value,
+    const char **errstrp)
+{
+	struct context *ctx;
+	struct condition cond;
+	size_t i, idx;
+
+	if ((ctx = context_current()) == NULL) {
+		*errstrp = "condition outside of a context";
+		return;
+	}
+	if (value == NULL || *value == '\0') {
+		*errstrp = "condition without value";
+		return;
+	}
+
+	condition_parse(&cond, keyword, value, errstrp);
+	if (*errstrp != NULL)
+		return;
+
+	/* Checked first, a rejected condition should not take a slot. */
+	if (ctx->ncond >= MAX_CONTEXT_CONDITIONS) {
+		*errstrp = "too many conditions in context";
+		return;
+	}
+
+	for (idx = 0; idx < condition_count; idx++) {
+		if (conditions[idx].type == cond.type &&
+		    strcmp(conditions[idx].pattern, cond.pattern) == 0)
+			break;
+	}
+	if (idx == condition_count) {
+		if (condition_count >= MAX_CONDITIONS) {
+			*errstrp = "too many conditions";
+			return;
+		}
+		conditions[condition_count++] = cond;
+	}
+
+	/* Insertion sort, conditions of the same cost keep their order. */
+	for (i = ctx->ncond; i > 0; i--) {
+		if (conditions[ctx->conds[i - 1]].type <= cond.type)
+			break;
+		ctx->conds[i] = ctx->conds[i - 1];
+	}
+	ctx->conds[i] = idx;
+	ctx->ncond++;
+}
+
+/*
+ * Return the context being defined or NULL if we are not inside a context.
+ */
+struct context *
+context_current(void)
+{
+	if (!context_opened)
+		return (NULL);
+
+	return (&contexts[context_count - 1]);
+}
+
+void
+context_close(void)
+{
+	context_opened = 0;
+}
+
+/*
+ * Compute the result of a condition, the facts are only looked up here.
+ */
+int
+condition_eval(const struct condition *cond)
+{
+	const char *value, *head, *errstr;
+	enum vcs_types vcs;
+	struct tm *tm;
+	time_t now;
+	long long minutes;
+
+	switch (cond->type) {
+	case COND_UID:
+		return ((long long)getuid() == cond->from);
+	case COND_HOSTNAME:
+		value = fact_hostname();
+		break;
+	case COND_TIME:
+		now = time(NULL);
+		if ((tm = localtime(&now)) == NULL)
+			return (0);
+		minutes = tm->tm_hour * 60 + tm->tm_min;
+		/* Ranges such as 22:00-06:00 go over midnight. */
+		if (cond->from <= cond->to)
+			return (minutes >= cond->from && minutes < cond->to);
+		return (minutes >= cond->from || minutes < cond->to);
+	case COND_USER:
+		value = fact_user();
+		break;
+	case COND_PATH:
+		value = fact_cwd(&errstr);
+		break;
+	case COND_VCS:
+		vcs = fact_vcs(&head, &errstr);
+		if (strcmp(cond->pattern, "any") == 0)
+			return (vcs != VCS_NONE);
+		if (strcmp(cond->pattern, "none") == 0)
+			return (vcs == VCS_NONE);
+		if (strcmp(cond->pattern, "git") == 0)
+			return (vcs == VCS_GIT);
+		return (vcs == VCS_MERCURIAL);
+	default:
+		return (0);
+	}
+
+	if (value == NULL)
+		return (0);
+
+	return (fnmatch(cond->pattern, value, 0) == 0);
+}
+
+/*
+ * Return the first context whose conditions all match, NULL if none does.
+ */
+const struct context *
+context_select(void)
+{
+	struct context *ctx;
+	struct condition *cond;
+	size_t i, j;
+
+	for (i = 0; i < context_count; i++) {
+		ctx = &contexts[i];
+		for (j = 0; j < ctx->ncond; j++) {
+			cond = &conditions[ctx->conds[j]];
+			if (cond->result == -1)
+				cond->result = condition_eval(cond);
+			if (!cond->result)
+				break;
+		}
+		if (j == ctx->ncond)
+			return (ctx);
+	}
+
+	return (NULL);
+}
+
+/*
+ * Forget all the contexts, this is used by the test suite.
+ */
+void
+context_purge_all(void)
+{
+	context_count = 0;
+	context_opened = 0;
+	condition_count = 0;
+}
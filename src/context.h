@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Contexts are alternative sets of templates selected by conditions on the
+ * facts (uid, hostname, time, user, path, VCS), e.g.:
+ *
+ *	context work {
+ *		hostname lab*
+ *		path ~/src/prwd
+ *		template "${path} ${branch}$ "
+ *	}
+ *
+ * The first context whose conditions all match wins.  Identical conditions are
+ * shared between contexts and each one is evaluated at most once, the cheap
+ * ones first, so a context is discarded before its expensive facts are needed.
+ */
+
+#ifndef _CONTEXT_H_
+#define _CONTEXT_H_
+
+#include "prwd.h"
+
+#define MAX_CONTEXTS		16
+#define MAX_CONTEXT_NAME_LEN	32
+#define MAX_CONTEXT_CONDITIONS	8
+#define MAX_CONDITIONS		64
+#define MAX_CONDITION_LEN	256
+
+/* Ordered by how expensive the underlying fact is to compute. */
+enum condition_type {
+	COND_UID,
+	COND_HOSTNAME,
+	COND_TIME,
+	COND_USER,
+	COND_PATH,
+	COND_VCS,
+};
+
+struct condition {
+	enum condition_type	 type;
+	char			 pattern[MAX_CONDITION_LEN];
+	long long		 from;
+	long long		 to;
+	int			 result;
+};
+
+struct context {
+	char	 name[MAX_CONTEXT_NAME_LEN];
+	size_t	 conds[MAX_CONTEXT_CONDITIONS];
+	size_t	 ncond;
+	char	 template[MAX_OUTPUT_LEN];
+	char	 rtemplate[MAX_OUTPUT_LEN];
+	char	 title[MAX_OUTPUT_LEN];
+};
+
+void		 condition_parse(struct condition *, const char *, const char *,
+		    const char **);
+int		 condition_eval(const struct condition *);
+void		 context_open(const char *, const char **);
+void		 context_add_condition(const char *, const char *,
+		    const char **);
+struct context	*context_current(void);
+void		 context_close(void);
+const struct context *context_select(void);
+void		 context_purge_all(void);
+
+#endif /* ifndef _CONTEXT_H_ */
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Listings of the sub-directories of a directory, kept in the persistent
+ * cache and keyed by the directory's device, inode and modification time.
+ * As long as a directory is left untouched its listing is read back from the
+ * cache, without any getdents(2).
+ */
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cache.h"
+#include "dircache.h"
+#include "trace.h"
+
+/* Header line followed by the NUL-separated names. */
+static char listing[DIRCACHE_MAX_LEN];
+
+/*
+ * Read the directory, only keeping the entries which could be directories,
+ * append their names after the header already in listing.  Returns the total
+ * length or -1 on error or if it doesn't fit.
+ */
+static ssize_t
+read_listing(const char *dir, size_t hlen)
+{
+	DIR *dirp;
+	struct dirent *dp;
+	size_t len = hlen, n;
+
+	TRACE_FS();
+	if ((dirp = opendir(dir)) == NULL)
+		return (-1);
+
+	while ((dp = readdir(dirp)) != NULL) {
+		if (strcmp(dp->d_name, ".") == 0 ||
+		    strcmp(dp->d_name, "..") == 0)
+			continue;
+#ifdef DT_DIR
+		if (dp->d_type != DT_DIR && dp->d_type != DT_LNK &&
+		    dp->d_type != DT_UNKNOWN)
+			continue;
+#endif
+		n = strlen(dp->d_name) + 1;
+		if (len + n > sizeof(listing)) {
+			closedir(dirp);
+			return (-1);
+		}
+		memcpy(listing + len, dp->d_name, n);
+		len += n;
+	}
+
+	closedir(dirp);
+
+	return (len);
+}
+
+/*
+ * Return the NUL-separated names of the entries of 'dir' which could be
+ * directories, their total size is set on *lenp.  The result is only valid
+ * until the next call.  Returns NULL if the directory could not be read or
+ * has too many entries to be worth listing.
+ *
+ * A directory modified within the last second is not cached, another change
+ * within the same second would not change its modification time.
+ */
+const char *
+dircache_names(const char *dir, size_t *lenp)
+{
+	struct stat sb;
+	char name[64], header[64];
+	ssize_t len;
+	int hlen;
+
+	TRACE_FS();
+	if (stat(dir, &sb) == -1)
+		return (NULL);
+
+	snprintf(name, sizeof(name), "dir-%llx-%llx",
+	    (unsigned long long)sb.st_dev, (unsigned long long)sb.st_ino);
+	hlen = snprintf(header, sizeof(header), "%lld\n",
+	    (long long)sb.st_mtime);
+
+	len = cache_read(name, listing, sizeof(listing));
+	if (len >= hlen && memcmp(listing, header, hlen) == 0) {
+		*lenp = len - hlen;
+		return (listing + hlen);
+	}
+
+	memcpy(listing, header, hlen);
+	if ((len = read_listing(dir, hlen)) == -1)
+		return (NULL);
+
+	if (time(NULL) - sb.st_mtime > 1)
+		cache_write(name, listing, len);
+
+	*lenp = len - hlen;
+
+	return (listing + hlen);
+}
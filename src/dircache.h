@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2014 Bertrand Janin <b@janin.com>
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
  *
  * Permission to use, copy, modify, and distribute this software for any
  * purpose with or without fee is hereby granted, provided that the above
@@ -14,6 +14,14 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#ifdef HAS_NO_WCSLCPY
-size_t wcslcpy(wchar_t *, const wchar_t *, size_t);
-#endif
+#ifndef _DIRCACHE_H_
+#define _DIRCACHE_H_
+
+#include <stddef.h>
+
+/* Maximum size of a cached directory listing (bytes) */
+#define DIRCACHE_MAX_LEN 65536
+
+const char	*dircache_names(const char *, size_t *);
+
+#endif /* ifndef _DIRCACHE_H_ */
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/param.h>
+#include <sys/ioctl.h>
+
+#include <pwd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cmd-path.h"
+#include "facts.h"
+#include "fqdn.h"
+#include "probes.h"
+#include "strlcpy.h"
+#include "strtonum.h"
+#include "trace.h"
+#include "utils.h"
+
+#define ERR_BRANCH_CWD "<branch-cwd-error>"
+#define ERR_BRANCH_IO "<branch-io-error>"
+
+/*
+ * All the facts live here, a fact is only valid if its 'known' flag is set,
+ * errors are remembered the same way values are.
+ */
+static struct {
+	int		 cwd_known;
+	char		 cwd[MAXPATHLEN];
+	struct stat	 cwd_sb;
+	const char	*cwd_errstr;
+
+	int		 physical_known;
+	char		 physical[MAXPATHLEN];
+	const char	*physical_errstr;
+
+	int		 hostname_known;
+	char		 hostname[MAXHOSTNAMELEN];
+	int		 hostname_failed;
+
+	int		 user_known;
+	char		 user[MAX_USER_LEN];
+
+	int		 fqdn_known;
+	char		 fqdn[MAX_FQDN_LEN];
+
+	int		 vcs_known;
+	enum vcs_types	 vcs_type;
+	char		 vcs_head[BRANCH_FILE_BUFSIZE];
+	const char	*vcs_errstr;
+
+	int		 colors_known;
+	enum color_depth colors;
+
+	int		 columns_known;
+	size_t		 columns;
+
+	const char	*evaluated[FACT_COUNT];
+	size_t		 evaluated_count;
+} facts;
+
+/* Names of the facts, as listed by -D */
+static const char *fact_names[FACT_COUNT] = {
+	[FACT_CWD] = "cwd",
+	[FACT_PHYSICAL] = "physical",
+	[FACT_HOSTNAME] = "hostname",
+	[FACT_USER] = "user",
+	[FACT_FQDN] = "fqdn",
+	[FACT_VCS] = "vcs",
+	[FACT_COLORS] = "colors",
+	[FACT_COLUMNS] = "columns",
+};
+
+/*
+ * Remember that a fact was computed, in order, for debugging.  Each fact is
+ * computed once, there is room for all of them.
+ */
+static void
+fact_evaluated(enum fact fact)
+{
+	if (facts.evaluated_count < FACT_COUNT)
+		facts.evaluated[facts.evaluated_count++] = fact_names[fact];
+}
+
+/*
+ * Return the current directory as it should be displayed.  If it could not be
+ * determined, NULL is returned and *errstrp points to a replacement string.
+ */
+const char *
+fact_cwd(const char **errstrp)
+{
+	if (!facts.cwd_known) {
+		path_cwd(facts.cwd, MAXPATHLEN, &facts.cwd_sb,
+		    &facts.cwd_errstr);
+		facts.cwd_known = 1;
+		fact_evaluated(FACT_CWD);
+	}
+
+	*errstrp = facts.cwd_errstr;
+	if (facts.cwd_errstr != NULL)
+		return (NULL);
+
+	return (facts.cwd);
+}
+
+/*
+ * Return the current directory with its symbolic links resolved, to be used
+ * when looking for files in its parents.  Errors are reported as in fact_cwd().
+ */
+const char *
+fact_cwd_physical(const char **errstrp)
+{
+	if (!facts.physical_known) {
+		path_cwd_physical(facts.physical, MAXPATHLEN,
+		    &facts.physical_errstr);
+		facts.physical_known = 1;
+		fact_evaluated(FACT_PHYSICAL);
+	}
+
+	*errstrp = facts.physical_errstr;
+	if (facts.physical_errstr != NULL)
+		return (NULL);
+
+	return (facts.physical);
+}
+
+/*
+ * Return the stat(2) of the current directory (device, inode, etc.) or NULL if
+ * it could not be determined.
+ */
+const struct stat *
+fact_cwd_stat(void)
+{
+	const char *errstr;
+
+	if (fact_cwd(&errstr) == NULL)
+		return (NULL);
+
+	return (&facts.cwd_sb);
+}
+
+/*
+ * Return the full hostname as reported by the system or NULL on error.
+ */
+const char *
+fact_hostname(void)
+{
+	if (!facts.hostname_known) {
+		if (lgethostname(facts.hostname, MAXHOSTNAMELEN) != 0)
+			facts.hostname_failed = 1;
+		facts.hostname[MAXHOSTNAMELEN - 1] = '\0';
+		facts.hostname_known = 1;
+		fact_evaluated(FACT_HOSTNAME);
+	}
+
+	if (facts.hostname_failed)
+		return (NULL);
+
+	return (facts.hostname);
+}
+
+/*
+ * Return the name of the user running prwd or NULL if it has none.
+ */
+const char *
+fact_user(void)
+{
+	struct passwd *pw;
+
+	if (!facts.user_known) {
+		if ((pw = getpwuid(getuid())) != NULL)
+			strlcpy(facts.user, pw->pw_name, MAX_USER_LEN);
+		facts.user_known = 1;
+		fact_evaluated(FACT_USER);
+	}
+
+	if (facts.user[0] == '\0')
+		return (NULL);
+
+	return (facts.user);
+}
+
+/*
+ * Return how many colors the terminal can display.  There is no terminfo
+ * lookup: $COLORTERM announces truecolor, a "-direct" or "-256color" $TERM
+ * tells the rest and only the consoles known to be limited to 16 colors get
+ * downgraded, others are assumed to handle the 256-color palette.
+ */
+enum color_depth
+fact_colors(void)
+{
+	const char *colorterm, *term;
+
+	if (facts.colors_known)
+		return (facts.colors);
+
+	colorterm = getenv("COLORTERM");
+	term = getenv("TERM");
+	if (term == NULL)
+		term = "";
+
+	if (colorterm != NULL && (strcmp(colorterm, "truecolor") == 0 ||
+	    strcmp(colorterm, "24bit") == 0))
+		facts.colors = COLORS_TRUE;
+	else if (strstr(term, "-direct") != NULL)
+		facts.colors = COLORS_TRUE;
+	else if (strstr(term, "256color") != NULL)
+		facts.colors = COLORS_256;
+	else if (strcmp(term, "linux") == 0 || strcmp(term, "ansi") == 0 ||
+	    strcmp(term, "cons25") == 0 || strncmp(term, "vt", 2) == 0)
+		facts.colors = COLORS_16;
+	else
+		facts.colors = COLORS_256;
+
+	facts.colors_known = 1;
+	fact_evaluated(FACT_COLORS);
+
+	return (facts.colors);
+}
+
+/*
+ * Return the width of the terminal in columns, 0 if unknown.  $COLUMNS wins
+ * if it is exported, else the window size of the terminal on the standard
+ * error or input is used: the standard output is the shell reading the
+ * prompt.
+ */
+size_t
+fact_columns(void)
+{
+	struct winsize ws;
+	const char *s, *errstr;
+
+	if (facts.columns_known)
+		return (facts.columns);
+
+	facts.columns = 0;
+	if ((s = getenv("COLUMNS")) != NULL)
+		facts.columns = strtonum(s, 1, 65535, &errstr);
+	if (facts.columns == 0 &&
+	    (ioctl(STDERR_FILENO, TIOCGWINSZ, &ws) == 0 ||
+	    ioctl(STDIN_FILENO, TIOCGWINSZ, &ws) == 0))
+		facts.columns = ws.ws_col;
+
+	facts.columns_known = 1;
+	fact_evaluated(FACT_COLUMNS);
+
+	return (facts.columns);
+}
+
+/*
+ * Return the fully qualified domain name of this host, the hostname itself if
+ * it couldn't be determined in time or NULL on error.
+ */
+const char *
+fact_fqdn(void)
+{
+	const char *hostname;
+
+	if ((hostname = fact_hostname()) == NULL)
+		return (NULL);
+
+	if (!facts.fqdn_known) {
+		fqdn_lookup(hostname, facts.fqdn, MAX_FQDN_LEN);
+		facts.fqdn_known = 1;
+		fact_evaluated(FACT_FQDN);
+	}
+
+	return (facts.fqdn);
+}
+
+/*
+ * Recurse our way up from the physical current dir and find clues that we are
+ * within a source control repository, keep the content of its branch file
+ * around.
+ */
+static void
+vcs_lookup(void)
+{
+	FILE *fp;
+	char *c, pwd[MAXPATHLEN], path[MAXPATHLEN];
+	const char *cwd, *errstr;
+	size_t s;
+
+	facts.vcs_type = VCS_NONE;
+
+	if ((cwd = fact_cwd_physical(&errstr)) == NULL) {
+		facts.vcs_errstr = ERR_BRANCH_CWD;
+		return;
+	}
+	strlcpy(pwd, cwd, MAXPATHLEN);
+
+	for (;;) {
+		PROBE_ANCESTOR("vcs", pwd);
+
+		snprintf(path, MAXPATHLEN, "%s/.hg/branch", pwd);
+		if (path_is_valid(path)) {
+			facts.vcs_type = VCS_MERCURIAL;
+			break;
+		}
+
+		snprintf(path, MAXPATHLEN, "%s/.git/HEAD", pwd);
+		if (path_is_valid(path)) {
+			facts.vcs_type = VCS_GIT;
+			break;
+		}
+
+		if ((c = strrchr(pwd, '/')) == NULL)
+			break;
+
+		*c = '\0';
+	}
+
+	if (facts.vcs_type == VCS_NONE)
+		return;
+
+	TRACE_FS();
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		facts.vcs_errstr = ERR_BRANCH_IO;
+		return;
+	}
+
+	s = fread(facts.vcs_head, 1, BRANCH_FILE_BUFSIZE - 1, fp);
+	fclose(fp);
+	facts.vcs_head[s] = '\0';
+}
+
+/*
+ * Return the type of repository we are in, *headp points to the content of its
+ * branch file (e.g. .git/HEAD).  If anything went wrong, *errstrp is set to a
+ * replacement string.
+ */
+enum vcs_types
+fact_vcs(const char **headp, const char **errstrp)
+{
+	if (!facts.vcs_known) {
+		vcs_lookup();
+		facts.vcs_known = 1;
+		fact_evaluated(FACT_VCS);
+	}
+
+	*headp = facts.vcs_head;
+	*errstrp = facts.vcs_errstr;
+
+	return (facts.vcs_type);
+}
+
+/*
+ * Return the names of the facts computed so far in the order they were
+ * needed, *countp is set to their number.
+ */
+const char **
+facts_evaluated(size_t *countp)
+{
+	*countp = facts.evaluated_count;
+
+	return (facts.evaluated);
+}
+
+/*
+ * Forget everything we know, this is used by the test suite.
+ */
+void
+facts_purge_all(void)
+{
+	memset(&facts, 0, sizeof(facts));
+}
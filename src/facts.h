@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Facts are the pieces of context shared by all the template commands (current
+ * directory, hostname, VCS state).  Each of them is computed the first time it
+ * is needed and kept for the rest of the invocation, no matter how many
+ * commands or templates end up using it.
+ */
+
+#ifndef _FACTS_H_
+#define _FACTS_H_
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* How much to read of the branch file (e.g. HEAD, .hg/branch, etc.) */
+#define BRANCH_FILE_BUFSIZE 1024
+
+/* Maximum length of a user name */
+#define MAX_USER_LEN 256
+
+enum vcs_types { VCS_NONE, VCS_MERCURIAL, VCS_GIT };
+
+enum color_depth { COLORS_16, COLORS_256, COLORS_TRUE };
+
+/* The facts, FACT_COUNT is their number */
+enum fact {
+	FACT_CWD,
+	FACT_PHYSICAL,
+	FACT_HOSTNAME,
+	FACT_USER,
+	FACT_FQDN,
+	FACT_VCS,
+	FACT_COLORS,
+	FACT_COLUMNS,
+	FACT_COUNT
+};
+
+const char	*fact_cwd(const char **);
+const char	*fact_cwd_physical(const char **);
+const struct stat *fact_cwd_stat(void);
+const char	*fact_hostname(void);
+const char	*fact_fqdn(void);
+const char	*fact_user(void);
+enum vcs_types	 fact_vcs(const char **, const char **);
+enum color_depth fact_colors(void);
+size_t		 fact_columns(void);
+const char	**facts_evaluated(size_t *);
+void		 facts_purge_all(void);
+
+#endif /* ifndef _FACTS_H_ */
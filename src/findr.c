@@ -20,12 +20,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <wchar.h>
 
+#include "facts.h"
 #include "findr.h"
+#include "probes.h"
 #include "prwd.h"
 #include "utils.h"
-#include "wcslcpy.h"
+#include "strlcpy.h"
 
 
 #ifdef REGRESS
@@ -39,16 +40,19 @@ STATIC_INT
 _findr_target(char *out, size_t outlen, char *target_filename)
 {
 	char *c, pwd[MAXPATHLEN], path[MAXPATHLEN];
+	const char *cwd, *errstr;
 
 	if (target_filename == NULL) {
 		return 0;
 	}
 
-	if (getcwd(pwd, MAXPATHLEN) == NULL) {
+	if ((cwd = fact_cwd_physical(&errstr)) == NULL) {
 		errx(1, "unable to get current path");
 	}
+	strlcpy(pwd, cwd, MAXPATHLEN);
 
 	for (;;) {
+		PROBE_ANCESTOR("findr", pwd);
 		snprintf(path, MAXPATHLEN, "%s/%s", pwd, target_filename);
 		if (path_is_valid(path)) {
 			strlcpy(out, pwd, outlen);
@@ -68,15 +72,18 @@ STATIC_INT
 _findr_repository(char *out, size_t outlen)
 {
 	char *c, pwd[MAXPATHLEN];
+	const char *cwd, *errstr;
 
-	if (getcwd(pwd, MAXPATHLEN) == NULL) {
+	if ((cwd = fact_cwd_physical(&errstr)) == NULL) {
 		errx(1, "unable to get current path");
 	}
+	strlcpy(pwd, cwd, MAXPATHLEN);
 
 	for (;;) {
 		const char *suffixes[] = {".hg", ".git"};
 		char path[MAXPATHLEN];
 
+		PROBE_ANCESTOR("findr", pwd);
 		for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++) {
 			snprintf(path, MAXPATHLEN, "%s/%s", pwd, suffixes[i]);
 			if (path_is_valid(path)) {
@@ -99,15 +106,18 @@ STATIC_INT
 _findr_readme(char *out, size_t outlen)
 {
 	char *c, pwd[MAXPATHLEN];
+	const char *cwd, *errstr;
 
-	if (getcwd(pwd, MAXPATHLEN) == NULL) {
+	if ((cwd = fact_cwd_physical(&errstr)) == NULL) {
 		errx(1, "unable to get current path");
 	}
+	strlcpy(pwd, cwd, MAXPATHLEN);
 
 	for (;;) {
 		const char *suffixes[] = {"README", "README.md", "README.txt"};
 		char path[MAXPATHLEN];
 
+		PROBE_ANCESTOR("findr", pwd);
 		for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++) {
 			snprintf(path, MAXPATHLEN, "%s/%s", pwd, suffixes[i]);
 			if (path_is_valid(path)) {
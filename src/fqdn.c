@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Fully qualified domain name of this host.  The kernel hostname is often
+ * just the short name, the domain has to be found in /etc/hosts or through
+ * the resolver.  A prompt must never hang on DNS: the resolver runs in a
+ * child process which is given FQDN_TIMEOUT_MS to answer.  The answer of the
+ * resolver is stored in the persistent cache, even if we stopped waiting for
+ * it, so the next prompt shows the real name.  A failed lookup is not stored
+ * and is tried again by the next prompt.  The cache is valid until the
+ * hostname or /etc/hostname or /etc/hosts change.
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cache.h"
+#include "fqdn.h"
+#include "prwd.h"
+#include "strlcpy.h"
+#include "trace.h"
+#include "utils.h"
+
+#define FQDN_CACHE "fqdn"
+
+/*
+ * Find the fully qualified name of hostname in a hosts(5) file: the canonical
+ * name (or failing that, an alias with a domain) of the first line listing
+ * hostname.  Returns -1 if none was found.
+ */
+int
+fqdn_from_hosts(const char *path, const char *hostname, char *out, size_t len)
+{
+	FILE *fp;
+	char line[1024], *c, *names[64];
+	size_t count, i;
+	int found = -1;
+
+	TRACE_FS();
+	if ((fp = fopen(path, "r")) == NULL)
+		return (-1);
+
+	while (found == -1 && fgets(line, sizeof(line), fp) != NULL) {
+		if ((c = strchr(line, '#')) != NULL)
+			*c = '\0';
+
+		/* Skip the address, keep the names. */
+		if (strtok(line, WHITESPACE) == NULL)
+			continue;
+		for (count = 0; count < 64; count++) {
+			if ((names[count] = strtok(NULL, WHITESPACE)) == NULL)
+				break;
+		}
+
+		for (i = 0; i < count; i++) {
+			if (strcmp(names[i], hostname) == 0)
+				break;
+		}
+		if (i == count)
+			continue;
+
+		for (i = 0; i < count; i++) {
+			if (strchr(names[i], '.') != NULL) {
+				strlcpy(out, names[i], len);
+				found = 0;
+				break;
+			}
+		}
+	}
+
+	fclose(fp);
+
+	return (found);
+}
+
+/*
+ * Ask the resolver for the canonical name of hostname, store it in the cache
+ * (after the given header) and send it to the parent on fd.  If the lookup
+ * fails, hostname is sent and nothing is stored: the failure may only last as
+ * long as a DNS outage.
+ */
+static void
+resolve_child(const char *hostname, const char *header, int fd)
+{
+	struct addrinfo hints, *res;
+	char buf[MAX_FQDN_LEN * 2];
+	const char *name = hostname;
+	int n;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_flags = AI_CANONNAME;
+
+	if (getaddrinfo(hostname, NULL, &hints, &res) == 0) {
+		if (res->ai_canonname != NULL &&
+		    strchr(res->ai_canonname, '.') != NULL)
+			name = res->ai_canonname;
+
+		n = snprintf(buf, sizeof(buf), "%s%s", header, name);
+		if (n > 0 && (size_t)n < sizeof(buf))
+			cache_write(FQDN_CACHE, buf, n);
+	}
+
+	if (write(fd, name, strlen(name)) == -1)
+		_exit(1);
+	_exit(0);
+}
+
+/*
+ * Resolve hostname in a child process, waiting at most FQDN_TIMEOUT_MS for
+ * the answer.  Returns -1 if the child didn't answer in time.
+ */
+static int
+resolve(const char *hostname, const char *header, char *out, size_t len)
+{
+	struct pollfd pfd;
+	ssize_t n = -1;
+	pid_t pid;
+	int fds[2];
+
+	if (pipe(fds) == -1)
+		return (-1);
+
+	switch ((pid = fork())) {
+	case -1:
+		close(fds[0]);
+		close(fds[1]);
+		return (-1);
+	case 0:
+		close(fds[0]);
+		signal(SIGPIPE, SIG_IGN);
+		detach_stdio();
+		resolve_child(hostname, header, fds[1]);
+		break;
+	default:
+		break;
+	}
+
+	close(fds[1]);
+	pfd.fd = fds[0];
+	pfd.events = POLLIN;
+	if (poll(&pfd, 1, FQDN_TIMEOUT_MS) == 1)
+		n = read(fds[0], out, len - 1);
+	close(fds[0]);
+
+	/* Leave a slow child behind, it will still fill the cache. */
+	if (n <= 0)
+		return (-1);
+
+	out[n] = '\0';
+	waitpid(pid, NULL, 0);
+
+	return (0);
+}
+
+/*
+ * Write the fully qualified name of hostname on out.  If it can't be found
+ * (or not quickly enough), hostname itself is used.
+ */
+void
+fqdn_lookup(const char *hostname, char *out, size_t len)
+{
+	struct stat sb;
+	char header[MAX_FQDN_LEN + 64], buf[MAX_FQDN_LEN * 2];
+	long long hosts_mtime = 0, hostname_mtime = 0;
+	ssize_t n;
+	int hlen;
+
+	if (len == 0)
+		return;
+
+	if (strchr(hostname, '.') != NULL) {
+		strlcpy(out, hostname, len);
+		return;
+	}
+
+	TRACE_FS();
+	if (stat(PATH_HOSTS, &sb) == 0)
+		hosts_mtime = sb.st_mtime;
+	TRACE_FS();
+	if (stat(PATH_HOSTNAME, &sb) == 0)
+		hostname_mtime = sb.st_mtime;
+	hlen = snprintf(header, sizeof(header), "%lld %lld %s\n",
+	    hosts_mtime, hostname_mtime, hostname);
+	if (hlen < 0 || (size_t)hlen >= sizeof(header)) {
+		strlcpy(out, hostname, len);
+		return;
+	}
+
+	n = cache_read(FQDN_CACHE, buf, sizeof(buf) - 1);
+	if (n >= hlen && memcmp(buf, header, hlen) == 0) {
+		buf[n] = '\0';
+		strlcpy(out, buf + hlen, len);
+		return;
+	}
+
+	if (fqdn_from_hosts(PATH_HOSTS, hostname, out, len) == 0) {
+		n = snprintf(buf, sizeof(buf), "%s%s", header, out);
+		if (n > 0 && (size_t)n < sizeof(buf))
+			cache_write(FQDN_CACHE, buf, n);
+		return;
+	}
+
+	if (resolve(hostname, header, out, len) == -1)
+		strlcpy(out, hostname, len);
+}
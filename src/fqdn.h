@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _FQDN_H_
+#define _FQDN_H_
+
+#include <stddef.h>
+
+/* Maximum length of a fully qualified domain name (bytes) */
+#define MAX_FQDN_LEN 256
+
+/* How long to wait for the resolver before giving up (milliseconds) */
+#define FQDN_TIMEOUT_MS 100
+
+#define PATH_HOSTS "/etc/hosts"
+#define PATH_HOSTNAME "/etc/hostname"
+
+int	 fqdn_from_hosts(const char *, const char *, char *, size_t);
+void	 fqdn_lookup(const char *, char *, size_t);
+
+#endif /* ifndef _FQDN_H_ */
@@ -20,53 +20,205 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
-#include <wchar.h>
 #include <err.h>
 #include <locale.h>
 
 #include "prwd.h"
 #include "config.h"
+#include "context.h"
+#include "facts.h"
 #include "alias.h"
+#include "arena.h"
 #include "findr.h"
+#include "output.h"
+#include "shell.h"
+#include "stats.h"
 #include "cmd-path.h"
+#include "strlcpy.h"
 #include "template.h"
-#include "wcslcpy.h"
+#include "trace.h"
 
 extern int cfg_cleancut;
 extern size_t cfg_maxpwdlen;
 extern int cfg_newsgroup;
-extern wchar_t cfg_template[MAX_OUTPUT_LEN];
+extern int cfg_stats;
+extern int cfg_width;
+extern char cfg_template[MAX_OUTPUT_LEN];
+extern char cfg_rtemplate[MAX_OUTPUT_LEN];
+extern char cfg_title[MAX_OUTPUT_LEN];
 
-extern int wopterr;
+extern int popterr;
 
-wchar_t	 home[MAXPATHLEN];
+char	 home[MAXPATHLEN];
 
+/* Room for a prompt laid out to a width, taken from the arena (bytes) */
+#define FIT_OUTPUT_LEN (ARENA_SIZE / 8)
 
+/* The test suite only needs home, the rest only serves main(). */
+#ifndef REGRESS
+/*
+ * Columns the prompt may take (set width), 0 if it is not limited or if the
+ * width of the terminal is unknown.
+ */
+static size_t
+prompt_budget(void)
+{
+	if (cfg_width == 0)
+		return (0);
+
+	return (fact_columns() * cfg_width / 100);
+}
+
+/*
+ * Render the template straight to stdout, the static parts of the template
+ * and the command outputs are written with a single writev(2).  A prompt
+ * with a width budget is laid out in an arena buffer first.
+ */
 static void
-prwd(wchar_t *t)
+prwd(char *t)
 {
-	wchar_t output[MAX_OUTPUT_LEN];
-	const wchar_t *errstr;
+	struct output o;
+	char *buf;
+	const char *errstr;
+	size_t budget;
+	int span;
 
-	template_render(t, output, MAX_OUTPUT_LEN, &errstr);
+	span = trace_begin("compile", 7);
+	if (template_compile(t, &errstr) == -1)
+		errx(1, "template error: %s", errstr);
+	trace_end(span);
+
+	budget = prompt_budget();
+	output_init(&o, STDOUT_FILENO);
+	span = trace_begin("render", 6);
+	if (budget > 0) {
+		if ((buf = arena_alloc(FIT_OUTPUT_LEN)) == NULL)
+			errx(1, "unable to allocate the prompt");
+		if (template_render_fit(t, buf, FIT_OUTPUT_LEN, budget,
+		    &errstr) == -1)
+			errx(1, "template error: %s", errstr);
+		if (output_append(&o, buf, strlen(buf)) == -1)
+			err(1, "write");
+	} else if (template_render_output(t, &o, &errstr) == -1) {
+		errx(1, "template error: %s", errstr);
+	}
+	trace_end(span);
+	span = trace_begin("output", 6);
+	if (output_append(&o, "\n", 1) == -1 || output_flush(&o) == -1)
+		err(1, "write");
+	trace_end(span);
+}
+
+#define ADD_RENDERING(n, t) do {			\
+	r[count].name = (n);				\
+	r[count].tmpl = (t);				\
+	r[count].out = outputs[count];			\
+	r[count].len = MAX_OUTPUT_LEN;			\
+	r[count].budget = 0;				\
+	count++;					\
+} while (0)
+
+/*
+ * Render all the configured templates at once and print them as statements
+ * for the given shell, the output is meant to be passed to eval.
+ */
+static void
+prwd_eval(enum shell_dialect dialect)
+{
+	struct rendering r[3];
+	char outputs[3][MAX_OUTPUT_LEN], line[MAX_OUTPUT_LEN * 2];
+	const char *errstr;
+	size_t i, count = 0, columns;
+	int span;
+
+	ADD_RENDERING("template", cfg_template);
+	if (cfg_rtemplate[0] != '\0')
+		ADD_RENDERING("rtemplate", cfg_rtemplate);
+	if (cfg_title[0] != '\0')
+		ADD_RENDERING("title", cfg_title);
+	r[0].budget = prompt_budget();
+
+	span = trace_begin("compile", 7);
+	for (i = 0; i < count; i++) {
+		if (template_compile(r[i].tmpl, &errstr) == -1)
+			errx(1, "%s error: %s", r[i].name, errstr);
+	}
+	trace_end(span);
+
+	/*
+	 * The right prompt shares the line of the prompt, it is given what the
+	 * prompt left of it (and a space in between) once it is rendered.
+	 */
+	span = trace_begin("render", 6);
+	template_render_many(r, 1, &errstr);
+	if (errstr == NULL && count > 1 && cfg_rtemplate[0] != '\0' &&
+	    r[0].budget > 0) {
+		columns = fact_columns();
+		r[1].budget = columns > r[0].width + 1 ?
+		    columns - r[0].width - 1 : 1;
+	}
+	if (errstr == NULL)
+		template_render_many(r + 1, count - 1, &errstr);
 	if (errstr != NULL)
-		errx(1, "template error: %ls", errstr);
+		errx(1, "template error: %s", errstr);
+	trace_end(span);
 
-	wprintf(L"%ls\n", output);
+	span = trace_begin("output", 6);
+	for (i = 0; i < count; i++) {
+		if (shell_format(dialect, r[i].name, r[i].out, line,
+		    MAX_OUTPUT_LEN * 2) == (size_t)-1)
+			errx(1, "%s output too long", r[i].name);
+		printf("%s\n", line);
+	}
+	fflush(stdout);
+	trace_end(span);
+}
+
+/*
+ * Tell which facts the templates needed, those not listed were never computed.
+ */
+static void
+report_facts(void)
+{
+	const char **names;
+	size_t i, count;
+
+	names = facts_evaluated(&count);
+	fprintf(stderr, "facts evaluated:");
+	if (count == 0)
+		fprintf(stderr, " none");
+	for (i = 0; i < count; i++)
+		fprintf(stderr, " %s", names[i]);
+	fprintf(stderr, "\n");
 }
 
-#ifndef REGRESS
 int
 main(int argc, char **argv)
 {
+	const struct context *ctx;
 	char *t, *findr_target = NULL;
-	int opt, run_dump_alias_vars = 0, run_findr = 0;
+	int opt, run_dump_alias_vars = 0, run_findr = 0, run_eval = 0;
+	int cmdline_template = 0, run_report_facts = 0, run_stats = 0, span;
+	enum shell_dialect dialect = SHELL_RAW;
+	long long start;
+
+	start = trace_now();
 
-	while ((opt = getopt(argc, argv, "afF:t:Vh")) != -1) {
+	/* The only long option, same as -S. */
+	if (argc == 2 && strcmp(argv[1], "--stats") == 0)
+		argv[1] = "-S";
+
+	while ((opt = getopt(argc, argv, "aDefF:s:St:TVh")) != -1) {
 		switch (opt) {
 		case 'a':
 			run_dump_alias_vars = 1;
 			break;
+		case 'D':
+			run_report_facts = 1;
+			break;
+		case 'e':
+			run_eval = 1;
+			break;
 		case 'f':
 			run_findr = 1;
 			break;
@@ -74,27 +226,56 @@ main(int argc, char **argv)
 			run_findr = 1;
 			findr_target = optarg;
 			break;
+		case 's':
+			if (shell_from_name(optarg, &dialect) == -1)
+				errx(1, "unknown shell: %s", optarg);
+			break;
+		case 'S':
+			run_stats = 1;
+			break;
 		case 't':
-			mbstowcs(cfg_template, optarg, MAX_OUTPUT_LEN);
+			strlcpy(cfg_template, optarg, MAX_OUTPUT_LEN);
+			cmdline_template = 1;
+			break;
+		case 'T':
+			/* -T for a table, -TT for JSON. */
+			trace_format = trace_format == TRACE_OFF ?
+			    TRACE_HUMAN : TRACE_JSON;
 			break;
 		case 'V':
 			puts("prwd-"VERSION);
 			exit(-1);
 		default:
-			printf("usage: prwd [-aVh] [-t template]\n");
+			printf("usage: prwd [-aDeSTVh] [-s shell] [-t template]\n");
 			exit(-1);
 		}
 	}
 
 	setlocale(LC_ALL, "");
 
+	/* The templates are compiled for this shell, starting with the config. */
+	shell_init(dialect, run_eval);
+
+	if (run_stats) {
+		if (stats_open() == -1)
+			errx(1, "statistics unavailable");
+		stats_report(stdout);
+		return (0);
+	}
+
 	/* Populate $HOME */
 	t = getenv("HOME");
-	mbstowcs(home, t, MAXPATHLEN);
-	if (home == NULL || *home == L'\0')
+	if (t == NULL || *t == '\0')
 		errx(0, "Unknown variable '$HOME'.");
+	strlcpy(home, t, MAXPATHLEN);
 
+	span = trace_begin("config", 6);
 	read_config();
+	trace_end(span);
+
+	/* Too late for the config span, record it by hand. */
+	if (cfg_stats && stats_open() == 0)
+		stats_record("config", trace_now() - start);
 
 	if (run_findr) {
 		return findr(findr_target);
@@ -105,15 +286,43 @@ main(int argc, char **argv)
 		return (0);
 	}
 
+	/* The templates of the matching context replace the default ones. */
+	span = trace_begin("context", 7);
+	ctx = cmdline_template ? NULL : context_select();
+	trace_end(span);
+	if (ctx != NULL) {
+		if (ctx->template[0] != '\0')
+			strlcpy(cfg_template, ctx->template, MAX_OUTPUT_LEN);
+		if (ctx->rtemplate[0] != '\0')
+			strlcpy(cfg_rtemplate, ctx->rtemplate, MAX_OUTPUT_LEN);
+		if (ctx->title[0] != '\0')
+			strlcpy(cfg_title, ctx->title, MAX_OUTPUT_LEN);
+	}
+
 	/* No template configured, try to get the env var. */
-	if (wcslen(cfg_template) == 0 && (t = getenv("PRWD")) != NULL)
-		mbstowcs(cfg_template, t, MAX_OUTPUT_LEN);
+	if (strlen(cfg_template) == 0 && (t = getenv("PRWD")) != NULL)
+		strlcpy(cfg_template, t, MAX_OUTPUT_LEN);
 
 	/* Still no template, build one using legacy flags. */
-	if (wcslen(cfg_template) == 0)
+	if (strlen(cfg_template) == 0)
 		template_from_config(cfg_template, MAX_OUTPUT_LEN);
 
-	prwd(cfg_template);
+	if (run_eval) {
+		if (strlen(cfg_rtemplate) == 0 &&
+		    (t = getenv("PRWD_RTEMPLATE")) != NULL)
+			strlcpy(cfg_rtemplate, t, MAX_OUTPUT_LEN);
+		if (strlen(cfg_title) == 0 &&
+		    (t = getenv("PRWD_TITLE")) != NULL)
+			strlcpy(cfg_title, t, MAX_OUTPUT_LEN);
+		prwd_eval(dialect);
+	} else {
+		prwd(cfg_template);
+	}
+
+	if (run_report_facts)
+		report_facts();
+	trace_report(stderr);
+	stats_record("total", trace_now() - start);
 
 	return (0);
 }
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "output.h"
+
+/*
+ * Prepare an empty output writing to the given file descriptor.
+ */
+void
+output_init(struct output *o, int fd)
+{
+	o->fd = fd;
+	o->iovcnt = 0;
+	o->used = 0;
+}
+
+/*
+ * Write all the pending segments and make their space available again.
+ * Short writes are resumed where they stopped.  Returns -1 and sets errno on
+ * failure.
+ */
+int
+output_flush(struct output *o)
+{
+	struct iovec *iov = o->iov;
+	int iovcnt = o->iovcnt;
+	ssize_t n;
+
+	while (iovcnt > 0) {
+		n = writev(o->fd, iov, iovcnt);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			return (-1);
+		}
+		while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+			n -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0) {
+			iov->iov_base = (char *)iov->iov_base + n;
+			iov->iov_len -= n;
+		}
+	}
+
+	o->iovcnt = 0;
+	o->used = 0;
+
+	return (0);
+}
+
+/*
+ * Add a segment pointing to 's', nothing is copied so it has to stay valid
+ * until the next flush.  Returns -1 if a flush was needed and failed.
+ */
+int
+output_append(struct output *o, const char *s, size_t len)
+{
+	if (len == 0)
+		return (0);
+
+	if (o->iovcnt == MAX_OUTPUT_SEGMENTS && output_flush(o) == -1)
+		return (-1);
+
+	o->iov[o->iovcnt].iov_base = (void *)(uintptr_t)s;
+	o->iov[o->iovcnt].iov_len = len;
+	o->iovcnt++;
+
+	return (0);
+}
+
+/*
+ * Return a buffer of MAX_OUTPUT_LEN bytes (set on 'len') where a command can
+ * write its output, to be followed by output_commit().  Flushes first if the
+ * scratch buffer or the segment list is full, returns NULL if it failed.
+ */
+char *
+output_reserve(struct output *o, size_t *len)
+{
+	if (o->iovcnt == MAX_OUTPUT_SEGMENTS ||
+	    OUTPUT_SCRATCH_LEN - o->used < MAX_OUTPUT_LEN) {
+		if (output_flush(o) == -1)
+			return (NULL);
+	}
+
+	*len = MAX_OUTPUT_LEN;
+
+	return (o->scratch + o->used);
+}
+
+/*
+ * Add the 'len' bytes written in the last reserved buffer as a segment.
+ */
+void
+output_commit(struct output *o, size_t len)
+{
+	if (len == 0)
+		return;
+
+	o->iov[o->iovcnt].iov_base = o->scratch + o->used;
+	o->iov[o->iovcnt].iov_len = len;
+	o->iovcnt++;
+	o->used += len;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * An output is a list of segments (static spans of a template and command
+ * outputs) written to a file descriptor with a single writev(2).  The command
+ * outputs are stored in a scratch buffer, when it or the segment list is full
+ * everything is flushed and the space is reused, the size of the output is
+ * never limited.
+ */
+
+#ifndef _OUTPUT_H_
+#define _OUTPUT_H_
+
+#include <sys/uio.h>
+
+#include <stddef.h>
+
+#include "prwd.h"
+
+/* Maximum number of segments written at once */
+#define MAX_OUTPUT_SEGMENTS 64
+
+/* Size of the buffer holding the command outputs (bytes) */
+#define OUTPUT_SCRATCH_LEN (4 * MAX_OUTPUT_LEN)
+
+/*
+ * fd: where the segments are written
+ * iov, iovcnt: segments not yet written
+ * scratch, used: storage for the command outputs
+ */
+struct output {
+	int		 fd;
+	struct iovec	 iov[MAX_OUTPUT_SEGMENTS];
+	int		 iovcnt;
+	char		 scratch[OUTPUT_SCRATCH_LEN];
+	size_t		 used;
+};
+
+void	 output_init(struct output *, int);
+int	 output_append(struct output *, const char *, size_t);
+char	*output_reserve(struct output *, size_t *);
+void	 output_commit(struct output *, size_t);
+int	 output_flush(struct output *);
+
+#endif /* ifndef _OUTPUT_H_ */
@@ -48,25 +48,25 @@
  */
 
 /*
- * This code is a rough translation of getopt() from OpenBSD with all the char
- * references upgraded to wchar_t.
+ * This code is a rough translation of getopt() from OpenBSD.  It is kept
+ * private to prwd (pgetopt) so the template commands can reset it between
+ * calls the same way on every libc.
  */
 
-#include <wchar.h>
 #include <err.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include "wgetopt.h"
+#include "pgetopt.h"
 
-int	 wopterr = 1;		/* if error message should be printed */
-int	 woptind = 1;		/* index into parent argv vector */
-int	 woptopt = '?';		/* character checked for validity */
-int	 woptreset;		/* reset getopt */
-wchar_t *woptarg;		/* argument associated with option */
+int	 popterr = 1;		/* if error message should be printed */
+int	 poptind = 1;		/* index into parent argv vector */
+int	 poptopt = '?';		/* character checked for validity */
+int	 poptreset;		/* reset getopt */
+char *poptarg;		/* argument associated with option */
 
-#define PRINT_ERROR	((wopterr) && (*options != ':'))
+#define PRINT_ERROR	((popterr) && (*options != ':'))
 
 #define FLAG_PERMUTE	0x01	/* permute non-options to the end of argv */
 #define FLAG_ALLARGS	0x02	/* treat non-options as args to option "-1" */
@@ -76,15 +76,15 @@ wchar_t *woptarg;		/* argument associated with option */
 #define	BADARG		((*options == ':') ? (int)':' : (int)'?')
 #define	INORDER 	(int)1
 
-#define	EMSG		L""
+#define	EMSG		""
 
-static wchar_t wgetopt_internal(int, wchar_t * const *, const wchar_t *, int);
+static int pgetopt_internal(int, char * const *, const char *, int);
 static int gcd(int, int);
-static void permute_args(int, int, int, wchar_t * const *);
+static void permute_args(int, int, int, char * const *);
 
-static wchar_t *place = EMSG; /* option letter processing */
+static char *place = EMSG; /* option letter processing */
 
-/* XXX: set woptreset to 1 rather than these two */
+/* XXX: set poptreset to 1 rather than these two */
 static int nonopt_start = -1; /* first non option argument (for permute) */
 static int nonopt_end = -1;   /* first option after non options (for permute) */
 
@@ -121,10 +121,10 @@ gcd(int a, int b)
  */
 static void
 permute_args(int panonopt_start, int panonopt_end, int opt_end,
-	wchar_t * const *nargv)
+	char * const *nargv)
 {
 	int cstart, cyclelen, i, j, ncycle, nnonopts, nopts, pos;
-	wchar_t *swap;
+	char *swap;
 
 	/*
 	 * compute lengths of blocks and number and size of cycles
@@ -144,22 +144,22 @@ permute_args(int panonopt_start, int panonopt_end, int opt_end,
 				pos += nopts;
 			swap = nargv[pos];
 			/* LINTED const cast */
-			((wchar_t **)nargv)[pos] = nargv[cstart];
+			((char **)nargv)[pos] = nargv[cstart];
 			/* LINTED const cast */
-			((wchar_t **)nargv)[cstart] = swap;
+			((char **)nargv)[cstart] = swap;
 		}
 	}
 }
 
 /*
- * wgetopt_internal --
+ * pgetopt_internal --
  *	Parse argc/argv argument vector.  Called by user level routines.
  */
-static wchar_t
-wgetopt_internal(int nargc, wchar_t * const *nargv, const wchar_t *options,
+static int
+pgetopt_internal(int nargc, char * const *nargv, const char *options,
     int flags)
 {
-	wchar_t *oli;				/* option letter list index */
+	char *oli;				/* option letter list index */
 	int optchar;
 	static int posixly_correct = -1;
 
@@ -167,58 +167,58 @@ wgetopt_internal(int nargc, wchar_t * const *nargv, const wchar_t *options,
 		return (-1);
 
 	/*
-	 * XXX Some GNU programs (like cvs) set woptind to 0 instead of
-	 * XXX using woptreset.  Work around this braindamage.
+	 * XXX Some GNU programs (like cvs) set poptind to 0 instead of
+	 * XXX using poptreset.  Work around this braindamage.
 	 */
-	if (woptind == 0)
-		woptind = woptreset = 1;
+	if (poptind == 0)
+		poptind = poptreset = 1;
 
 	/*
 	 * Disable GNU extensions if POSIXLY_CORRECT is set or options
 	 * string begins with a '+'.
 	 */
-	if (posixly_correct == -1 || woptreset)
+	if (posixly_correct == -1 || poptreset)
 		posixly_correct = (getenv("POSIXLY_CORRECT") != NULL);
-	if (*options == L'-')
+	if (*options == '-')
 		flags |= FLAG_ALLARGS;
-	else if (posixly_correct || *options == L'+')
+	else if (posixly_correct || *options == '+')
 		flags &= ~FLAG_PERMUTE;
-	if (*options == L'+' || *options == L'-')
+	if (*options == '+' || *options == '-')
 		options++;
 
-	woptarg = NULL;
-	if (woptreset)
+	poptarg = NULL;
+	if (poptreset)
 		nonopt_start = nonopt_end = -1;
 start:
-	if (woptreset || !*place) {		/* update scanning pointer */
-		woptreset = 0;
-		if (woptind >= nargc) {          /* end of argument vector */
+	if (poptreset || !*place) {		/* update scanning pointer */
+		poptreset = 0;
+		if (poptind >= nargc) {          /* end of argument vector */
 			place = EMSG;
 			if (nonopt_end != -1) {
 				/* do permutation, if we have to */
 				permute_args(nonopt_start, nonopt_end,
-				    woptind, nargv);
-				woptind -= nonopt_end - nonopt_start;
+				    poptind, nargv);
+				poptind -= nonopt_end - nonopt_start;
 			}
 			else if (nonopt_start != -1) {
 				/*
-				 * If we skipped non-options, set woptind
+				 * If we skipped non-options, set poptind
 				 * to the first of them.
 				 */
-				woptind = nonopt_start;
+				poptind = nonopt_start;
 			}
 			nonopt_start = nonopt_end = -1;
 			return (-1);
 		}
-		if (*(place = nargv[woptind]) != L'-' ||
-		    (place[1] == L'\0' && wcschr(options, L'-') == NULL)) {
+		if (*(place = nargv[poptind]) != '-' ||
+		    (place[1] == '\0' && strchr(options, '-') == NULL)) {
 			place = EMSG;		/* found non-option */
 			if (flags & FLAG_ALLARGS) {
 				/*
 				 * GNU extension:
 				 * return non-option as argument to option 1
 				 */
-				woptarg = nargv[woptind++];
+				poptarg = nargv[poptind++];
 				return (INORDER);
 			}
 			if (!(flags & FLAG_PERMUTE)) {
@@ -230,26 +230,26 @@ start:
 			}
 			/* do permutation */
 			if (nonopt_start == -1)
-				nonopt_start = woptind;
+				nonopt_start = poptind;
 			else if (nonopt_end != -1) {
 				permute_args(nonopt_start, nonopt_end,
-				    woptind, nargv);
-				nonopt_start = woptind -
+				    poptind, nargv);
+				nonopt_start = poptind -
 				    (nonopt_end - nonopt_start);
 				nonopt_end = -1;
 			}
-			woptind++;
+			poptind++;
 			/* process next argument */
 			goto start;
 		}
 		if (nonopt_start != -1 && nonopt_end == -1)
-			nonopt_end = woptind;
+			nonopt_end = poptind;
 
 		/*
 		 * If we have "-" do nothing, if "--" we are done.
 		 */
-		if (place[1] != L'\0' && *++place == L'-' && place[1] == L'\0') {
-			woptind++;
+		if (place[1] != '\0' && *++place == '-' && place[1] == '\0') {
+			poptind++;
 			place = EMSG;
 			/*
 			 * We found an option (--), so if we skipped
@@ -257,8 +257,8 @@ start:
 			 */
 			if (nonopt_end != -1) {
 				permute_args(nonopt_start, nonopt_end,
-				    woptind, nargv);
-				woptind -= nonopt_end - nonopt_start;
+				    poptind, nargv);
+				poptind -= nonopt_end - nonopt_start;
 			}
 			nonopt_start = nonopt_end = -1;
 			return (-1);
@@ -267,40 +267,40 @@ start:
 
 	if ((optchar = (int)*place++) == (int)':' ||
 	    (optchar == (int)'-' && *place != '\0') ||
-	    (oli = wcschr(options, optchar)) == NULL) {
+	    (oli = strchr(options, optchar)) == NULL) {
 		/*
 		 * If the user specified "-" and  '-' isn't listed in
 		 * options, return -1 (non-option) as per POSIX.
 		 * Otherwise, it is an unknown option character (or ':').
 		 */
-		if (optchar == (int)'-' && *place == L'\0')
+		if (optchar == (int)'-' && *place == '\0')
 			return (-1);
 		if (!*place)
-			++woptind;
+			++poptind;
 		if (PRINT_ERROR)
 			warnx(illoptchar, optchar);
-		woptopt = optchar;
+		poptopt = optchar;
 		return (BADCH);
 	}
-	if (*++oli != L':') {			/* doesn't take argument */
+	if (*++oli != ':') {			/* doesn't take argument */
 		if (!*place)
-			++woptind;
+			++poptind;
 	} else {				/* takes (optional) argument */
-		woptarg = NULL;
+		poptarg = NULL;
 		if (*place)			/* no white space */
-			woptarg = place;
-		else if (oli[1] != L':') {	/* arg not optional */
-			if (++woptind >= nargc) {	/* no arg */
+			poptarg = place;
+		else if (oli[1] != ':') {	/* arg not optional */
+			if (++poptind >= nargc) {	/* no arg */
 				place = EMSG;
 				if (PRINT_ERROR)
 					warnx(recargchar, optchar);
-				woptopt = optchar;
+				poptopt = optchar;
 				return (BADARG);
 			} else
-				woptarg = nargv[woptind];
+				poptarg = nargv[poptind];
 		}
 		place = EMSG;
-		++woptind;
+		++poptind;
 	}
 	/* dump back option letter */
 	return (optchar);
@@ -312,17 +312,17 @@ start:
  *
  * [eventually this will replace the BSD getopt]
  */
-wchar_t
-wgetopt(int nargc, wchar_t * const *nargv, const wchar_t *options)
+int
+pgetopt(int nargc, char * const *nargv, const char *options)
 {
 
 	/*
-	 * We don't pass FLAG_PERMUTE to wgetopt_internal() since
+	 * We don't pass FLAG_PERMUTE to pgetopt_internal() since
 	 * the BSD getopt(3) (unlike GNU) has never done this.
 	 *
 	 * Furthermore, since many privileged programs call getopt()
 	 * before dropping privileges it makes sense to keep things
 	 * as simple (and bug-free) as possible.
 	 */
-	return (wgetopt_internal(nargc, nargv, options, 0));
+	return (pgetopt_internal(nargc, nargv, options, 0));
 }
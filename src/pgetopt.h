@@ -28,8 +28,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifndef _WGETOPT_H_
-#define _WGETOPT_H_
+#ifndef _PGETOPT_H_
+#define _PGETOPT_H_
 
 #include <sys/cdefs.h>
 
@@ -39,7 +39,7 @@
 
 struct option {
 	/* name of long option */
-	const wchar_t *name;
+	const char *name;
 	/*
 	 * one of no_argument, required_argument, and optional_argument:
 	 * whether option takes an argument
@@ -52,20 +52,20 @@ struct option {
 };
 
 __BEGIN_DECLS
-wchar_t	 wgetopt_long(int, wchar_t * const *, const wchar_t *,
+int	 pgetopt_long(int, char * const *, const char *,
 	    const struct option *, int *);
-wchar_t	 wgetopt_long_only(int, wchar_t * const *, const wchar_t *,
+int	 pgetopt_long_only(int, char * const *, const char *,
 	    const struct option *, int *);
-#ifndef _WGETOPT_DEFINED_
-#define _WGETOPT_DEFINED_
-wchar_t	 wgetopt(int, wchar_t * const *, const wchar_t *);
+#ifndef _PGETOPT_DEFINED_
+#define _PGETOPT_DEFINED_
+int	 pgetopt(int, char * const *, const char *);
 
-extern   wchar_t *woptarg;                  /* wgetopt(3) external variables */
-extern   int wopterr;
-extern   int woptind;
-extern   int woptopt;
-extern   int woptreset;
+extern   char *poptarg;                  /* pgetopt(3) external variables */
+extern   int popterr;
+extern   int poptind;
+extern   int poptopt;
+extern   int poptreset;
 #endif
 __END_DECLS
 
-#endif /* !_WGETOPT_H_ */
+#endif /* !_PGETOPT_H_ */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Static tracepoints for dynamic tracers (bpftrace, perf, SystemTap, DTrace),
+ * built with <sys/sdt.h> when configure finds it.  An untraced probe is a
+ * single nop, without <sys/sdt.h> the probes are compiled out.
+ *
+ *	render__start(tmpl)		template_render*() started
+ *	render__end(tmpl, ret)		... and returned ret (0 or -1)
+ *	cmd__start(value, len)		a command (e.g. "path -l 24", not
+ *					NUL-terminated) is executed
+ *	cmd__end(value, len, outlen)	... and wrote outlen bytes
+ *	ancestor(walk, dir)		an ancestor of the working directory is
+ *					looked at by a walk ("vcs", "findr")
+ *	config__start(path)		the configuration file is read
+ *	config__end(path, lines)	... and its lines were processed
+ *
+ * The probes carry no duration, it would cost a clock read on every prompt
+ * even when nothing is attached.  Tracers time the start/end pairs instead:
+ *
+ *	bpftrace -e 'usdt:./prwd:prwd:cmd__start { @s[tid] = nsecs; }
+ *	    usdt:./prwd:prwd:cmd__end /@s[tid]/ {
+ *	    @[str(arg0, arg1)] = hist((nsecs - @s[tid]) / 1000); }'
+ */
+
+#ifndef _PROBES_H_
+#define _PROBES_H_
+
+#ifdef HAS_SYS_SDT
+
+#include <sys/sdt.h>
+
+#define PROBE_RENDER_START(tmpl)					\
+	DTRACE_PROBE1(prwd, render__start, tmpl)
+#define PROBE_RENDER_END(tmpl, ret)					\
+	DTRACE_PROBE2(prwd, render__end, tmpl, ret)
+#define PROBE_CMD_START(value, len)					\
+	DTRACE_PROBE2(prwd, cmd__start, value, len)
+#define PROBE_CMD_END(value, len, outlen)				\
+	DTRACE_PROBE3(prwd, cmd__end, value, len, outlen)
+#define PROBE_ANCESTOR(walk, dir)					\
+	DTRACE_PROBE2(prwd, ancestor, walk, dir)
+#define PROBE_CONFIG_START(path)					\
+	DTRACE_PROBE1(prwd, config__start, path)
+#define PROBE_CONFIG_END(path, lines)					\
+	DTRACE_PROBE2(prwd, config__end, path, lines)
+
+#else
+
+#define PROBE_RENDER_START(tmpl)		do { } while (0)
+#define PROBE_RENDER_END(tmpl, ret)		do { } while (0)
+#define PROBE_CMD_START(value, len)		do { } while (0)
+#define PROBE_CMD_END(value, len, outlen)	do { } while (0)
+#define PROBE_ANCESTOR(walk, dir)		do { } while (0)
+#define PROBE_CONFIG_START(path)		do { } while (0)
+#define PROBE_CONFIG_END(path, lines)		do { } while (0)
+
+#endif /* ifdef HAS_SYS_SDT */
+
+#endif /* ifndef _PROBES_H_ */
@@ -16,7 +16,7 @@
 
 /* Maximum filler length and default filler */
 #define MAX_FILLER_LEN 16
-#define DEFAULT_FILLER L"..."
+#define DEFAULT_FILLER "..."
 
 /* Default value for the maxpwdlen configuration setting */
 #define MAXPWD_LEN 24
@@ -25,8 +25,8 @@
 #define MAX_BRANCH_LEN 32
 
 /* Used to split various things */
-#define WHITESPACE	L" \t\r\n"
-#define QUOTE		L"\""
+#define WHITESPACE	" \t\r\n"
+#define QUOTE		"\""
 
 /* Maximum output size */
 #define MAX_OUTPUT_LEN 1024
@@ -35,4 +35,4 @@
  * DEFAULT_TEMPLATE is the template used by prwd in case none was specified
  * through environment variable, configuration file or command-line.
  */
-#define DEFAULT_TEMPLATE L"${hostname}:${path -l 32}${uid} "
+#define DEFAULT_TEMPLATE "${hostname}:${path -l 32}${uid} "
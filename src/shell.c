@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Everything specific to a given shell lives here.  When multiple templates
+ * are rendered in one invocation (prwd -e), each of them is printed as a
+ * statement in the dialect of the target shell, suitable for eval.  The
+ * escape sequences of a prompt are marked as non-printing for the shells
+ * which would otherwise count them in its width.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "shell.h"
+#include "utf8width.h"
+
+/*
+ * Start and end of the non-printing spans of a prompt, see shell_init().
+ */
+static const char *marker_open = "";
+static const char *marker_close = "";
+
+/* Set the terminal window title, the value is passed as second argument. */
+#define TITLE_PRINTF "printf '\\033]0;%s\\007' "
+
+/*
+ * Statement prefix for each of the templates, per dialect.  The template name
+ * is the keyword used to define it in prwdrc.
+ */
+static const struct {
+	const char	*name;
+	const char	*sh;
+	const char	*zsh;
+	const char	*fish;
+} statements[] = {
+	{ "template", "PRWD_PROMPT=", "PROMPT=", "set -g PRWD_PROMPT " },
+	{ "rtemplate", "PRWD_RPROMPT=", "RPROMPT=", "set -g PRWD_RPROMPT " },
+	{ "title", TITLE_PRINTF, TITLE_PRINTF, TITLE_PRINTF },
+};
+
+#define APPEND(c) do {					\
+	if (cur + 1 >= len)				\
+		return ((size_t)-1);			\
+	out[cur++] = (c);				\
+} while (0)
+
+/*
+ * Find the shell dialect given its name.  Returns -1 if the shell is unknown,
+ * ksh is handled like sh.
+ */
+int
+shell_from_name(const char *name, enum shell_dialect *dialectp)
+{
+	if (strcmp(name, "raw") == 0) {
+		*dialectp = SHELL_RAW;
+	} else if (strcmp(name, "sh") == 0 || strcmp(name, "ksh") == 0) {
+		*dialectp = SHELL_SH;
+	} else if (strcmp(name, "bash") == 0) {
+		*dialectp = SHELL_BASH;
+	} else if (strcmp(name, "zsh") == 0) {
+		*dialectp = SHELL_ZSH;
+	} else if (strcmp(name, "fish") == 0) {
+		*dialectp = SHELL_FISH;
+	} else {
+		return (-1);
+	}
+
+	return (0);
+}
+
+/*
+ * Select the markers of the non-printing spans for the shell displaying the
+ * prompt, before any template is compiled.  bash (readline) takes \001 and
+ * \002 around them, even when they come from an expansion.  zsh takes %{ and
+ * %}, but these would be quoted as any other '%' by shell_format(), with eval
+ * the prompts use \001 and \002 and shell_format() translates them.  The
+ * other shells either measure the prompt themselves (fish) or have nothing
+ * equivalent, the spans are left unmarked.
+ */
+void
+shell_init(enum shell_dialect dialect, int eval)
+{
+	switch (dialect) {
+	case SHELL_BASH:
+		marker_open = "\001";
+		marker_close = "\002";
+		break;
+	case SHELL_ZSH:
+		marker_open = eval ? "\001" : "%{";
+		marker_close = eval ? "\002" : "%}";
+		break;
+	default:
+		marker_open = "";
+		marker_close = "";
+		break;
+	}
+}
+
+/*
+ * Strings to write around a non-printing span, both empty if not needed.
+ */
+void
+shell_markers(const char **openp, const char **closep)
+{
+	*openp = marker_open;
+	*closep = marker_close;
+}
+
+/*
+ * Skip the escape sequence starting at s: CSI (e.g. colors) up to its final
+ * byte, OSC (e.g. title) up to BEL or ST, anything else is two bytes long.
+ */
+static const char *
+skip_escape(const char *s)
+{
+	s++;
+	if (*s == '[') {
+		for (s++; *s != '\0'; s++) {
+			if (*s >= 0x40 && *s <= 0x7e)
+				return (s + 1);
+		}
+	} else if (*s == ']') {
+		for (s++; *s != '\0'; s++) {
+			if (*s == '\007')
+				return (s + 1);
+			if (s[0] == '\033' && s[1] == '\\')
+				return (s + 2);
+		}
+	} else if (*s != '\0') {
+		s++;
+	}
+
+	return (s);
+}
+
+/*
+ * Number of columns the first len bytes of a rendered prompt take once
+ * displayed by the shell: the marked spans, escape sequences and control
+ * characters take none.
+ */
+size_t
+shell_width(const char *s, size_t len)
+{
+	const char *end = s + len, *close;
+	size_t olen, width = 0;
+	uint32_t cp;
+
+	olen = strlen(marker_open);
+	while (s < end && *s != '\0') {
+		if (olen > 0 && strncmp(s, marker_open, olen) == 0) {
+			if ((close = strstr(s + olen, marker_close)) == NULL)
+				break;
+			s = close + strlen(marker_close);
+		} else if (*s == '\033') {
+			s = skip_escape(s);
+		} else if ((unsigned char)*s < 0x20 || *s == 0x7f) {
+			s++;
+		} else {
+			s += utf8_decode(s, &cp);
+			width += utf8_cpwidth(cp);
+		}
+	}
+
+	return (width);
+}
+
+/*
+ * Write a statement assigning value to the shell equivalent of the named
+ * template on out.  Values are single-quoted, zsh prompts also get their '%'
+ * doubled since they go through prompt expansion and their non-printing
+ * markers turned into %{ and %}.  The title has no use for markers.  Returns
+ * the length of the statement or (size_t)-1 if out is too short or the name
+ * is unknown.
+ */
+size_t
+shell_format(enum shell_dialect dialect, const char *name,
+    const char *value, char *out, size_t len)
+{
+	const char *prefix = NULL, *c;
+	size_t i, cur;
+	int is_prompt;
+
+	for (i = 0; i < sizeof(statements) / sizeof(statements[0]); i++) {
+		if (strcmp(statements[i].name, name) != 0)
+			continue;
+		switch (dialect) {
+		case SHELL_ZSH:
+			prefix = statements[i].zsh;
+			break;
+		case SHELL_FISH:
+			prefix = statements[i].fish;
+			break;
+		default:
+			prefix = statements[i].sh;
+			break;
+		}
+		break;
+	}
+	if (prefix == NULL)
+		return ((size_t)-1);
+
+	is_prompt = strcmp(prefix, TITLE_PRINTF) != 0;
+
+	cur = 0;
+	for (c = prefix; *c != '\0'; c++)
+		APPEND(*c);
+
+	APPEND('\'');
+	for (c = value; *c != '\0'; c++) {
+		switch (*c) {
+		case '\'':
+			if (dialect == SHELL_FISH) {
+				APPEND('\\');
+				APPEND('\'');
+			} else {
+				/* Close, add an escaped quote, reopen. */
+				APPEND('\'');
+				APPEND('\\');
+				APPEND('\'');
+				APPEND('\'');
+			}
+			break;
+		case '\\':
+			if (dialect == SHELL_FISH)
+				APPEND('\\');
+			APPEND('\\');
+			break;
+		case '%':
+			if (dialect == SHELL_ZSH && is_prompt)
+				APPEND('%');
+			APPEND('%');
+			break;
+		case '\001':
+		case '\002':
+			if (!is_prompt)
+				break;
+			if (dialect == SHELL_ZSH) {
+				APPEND('%');
+				APPEND(*c == '\001' ? '{' : '}');
+			} else {
+				APPEND(*c);
+			}
+			break;
+		default:
+			APPEND(*c);
+			break;
+		}
+	}
+	APPEND('\'');
+
+	out[cur] = '\0';
+
+	return (cur);
+}
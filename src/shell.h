@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _SHELL_H_
+#define _SHELL_H_
+
+#include <stddef.h>
+
+enum shell_dialect { SHELL_RAW, SHELL_SH, SHELL_BASH, SHELL_ZSH, SHELL_FISH };
+
+int	 shell_from_name(const char *, enum shell_dialect *);
+void	 shell_init(enum shell_dialect, int);
+void	 shell_markers(const char **, const char **);
+size_t	 shell_width(const char *, size_t);
+size_t	 shell_format(enum shell_dialect, const char *, const char *,
+	    char *, size_t);
+
+#endif /* ifndef _SHELL_H_ */
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/param.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cache.h"
+#include "stats.h"
+#include "strlcpy.h"
+#include "trace.h"
+
+/* "prw1", bump when the layout of the segment changes. */
+#define STATS_MAGIC		0x70727731
+
+enum slot_state { SLOT_FREE, SLOT_CLAIMED, SLOT_READY };
+
+/*
+ * state: a slot is claimed by one process which then writes its name
+ * max: longest duration
+ * buckets: number of durations per bucket
+ */
+struct histogram {
+	uint32_t	 state;
+	char		 name[MAX_STATS_NAME_LEN];
+	uint32_t	 max;
+	uint32_t	 buckets[STATS_BUCKETS];
+};
+
+struct segment {
+	uint32_t	 magic;
+	struct histogram histograms[MAX_STATS_HISTOGRAMS];
+};
+
+static struct segment *segment = NULL;
+
+/*
+ * Open (and create if needed) the shared histograms.  A new file is all
+ * zeroes, which is a valid empty segment.  Returns -1 if the cache directory
+ * is not usable or the file was written by another version of prwd.
+ */
+int
+stats_open(void)
+{
+	char path[MAXPATHLEN];
+	struct stat sb;
+	void *p;
+	int fd;
+
+	if (segment != NULL)
+		return (0);
+
+	if (cache_path("stats", path, sizeof(path)) == -1)
+		return (-1);
+
+	TRACE_FS();
+	if ((fd = open(path, O_RDWR | O_CREAT, 0600)) == -1)
+		return (-1);
+
+	if (fstat(fd, &sb) == -1 || (sb.st_size == 0 &&
+	    ftruncate(fd, sizeof(struct segment)) == -1) ||
+	    (sb.st_size != 0 && sb.st_size != sizeof(struct segment))) {
+		close(fd);
+		return (-1);
+	}
+
+	p = mmap(NULL, sizeof(struct segment), PROT_READ | PROT_WRITE,
+	    MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return (-1);
+
+	segment = p;
+	__sync_bool_compare_and_swap(&segment->magic, 0, STATS_MAGIC);
+	if (segment->magic != STATS_MAGIC) {
+		stats_close();
+		return (-1);
+	}
+
+	return (0);
+}
+
+int
+stats_enabled(void)
+{
+	return (segment != NULL);
+}
+
+void
+stats_close(void)
+{
+	if (segment == NULL)
+		return;
+
+	munmap(segment, sizeof(struct segment));
+	segment = NULL;
+}
+
+static size_t
+bucket_index(uint32_t v)
+{
+	int shift = 0;
+
+	while ((v >> shift) >= 2 * STATS_SUB)
+		shift++;
+
+	return ((size_t)shift * STATS_SUB + (v >> shift));
+}
+
+/*
+ * Highest value which falls in the given bucket.
+ */
+static uint32_t
+bucket_value(size_t i)
+{
+	size_t shift;
+
+	if (i < 2 * STATS_SUB)
+		return ((uint32_t)i);
+
+	shift = i / STATS_SUB - 1;
+	return ((uint32_t)((((uint64_t)(i - shift * STATS_SUB) + 1) << shift) -
+	    1));
+}
+
+/*
+ * Find the histogram with the given name, claiming a free slot for it if
+ * needed.  Returns NULL if the name was not found and could not be added.
+ */
+static struct histogram *
+histogram_get(const char *name, int create)
+{
+	struct histogram *h;
+	size_t i;
+	int spins;
+
+	for (i = 0; i < MAX_STATS_HISTOGRAMS; i++) {
+		h = &segment->histograms[i];
+
+		if (h->state == SLOT_FREE) {
+			if (!create)
+				return (NULL);
+			if (__sync_bool_compare_and_swap(&h->state, SLOT_FREE,
+			    SLOT_CLAIMED)) {
+				strlcpy(h->name, name, MAX_STATS_NAME_LEN);
+				__sync_synchronize();
+				h->state = SLOT_READY;
+				return (h);
+			}
+		}
+
+		/* Another process is naming this slot, it could be ours. */
+		for (spins = 0; h->state == SLOT_CLAIMED; spins++) {
+			if (spins == 100)
+				return (NULL);
+			sched_yield();
+		}
+		__sync_synchronize();
+
+		if (strncmp(h->name, name, MAX_STATS_NAME_LEN - 1) == 0)
+			return (h);
+	}
+
+	return (NULL);
+}
+
+/*
+ * Add a duration (microseconds) to the histogram of the given span.
+ */
+void
+stats_record(const char *name, long long us)
+{
+	struct histogram *h;
+	uint32_t v, max;
+
+	if (segment == NULL)
+		return;
+	if ((h = histogram_get(name, 1)) == NULL)
+		return;
+
+	if (us < 0)
+		us = 0;
+	v = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+
+	__sync_fetch_and_add(&h->buckets[bucket_index(v)], 1);
+	while ((max = h->max) < v)
+		__sync_bool_compare_and_swap(&h->max, max, v);
+}
+
+/*
+ * Duration under which the given share of the counts fall (in thousandths),
+ * rounded up to the end of its bucket.
+ */
+static uint32_t
+percentile(const uint32_t *buckets, uint64_t count, unsigned permille)
+{
+	uint64_t rank, seen = 0;
+	size_t i;
+
+	rank = (count * permille + 999) / 1000;
+	if (rank == 0)
+		rank = 1;
+
+	for (i = 0; i < STATS_BUCKETS; i++) {
+		seen += buckets[i];
+		if (seen >= rank)
+			return (bucket_value(i));
+	}
+
+	return (bucket_value(STATS_BUCKETS - 1));
+}
+
+/*
+ * Summarize the histogram of the given span.  The buckets are copied first,
+ * other processes may still be adding to them.  Returns -1 if nothing was
+ * recorded under that name.
+ */
+int
+stats_summary(const char *name, struct stats_summary *s)
+{
+	uint32_t buckets[STATS_BUCKETS];
+	struct histogram *h;
+	uint64_t count = 0;
+	size_t i;
+
+	if (segment == NULL || (h = histogram_get(name, 0)) == NULL)
+		return (-1);
+
+	for (i = 0; i < STATS_BUCKETS; i++) {
+		buckets[i] = h->buckets[i];
+		count += buckets[i];
+	}
+	if (count == 0)
+		return (-1);
+
+	s->count = count;
+	s->p50 = percentile(buckets, count, 500);
+	s->p99 = percentile(buckets, count, 990);
+	s->p999 = percentile(buckets, count, 999);
+	s->max = h->max;
+
+	return (0);
+}
+
+/*
+ * Print the percentiles of all the histograms, in the order they were first
+ * recorded.
+ */
+void
+stats_report(FILE *fp)
+{
+	struct stats_summary s;
+	struct histogram *h;
+	size_t i;
+
+	fprintf(fp, "%-32s %10s %10s %10s %10s %10s\n", "span", "count",
+	    "p50(us)", "p99(us)", "p999(us)", "max(us)");
+	if (segment == NULL)
+		return;
+
+	for (i = 0; i < MAX_STATS_HISTOGRAMS; i++) {
+		h = &segment->histograms[i];
+		if (h->state == SLOT_FREE)
+			break;
+		if (h->state != SLOT_READY)
+			continue;
+		if (stats_summary(h->name, &s) == -1)
+			continue;
+		fprintf(fp, "%-32.32s %10llu %10u %10u %10u %10u\n", h->name,
+		    (unsigned long long)s.count, s.p50, s.p99, s.p999, s.max);
+	}
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Latency histograms shared by all the invocations of prwd of a user, enabled
+ * with "set stats on".  Each trace span (phase or command, see trace.h) and
+ * the whole invocation ("total") has a histogram of its durations in a file
+ * mapped in the cache directory, updated with atomic increments so concurrent
+ * prompts never lock each other out.  prwd --stats prints the percentiles.
+ *
+ * The buckets are log-linear: exact below 16us, then 16 buckets per power of
+ * two, a value is reported as the upper bound of its bucket (6% or better).
+ */
+
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define MAX_STATS_HISTOGRAMS	64
+#define MAX_STATS_NAME_LEN	64
+
+#define STATS_SUB_BITS		4
+#define STATS_SUB		(1 << STATS_SUB_BITS)
+#define STATS_BUCKETS		((32 - STATS_SUB_BITS + 1) * STATS_SUB)
+
+/*
+ * count: number of durations recorded
+ * p50, p99, p999: percentiles (microseconds)
+ * max: longest duration (microseconds)
+ */
+struct stats_summary {
+	uint64_t	 count;
+	uint32_t	 p50;
+	uint32_t	 p99;
+	uint32_t	 p999;
+	uint32_t	 max;
+};
+
+int	 stats_open(void);
+int	 stats_enabled(void);
+void	 stats_record(const char *, long long);
+int	 stats_summary(const char *, struct stats_summary *);
+void	 stats_report(FILE *);
+void	 stats_close(void);
+
+#endif /* ifndef _STATS_H_ */
@@ -24,19 +24,18 @@
  */
 
 #include <string.h>
-#include <wchar.h>
 
 #include "strdelim.h"
 
 /* Characters considered whitespace in strsep calls. */
-#define WHITESPACE	L" \t\r\n"
-#define QUOTE		L"\""
+#define WHITESPACE	" \t\r\n"
+#define QUOTE		"\""
 
 /* return next token in configuration line */
-wchar_t *
-strdelim(wchar_t **s)
+char *
+strdelim(char **s)
 {
-	wchar_t *old;
+	char *old;
 	int wspace = 0;
 
 	if (*s == NULL)
@@ -44,30 +43,30 @@ strdelim(wchar_t **s)
 
 	old = *s;
 
-	*s = wcspbrk(*s, WHITESPACE QUOTE "=");
+	*s = strpbrk(*s, WHITESPACE QUOTE "=");
 	if (*s == NULL)
 		return (old);
 
-	if (*s[0] == L'\"') {
-		wmemmove(*s, *s + 1, wcslen(*s)); /* move nul too */
+	if (*s[0] == '\"') {
+		memmove(*s, *s + 1, strlen(*s)); /* move nul too */
 		/* Find matching quote */
-		if ((*s = wcspbrk(*s, QUOTE)) == NULL) {
+		if ((*s = strpbrk(*s, QUOTE)) == NULL) {
 			return (NULL);		/* no matching quote */
 		} else {
-			*s[0] = L'\0';
+			*s[0] = '\0';
 			return (old);
 		}
 	}
 
 	/* Allow only one '=' to be skipped */
-	if (*s[0] == L'=')
+	if (*s[0] == '=')
 		wspace = 1;
-	*s[0] = L'\0';
+	*s[0] = '\0';
 
 	/* Skip any extra whitespace after first token */
-	*s += wcsspn(*s + 1, WHITESPACE) + 1;
-	if (*s[0] == L'=' && !wspace)
-		*s += wcsspn(*s + 1, WHITESPACE) + 1;
+	*s += strspn(*s + 1, WHITESPACE) + 1;
+	if (*s[0] == '=' && !wspace)
+		*s += strspn(*s + 1, WHITESPACE) + 1;
 
 	return (old);
 }
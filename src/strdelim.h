@@ -14,6 +14,6 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
+#include <stddef.h>
 
-wchar_t		*strdelim(wchar_t **);
+char		*strdelim(char **);
@@ -16,32 +16,31 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
 #include <errno.h>
 #include <limits.h>
 #include <stdlib.h>
 
-#include "wcstonum.h"
+#include "strtonum.h"
 
 #define	INVALID		1
 #define	TOOSMALL	2
 #define	TOOLARGE	3
 
 long long
-wcstonum(const wchar_t *numstr, long long minval, long long maxval,
-    const wchar_t **errstrp)
+strtonum(const char *numstr, long long minval, long long maxval,
+    const char **errstrp)
 {
 	long long ll = 0;
 	int error = 0;
-	wchar_t *ep;
+	char *ep;
 	struct errval {
-		const wchar_t *errstr;
+		const char *errstr;
 		int err;
 	} ev[4] = {
 		{ NULL,		0 },
-		{ L"invalid",	EINVAL },
-		{ L"too small",	ERANGE },
-		{ L"too large",	ERANGE },
+		{ "invalid",	EINVAL },
+		{ "too small",	ERANGE },
+		{ "too large",	ERANGE },
 	};
 
 	ev[0].err = errno;
@@ -49,7 +48,7 @@ wcstonum(const wchar_t *numstr, long long minval, long long maxval,
 	if (minval > maxval) {
 		error = INVALID;
 	} else {
-		ll = wcstoll(numstr, &ep, 10);
+		ll = strtoll(numstr, &ep, 10);
 		if (numstr == ep || *ep != '\0')
 			error = INVALID;
 		else if ((ll == LLONG_MIN && errno == ERANGE) || ll < minval)
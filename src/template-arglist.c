@@ -15,16 +15,15 @@
  */
 
 /*
- * An arglist allows you to store argv-style data in an automatic variable.
- * All the arguments are stored in a single wchar_t array delimited by
- * NUL-bytes.  The addresses of the arguments are stored in the argv pointer.
+ * An arglist allows you to store argv-style data in the arena, which is
+ * released with everything else at the end of the command.  Both the
+ * arguments and the argv array are sized to what is inserted.
  */
 
-#include <wchar.h>
 #include <string.h>
 
+#include "arena.h"
 #include "prwd.h"
-#include "wcslcpy.h"
 #include "template.h"
 
 /*
@@ -34,30 +33,38 @@ void
 template_arglist_init(struct arglist *al)
 {
 	al->argc = 0;
-	al->len = 0;
+	al->cap = 0;
+	al->argv = NULL;
 }
 
 /*
- * Add a single element to an arglist.
+ * Add a single element to an arglist.  Returns the new count of arguments or
+ * (size_t)-1 if the arena is full.
  */
 size_t
-template_arglist_insert(struct arglist *al, wchar_t *arg)
+template_arglist_insert(struct arglist *al, char *arg)
 {
-	size_t l, max;
+	char **argv, *value;
+	size_t l;
 
-	max = MAX_ARGLIST_SIZE - al->len;
-
-	if (al->argc + 1 > MAX_ARG_COUNT)
-		return (size_t)-1;
+	/* Keep room for the trailing NULL, the old array is left behind. */
+	if (al->argc + 1 >= al->cap) {
+		argv = arena_alloc(sizeof(char *) * (al->cap ? al->cap * 2 : 8));
+		if (argv == NULL)
+			return (size_t)-1;
+		if (al->argc > 0)
+			memcpy(argv, al->argv, sizeof(char *) * al->argc);
+		al->argv = argv;
+		al->cap = al->cap ? al->cap * 2 : 8;
+	}
 
-	l = wcslcpy(al->value + al->len, arg, max);
-	if (l > max) {
+	l = strlen(arg);
+	if ((value = arena_alloc(l + 1)) == NULL)
 		return (size_t)-1;
-	}
+	memcpy(value, arg, l + 1);
 
-	al->argv[al->argc] = al->value + al->len;
-	al->len += l + 1;
-	al->argc++;
+	al->argv[al->argc++] = value;
+	al->argv[al->argc] = NULL;
 
 	return (al->argc);
 }
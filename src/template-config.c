@@ -15,11 +15,11 @@
  */
 
 #include <stdio.h>
-#include <wchar.h>
+#include <string.h>
 
 #include "prwd.h"
+#include "strlcpy.h"
 #include "template.h"
-#include "wcslcpy.h"
 
 extern int cfg_hostname;
 extern int cfg_mercurial;
@@ -28,16 +28,17 @@ extern int cfg_cleancut;
 extern int cfg_uid_indicator;
 extern size_t cfg_maxpwdlen;
 extern int cfg_newsgroup;
-extern wchar_t cfg_filler[MAX_FILLER_LEN];
+extern char cfg_filler[MAX_FILLER_LEN];
 
-extern int wopterr;
+extern int popterr;
 
 
 #define CONCAT(v) do {					\
-	vlen = wcslcpy(out, (v), len);			\
+	vlen = strlcpy(out, (v), len);			\
 	if (vlen > len)					\
 		return;					\
 	out += vlen;					\
+	len -= vlen;					\
 } while (0)
 
 
@@ -47,30 +48,30 @@ extern int wopterr;
  * by all legacy users until they transition to the new template format.
  */
 void
-template_from_config(wchar_t *out, size_t len)
+template_from_config(char *out, size_t len)
 {
 	size_t vlen;
-	wchar_t buf[64];
+	char buf[64];
 
 	if (cfg_hostname)
-		CONCAT(L"${hostname}:");
+		CONCAT("${hostname}:");
 
 	if (cfg_mercurial || cfg_git)
-		CONCAT(L"${branch}${sep :}");
+		CONCAT("${branch}${sep :}");
 
 	if (cfg_cleancut) {
-		swprintf(buf, 64, L"${path -c -l %d -f %ls}", cfg_maxpwdlen,
+		snprintf(buf, 64, "${path -c -l %zu -f %s}", cfg_maxpwdlen,
 		    cfg_filler);
 	} else if (cfg_newsgroup) {
-		swprintf(buf, 64, L"${path -n -l %d -f %ls}", cfg_maxpwdlen,
+		snprintf(buf, 64, "${path -n -l %zu -f %s}", cfg_maxpwdlen,
 		    cfg_filler);
 	} else {
-		swprintf(buf, 64, L"${path -l %d -f %ls}", cfg_maxpwdlen,
+		snprintf(buf, 64, "${path -l %zu -f %s}", cfg_maxpwdlen,
 		    cfg_filler);
 	}
 
 	CONCAT(buf);
 
 	if (cfg_uid_indicator)
-		CONCAT(L"${uid}");
+		CONCAT("${uid}");
 }
@@ -14,72 +14,427 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
+#include <sys/param.h>
+
+#include <stdio.h>
 #include <string.h>
 
-#include "cmd-branch.h"
-#include "cmd-color.h"
-#include "cmd-date.h"
-#include "cmd-hostname.h"
-#include "cmd-path.h"
-#include "cmd-sep.h"
-#include "cmd-uid.h"
+#include "arena.h"
+#include "command.h"
+#include "context.h"
+#include "pgetopt.h"
+#include "probes.h"
 #include "prwd.h"
+#include "strlcpy.h"
 #include "template.h"
-#include "wcslcpy.h"
-#include "wgetopt.h"
+#include "trace.h"
+
+#define ERRSTR_EMPTY "empty variable"
+#define ERRSTR_UNKCMD "unknown command"
+#define ERRSTR_TOO_LARGE "variable output too large"
+#define ERRSTR_CMDERR "command error"
+#define ERRSTR_IF_ARGS "if needs a condition and a value"
+
+/* Maximum number of commands parsed ahead of time */
+#define MAX_COMPILED 32
+
+/*
+ * Results of the commands already executed during this invocation, a template
+ * using the same command twice (or a second template using it) gets a copy.
+ */
+static struct memo {
+	char	cmd[MAX_MEMO_KEY_LEN];
+	char	out[MAX_MEMO_LEN];
+} memo[MAX_MEMO_COUNT];
+static int memo_count = 0;
+
+/*
+ * Copy the memoized output of the given command on out.  Returns 0 if the
+ * command was never executed before.
+ */
+static int
+memo_get(const char *value, size_t vlen, char *out, size_t len)
+{
+	int i;
+
+	for (i = 0; i < memo_count; i++) {
+		if (strncmp(memo[i].cmd, value, vlen) == 0 &&
+		    memo[i].cmd[vlen] == '\0') {
+			strlcpy(out, memo[i].out, len);
+			return (1);
+		}
+	}
+
+	return (0);
+}
+
+/*
+ * Remember the output of a command, silently gives up if the table is full or
+ * if the output is too large to be worth keeping.
+ */
+static void
+memo_set(const char *value, size_t vlen, char *out)
+{
+	if (memo_count >= MAX_MEMO_COUNT)
+		return;
+	if (vlen >= MAX_MEMO_KEY_LEN || strlen(out) >= MAX_MEMO_LEN)
+		return;
+
+	memcpy(memo[memo_count].cmd, value, vlen);
+	memo[memo_count].cmd[vlen] = '\0';
+	strlcpy(memo[memo_count].out, out, MAX_MEMO_LEN);
+	memo_count++;
+}
+
+/*
+ * Commands of the templates parsed when the configuration was loaded.  The
+ * arguments are kept here since the options point in them.
+ */
+static struct compiled {
+	char		 key[MAX_MEMO_KEY_LEN];
+	char		 args[MAX_MEMO_KEY_LEN * 2];
+	char		*argv[MAX_MEMO_KEY_LEN / 2 + 1];
+	struct command	 cmd;
+} compiled[MAX_COMPILED];
+static int compiled_count = 0;
+
+/*
+ * Return the parsed form of the given command, or NULL if it was not compiled.
+ */
+static const struct command *
+compiled_get(const char *value, size_t vlen)
+{
+	int i;
+
+	for (i = 0; i < compiled_count; i++) {
+		if (strncmp(compiled[i].key, value, vlen) == 0 &&
+		    compiled[i].key[vlen] == '\0')
+			return (&compiled[i].cmd);
+	}
+
+	return (NULL);
+}
+
+/*
+ * Copy the lexed arguments of a command in a free slot and parse them there.
+ * Returns NULL if the table is full or the command too long to be kept, it
+ * will then be parsed each time it is executed.
+ */
+static const struct command *
+compiled_set(const char *value, size_t vlen, struct arglist *al)
+{
+	struct compiled *c;
+	size_t i, l, off = 0;
+
+	if (compiled_count >= MAX_COMPILED || vlen >= MAX_MEMO_KEY_LEN)
+		return (NULL);
+	if (al->argc >= sizeof(c->argv) / sizeof(c->argv[0]))
+		return (NULL);
+
+	c = &compiled[compiled_count];
+	for (i = 0; i < al->argc; i++) {
+		l = strlen(al->argv[i]) + 1;
+		if (off + l > sizeof(c->args))
+			return (NULL);
+		memcpy(c->args + off, al->argv[i], l);
+		c->argv[i] = c->args + off;
+		off += l;
+	}
+	c->argv[i] = NULL;
+
+	if (command_parse(&c->cmd, al->argc, c->argv) == -1)
+		return (NULL);
+
+	memcpy(c->key, value, vlen);
+	c->key[vlen] = '\0';
+	compiled_count++;
 
-#define ERRSTR_EMPTY L"empty variable"
-#define ERRSTR_UNKCMD L"unknown command"
-#define ERRSTR_TOO_LARGE L"variable output too large"
-#define ERRSTR_CMDERR L"command error"
+	return (&c->cmd);
+}
+
+/*
+ * Forget all the memoized command outputs and the compiled commands, this is
+ * used by the test suite.
+ */
+void
+template_memo_purge_all(void)
+{
+	memo_count = 0;
+	compiled_count = 0;
+}
 
 /*
- * Execute a single command.  The prevempty argument defines whether the
+ * Execute a single command, given as a span of the template (value and
+ * vlen, not NUL-terminated).  The prevempty argument defines whether the
  * previous token ended up being empty or not, this is used for the sep
  * command until we find better semantics.
  *
- *  1. shell tokenize, obtain argc and argv
- *  2. check if we know the command
- *  3. execute the parse_args for this command with the arglist
- *  4. copy the output
+ *  1. use the memoized output if this command already ran
+ *  2. else use its options if it was compiled with the templates
+ *  3. else shell tokenize, obtain argc and argv, and parse the options
+ *  4. run the command and copy the output
  */
-size_t
-template_exec_cmd(wchar_t *value, wchar_t *out, size_t len, int prevempty,
-    const wchar_t **errstrp)
+static size_t
+exec_cmd(const char *value, size_t vlen, char *out, size_t len,
+    int prevempty, const char **errstrp)
 {
+	const struct command *cmd;
+	struct command local;
 	struct arglist al;
 	size_t argc;
+	int span;
 
-	template_arglist_init(&al);
-	argc = template_variable_lexer(value, &al, errstrp);
-	if (argc == (size_t)-1)
-		return ((size_t)-1);
+	*errstrp = NULL;
+	if (memo_get(value, vlen, out, len))
+		return (strlen(out));
+
+	if ((cmd = compiled_get(value, vlen)) == NULL) {
+		template_arglist_init(&al);
+		span = trace_begin("lex", 3);
+		argc = template_variable_lexer(value, vlen, &al, errstrp);
+		trace_end(span);
+		if (argc == (size_t)-1)
+			return ((size_t)-1);
+
+		if (argc == 0) {
+			*errstrp = ERRSTR_EMPTY;
+			return ((size_t)-1);
+		}
+
+		if (command_parse(&local, argc, al.argv) == -1) {
+			*errstrp = ERRSTR_UNKCMD;
+			return ((size_t)-1);
+		}
+		cmd = &local;
+	}
+
+	if (cmd->type == CMD_SEP) {
+		/* Depends on its neighbor, never memoized. */
+		if (prevempty) {
+			out[0] = '\0';
+		} else {
+			command_run(cmd, out, len);
+		}
+		return (strlen(out));
+	}
+
+	command_run(cmd, out, len);
+	memo_set(value, vlen, out);
+
+	return (strlen(out));
+}
+
+/*
+ * Parse a command of a template ahead of its execution, given as a span of
+ * the template.  Returns -1 with *errstrp set if it can not be parsed or if
+ * its options are invalid (e.g. "path -l 999"), the error names the command.
+ */
+int
+template_compile_cmd(const char *value, size_t vlen, const char **errstrp)
+{
+	static char errbuf[MAX_MEMO_KEY_LEN + 64];
+	const struct command *cmd;
+	struct command local;
+	struct arglist al;
+	size_t argc, mark;
+	int r = 0;
+
+	*errstrp = NULL;
+	if ((cmd = compiled_get(value, vlen)) != NULL)
+		goto check;
 
-	if (argc == 0) {
+	mark = arena_mark();
+	template_arglist_init(&al);
+	argc = template_variable_lexer(value, vlen, &al, errstrp);
+	if (argc == 0)
 		*errstrp = ERRSTR_EMPTY;
-		return ((size_t)-1);
+	if (*errstrp == NULL && (cmd = compiled_set(value, vlen, &al)) == NULL) {
+		if (command_parse(&local, argc, al.argv) == -1)
+			*errstrp = ERRSTR_UNKCMD;
+		else
+			cmd = &local;
+	}
+	arena_release(mark);
+	if (*errstrp != NULL)
+		return (-1);
+
+check:
+	if (cmd->error != NULL) {
+		snprintf(errbuf, sizeof(errbuf), "%s in ${%.*s}", cmd->error,
+		    (int)MIN(vlen, MAX_MEMO_KEY_LEN), value);
+		*errstrp = errbuf;
+		r = -1;
+	}
+
+	return (r);
+}
+
+/*
+ * When tracing or recording statistics, each distinct command gets its own
+ * span named after it (e.g. "${path -l 24}").
+ */
+static int
+trace_begin_cmd(const char *value, size_t vlen)
+{
+	char name[MAX_TRACE_NAME_LEN];
+	int n;
+
+	if (!trace_enabled())
+		return (-1);
+
+	n = snprintf(name, sizeof(name), "${%.*s}", (int)vlen, value);
+
+	return (trace_begin(name, MIN((size_t)n, sizeof(name) - 1)));
+}
+
+/*
+ * Execute a single command, see exec_cmd().
+ */
+size_t
+template_exec_cmd(const char *value, size_t vlen, char *out, size_t len,
+    int prevempty, const char **errstrp)
+{
+	size_t mark, r;
+	int span;
+
+	span = trace_begin_cmd(value, vlen);
+	PROBE_CMD_START(value, vlen);
+	mark = arena_mark();
+	r = exec_cmd(value, vlen, out, len, prevempty, errstrp);
+	arena_release(mark);
+	PROBE_CMD_END(value, vlen, r);
+	trace_end(span);
+
+	return (r);
+}
+
+/*
+ * Return the path command in value if its output can be cut to a length, the
+ * -n and -u paths can't.  An uncompiled command is parsed into local, within
+ * the arena.  Returns NULL if it is not such a path command.
+ */
+static const struct command *
+path_command(const char *value, size_t vlen, struct command *local)
+{
+	const struct command *cmd;
+	struct arglist al;
+	const char *errstr;
+	size_t argc;
+
+	if ((cmd = compiled_get(value, vlen)) == NULL) {
+		template_arglist_init(&al);
+		argc = template_variable_lexer(value, vlen, &al, &errstr);
+		if (argc != (size_t)-1 && argc > 0 &&
+		    command_parse(local, argc, al.argv) == 0)
+			cmd = local;
 	}
+	if (cmd == NULL || cmd->type != CMD_PATH || cmd->error != NULL ||
+	    cmd->opts.path.newsgroupize || cmd->opts.path.uniqueize)
+		return (NULL);
+
+	return (cmd);
+}
 
-	if (wcscmp(al.argv[0], L"path") == 0) {
-		cmd_path_exec(argc, al.argv, out, len);
-	} else if (wcscmp(al.argv[0], L"branch") == 0) {
-		cmd_branch_exec(argc, al.argv, out, len);
-	} else if (wcscmp(al.argv[0], L"color") == 0) {
-		cmd_color_exec(argc, al.argv, out, len);
-	} else if (wcscmp(al.argv[0], L"date") == 0) {
-		cmd_date_exec(argc, al.argv, out, len);
-	} else if (wcscmp(al.argv[0], L"hostname") == 0) {
-		cmd_hostname_exec(argc, al.argv, out, len);
-	} else if (wcscmp(al.argv[0], L"uid") == 0) {
-		cmd_uid_exec(argc, al.argv, out, len);
-	} else if (wcscmp(al.argv[0], L"sep") == 0) {
-		if (!prevempty)
-			cmd_sep_exec(argc, al.argv, out, len);
-	} else {
-		*errstrp = ERRSTR_UNKCMD;
+/*
+ * Return whether the layout can cut the output of the command in value, see
+ * template_exec_fit().
+ */
+int
+template_exec_cuttable(const char *value, size_t vlen)
+{
+	struct command local;
+	size_t mark;
+	int r;
+
+	mark = arena_mark();
+	r = path_command(value, vlen, &local) != NULL;
+	arena_release(mark);
+
+	return (r);
+}
+
+/*
+ * Execute a path command again, cut to maxlen columns instead of its own -l.
+ * The layout uses it to shrink the path of a prompt which does not fit.
+ * Returns the length of the output or (size_t)-1 if it is not a path command
+ * which can be cut.
+ */
+size_t
+template_exec_fit(const char *value, size_t vlen, size_t maxlen, char *out,
+    size_t len)
+{
+	const struct command *cmd;
+	struct command local;
+	struct path_opts o;
+	size_t mark;
+
+	mark = arena_mark();
+	if ((cmd = path_command(value, vlen, &local)) == NULL) {
+		arena_release(mark);
 		return ((size_t)-1);
 	}
 
-	return (wcslen(out));
+	o = cmd->opts.path;
+	o.maxlen = maxlen;
+	cmd_path_run(&o, out, len);
+	arena_release(mark);
+
+	return (strlen(out));
+}
+
+/*
+ * Check the condition of an "if" command ahead of its evaluation, returns -1
+ * with *errstrp set if it could never be evaluated.
+ */
+int
+template_compile_if(const char *value, size_t vlen, const char **errstrp)
+{
+	struct condition cond;
+	struct arglist al;
+	size_t argc, mark;
+
+	*errstrp = NULL;
+	mark = arena_mark();
+	template_arglist_init(&al);
+	argc = template_variable_lexer(value, vlen, &al, errstrp);
+	if (argc != (size_t)-1 && argc != 3)
+		*errstrp = ERRSTR_IF_ARGS;
+	if (*errstrp == NULL)
+		condition_parse(&cond, al.argv[1], al.argv[2], errstrp);
+	arena_release(mark);
+
+	return (*errstrp != NULL ? -1 : 0);
+}
+
+/*
+ * Evaluate the condition of an "if" command (e.g. "if vcs git"), given as a
+ * span of the template.  The facts it depends on are only computed here, when
+ * the enclosing branch is taken.  Returns 1 or 0, -1 on error with *errstrp
+ * set.
+ */
+int
+template_exec_if(const char *value, size_t vlen, const char **errstrp)
+{
+	struct condition cond;
+	struct arglist al;
+	size_t argc, mark;
+	int span, r;
+
+	*errstrp = NULL;
+	mark = arena_mark();
+	template_arglist_init(&al);
+	argc = template_variable_lexer(value, vlen, &al, errstrp);
+	if (argc != (size_t)-1 && argc != 3)
+		*errstrp = ERRSTR_IF_ARGS;
+	if (*errstrp == NULL)
+		condition_parse(&cond, al.argv[1], al.argv[2], errstrp);
+	arena_release(mark);
+	if (*errstrp != NULL)
+		return (-1);
+
+	span = trace_begin_cmd(value, vlen);
+	r = condition_eval(&cond);
+	trace_end(span);
+
+	return (r);
 }
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Fit a rendered prompt in a number of columns (see "set width" in prwdrc).
+ * While a template is rendered, its output is recorded as spans: each static
+ * part and each command output, with its width and the segment it belongs to.
+ * If the prompt is too wide, the segments of lowest priority are dropped
+ * until the paths can absorb the rest, then the paths are cut to fit.  No
+ * other command is executed again.
+ */
+
+#include <sys/param.h>
+
+#include <string.h>
+
+#include "arena.h"
+#include "shell.h"
+#include "strtonum.h"
+#include "template.h"
+
+#define ERRSTR_PRIORITY "segment needs a priority (0-99)"
+
+/* Narrowest a path is cut to (columns) */
+#define MIN_PATH_WIDTH 10
+
+/*
+ * Return the priority of a "segment" command or -1 with *errstrp set.
+ */
+int
+template_layout_priority(const char *value, size_t vlen,
+    const char **errstrp)
+{
+	char buf[8];
+	const char *errstr;
+	size_t i = sizeof("segment") - 1;
+	int priority;
+
+	while (i < vlen && (value[i] == ' ' || value[i] == '\t'))
+		i++;
+	while (vlen > i && (value[vlen - 1] == ' ' || value[vlen - 1] == '\t'))
+		vlen--;
+
+	if (vlen == i || vlen - i >= sizeof(buf)) {
+		*errstrp = ERRSTR_PRIORITY;
+		return (-1);
+	}
+	memcpy(buf, value + i, vlen - i);
+	buf[vlen - i] = '\0';
+
+	priority = strtonum(buf, 0, 99, &errstr);
+	if (errstr != NULL) {
+		*errstrp = ERRSTR_PRIORITY;
+		return (-1);
+	}
+
+	return (priority);
+}
+
+/*
+ * Prepare lay for a template with the given number of paths and segment
+ * commands (cuts) and of segments, its spans and segments are taken from the
+ * arena.  Returns -1 if there is no room for them.
+ */
+int
+template_layout_init(struct layout *lay, size_t budget, size_t cuts,
+    int segments)
+{
+	memset(lay, 0, sizeof(*lay));
+	lay->budget = budget;
+	lay->current = -1;
+
+	/* See template_layout_add() for the count of spans. */
+	lay->span_cap = 2 * cuts + 1;
+	lay->segment_cap = segments;
+	lay->spans = arena_alloc(lay->span_cap * sizeof(*lay->spans));
+	if (lay->spans == NULL)
+		return (-1);
+	if (segments > 0) {
+		lay->priority = arena_alloc(segments * sizeof(*lay->priority));
+		lay->dropped = arena_alloc(segments * sizeof(*lay->dropped));
+		if (lay->priority == NULL || lay->dropped == NULL)
+			return (-1);
+		memset(lay->dropped, 0, segments * sizeof(*lay->dropped));
+	}
+
+	return (0);
+}
+
+/*
+ * Follow the "segment" and "endsegment" commands, the spans added in between
+ * belong to that segment.  The template was checked when it was compiled,
+ * an invalid segment is simply not one.
+ */
+void
+template_layout_segment(struct layout *lay, const char *value, size_t vlen)
+{
+	const char *errstr;
+	int priority;
+
+	lay->current = -1;
+	if (strncmp(value, "end", 3) == 0)
+		return;
+
+	if ((priority = template_layout_priority(value, vlen, &errstr)) == -1)
+		return;
+
+	if (lay->segment_count >= lay->segment_cap) {
+		lay->overflow = 1;
+		return;
+	}
+
+	lay->priority[lay->segment_count] = priority;
+	lay->current = lay->segment_count++;
+}
+
+/*
+ * Record len bytes of output written at off.  Path commands which can be cut
+ * (cmd) are kept to be cut if needed, any other output joins the span before
+ * it if they are of the same segment: a template is laid out in at most
+ * 2 * (paths + segment commands) + 1 spans.
+ */
+void
+template_layout_add(struct layout *lay, const char *out, size_t off,
+    size_t len, const char *cmd, size_t clen)
+{
+	struct span *sp;
+
+	if (lay == NULL || len == 0)
+		return;
+
+	if (cmd == NULL && lay->span_count > 0) {
+		sp = &lay->spans[lay->span_count - 1];
+		if (sp->cmd == NULL && sp->segment == lay->current &&
+		    sp->off + sp->len == off) {
+			sp->len += len;
+			sp->width += shell_width(out + off, len);
+			return;
+		}
+	}
+
+	if (lay->span_count >= lay->span_cap) {
+		lay->overflow = 1;
+		return;
+	}
+
+	sp = &lay->spans[lay->span_count++];
+	sp->off = off;
+	sp->len = len;
+	sp->width = shell_width(out + off, len);
+	sp->segment = lay->current;
+	sp->cmd = cmd;
+	sp->clen = clen;
+}
+
+/*
+ * Columns a path can give up.
+ */
+static size_t
+path_room(const struct span *sp)
+{
+	if (sp->cmd == NULL || sp->width <= MIN_PATH_WIDTH)
+		return (0);
+
+	return (sp->width - MIN_PATH_WIDTH);
+}
+
+/*
+ * Return the segment to drop first: lowest priority, the last one if several
+ * share it.  Returns -1 if there is none left.
+ */
+static int
+lowest_segment(const struct layout *lay)
+{
+	int i, lowest = -1;
+
+	for (i = 0; i < lay->segment_count; i++) {
+		if (lay->dropped[i])
+			continue;
+		if (lowest == -1 || lay->priority[i] <= lay->priority[lowest])
+			lowest = i;
+	}
+
+	return (lowest);
+}
+
+/*
+ * Make the output recorded in lay fit its budget, out holds the rendered
+ * template and is rewritten in place.  More spans or segments than counted
+ * leave it as it is, which can't happen with the counts of
+ * template_render_fit().
+ */
+void
+template_layout_apply(struct layout *lay, char *out, size_t len)
+{
+	struct span *sp;
+	size_t i, n, total = 0, room = 0, overflow, cut, cur = 0, mark;
+	char *buf;
+	int s;
+
+	if (lay->overflow)
+		return;
+
+	for (i = 0; i < lay->span_count; i++) {
+		total += lay->spans[i].width;
+		room += path_room(&lay->spans[i]);
+	}
+	if (total <= lay->budget)
+		return;
+
+	/* Only drop what the paths can't make up for. */
+	while (total - room > lay->budget && (s = lowest_segment(lay)) != -1) {
+		lay->dropped[s] = 1;
+		for (i = 0; i < lay->span_count; i++) {
+			if (lay->spans[i].segment != s)
+				continue;
+			total -= lay->spans[i].width;
+			room -= path_room(&lay->spans[i]);
+		}
+	}
+	overflow = total > lay->budget ? total - lay->budget : 0;
+
+	mark = arena_mark();
+	if ((buf = arena_alloc(len)) == NULL) {
+		arena_release(mark);
+		return;
+	}
+
+	for (i = 0; i < lay->span_count; i++) {
+		sp = &lay->spans[i];
+		if (sp->segment != -1 && lay->dropped[sp->segment])
+			continue;
+		if (overflow > 0 && (cut = MIN(overflow, path_room(sp))) > 0) {
+			n = template_exec_fit(sp->cmd, sp->clen, sp->width - cut,
+			    buf + cur, len - cur);
+			if (n != (size_t)-1 && n < len - cur) {
+				overflow -= cut;
+				cur += n;
+				continue;
+			}
+		}
+		if (sp->len >= len - cur)
+			break;
+		memcpy(buf + cur, out + sp->off, sp->len);
+		cur += sp->len;
+	}
+	buf[cur] = '\0';
+
+	memcpy(out, buf, cur + 1);
+	arena_release(mark);
+}
@@ -14,61 +14,429 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
 #include <string.h>
 
-#include "prwd.h"
-#include "wcslcpy.h"
+#include "arena.h"
+#include "output.h"
+#include "probes.h"
+#include "shell.h"
 #include "template.h"
 
-#define ERRSTR_OUTPUT_SIZE L"output buffer too short for rendered template"
+#define ERRSTR_OUTPUT_SIZE "output buffer too short for rendered template"
+#define ERRSTR_CMD_SIZE "command output too large"
+#define ERRSTR_WRITE "unable to write output"
+#define ERRSTR_NO_IF "else or endif without if"
+#define ERRSTR_NO_ENDIF "if without endif"
+#define ERRSTR_NESTED_SEGMENT "segment inside a segment"
+#define ERRSTR_NO_SEGMENT "endsegment without segment"
+#define ERRSTR_NO_ENDSEGMENT "segment without endsegment"
+#define ERRSTR_LAYOUT "template too large to lay out"
 
 /*
- * Execute the provided template 'tmpl' and save the output to 'output'.  In
- * case of error, return -1 and set errstrp to an error message.
+ * depth: number of if commands we are in
+ * skip: depth of the branch not taken we are in, 0 if none
  */
-int
-template_render(wchar_t *tmpl, wchar_t *out, size_t len,
-    const wchar_t **errstrp)
+struct flow {
+	int	depth;
+	int	skip;
+};
+
+/*
+ * Return whether the span starts with the given word.
+ */
+static int
+is_word(const char *value, size_t vlen, const char *word)
+{
+	size_t wlen = strlen(word);
+
+	if (vlen < wlen || strncmp(value, word, wlen) != 0)
+		return (0);
+
+	return (vlen == wlen || value[wlen] == ' ' || value[wlen] == '\t');
+}
+
+/*
+ * Return whether the command is one of segment or endsegment, they only
+ * matter to the layout.
+ */
+static int
+is_segment(const char *value, size_t vlen)
 {
-	struct token tokens[MAX_TOKEN_COUNT];
-	wchar_t buf[MAX_OUTPUT_LEN], *c;
-	int i, count, prevempty;
-	size_t cur, tlen;
+	return (is_word(value, vlen, "segment") ||
+	    is_word(value, vlen, "endsegment"));
+}
 
-	count = template_tokenize(tmpl, tokens, MAX_TOKEN_COUNT, errstrp);
-	if (count == -1) {
+/*
+ * Follow the if, else and endif commands.  Returns 1 if the command was one of
+ * them, 0 if it is a regular command and -1 on error.  The condition of an if
+ * is not evaluated if we are already skipping.
+ */
+static int
+flow_update(struct flow *f, const char *value, size_t vlen,
+    const char **errstrp)
+{
+	int taken;
+
+	if (is_word(value, vlen, "if")) {
+		f->depth++;
+		if (f->skip != 0)
+			return (1);
+		if ((taken = template_exec_if(value, vlen, errstrp)) == -1)
+			return (-1);
+		if (!taken)
+			f->skip = f->depth;
+		return (1);
+	}
+
+	if (!is_word(value, vlen, "else") && !is_word(value, vlen, "endif"))
+		return (0);
+
+	if (f->depth == 0) {
+		*errstrp = ERRSTR_NO_IF;
 		return (-1);
 	}
 
-	cur = 0;
+	if (is_word(value, vlen, "else")) {
+		if (f->skip == f->depth)
+			f->skip = 0;
+		else if (f->skip == 0)
+			f->skip = f->depth;
+	} else {
+		if (f->skip == f->depth)
+			f->skip = 0;
+		f->depth--;
+	}
+
+	return (1);
+}
+
+/*
+ * Execute the provided template 'tmpl' and save the output to 'output'.  The
+ * static spans are copied straight from the template and the commands write
+ * directly at the end of the output, nothing is buffered in between.  A
+ * command filling all the remaining space is assumed to be truncated.  The
+ * tokens within a branch not taken are neither copied nor executed.  If lay
+ * is given, the output is recorded there and fit to its budget at the end.
+ * In case of error, return -1 and set errstrp to an error message.
+ */
+static int
+render_buffer(const char *tmpl, char *out, size_t len, struct layout *lay,
+    const char **errstrp)
+{
+	const char *value;
+	struct token tok;
+	struct flow flow;
+	size_t pos, cur, tlen;
+	int i, prevempty;
+
+	*errstrp = NULL;
+	if (len == 0) {
+		*errstrp = ERRSTR_OUTPUT_SIZE;
+		return (-1);
+	}
+
+	pos = cur = 0;
 	prevempty = 0;
-	for (i = 0; i < count; i++) {
-		if (tokens[i].type == TOKEN_STATIC) {
-			c = tokens[i].value;
-			prevempty = 0;
-		} else {
-			tlen = template_exec_cmd(tokens[i].value, buf,
-			    MAX_OUTPUT_LEN, prevempty, errstrp);
-			if (*errstrp != NULL)
+	memset(&flow, 0, sizeof(flow));
+	while (template_tokenize(tmpl, &pos, &tok)) {
+		value = tmpl + tok.off;
+		if (tok.type == TOKEN_COMMAND) {
+			i = flow_update(&flow, value, tok.len, errstrp);
+			if (i == -1)
+				return (-1);
+			if (i == 1)
+				continue;
+		}
+		if (flow.skip != 0)
+			continue;
+
+		if (tok.type == TOKEN_STATIC) {
+			if (tok.len >= len - cur) {
+				*errstrp = ERRSTR_OUTPUT_SIZE;
 				return (-1);
-			if (tlen == 0) {
-				prevempty = 1;
-			} else {
-				prevempty = 0;
 			}
-			c = buf;
+			memcpy(out + cur, value, tok.len);
+			out[cur + tok.len] = '\0';
+			template_layout_add(lay, out, cur, tok.len, NULL, 0);
+			cur += tok.len;
+			prevempty = 0;
+			continue;
+		}
+
+		if (is_segment(value, tok.len)) {
+			if (lay != NULL)
+				template_layout_segment(lay, value, tok.len);
+			continue;
 		}
 
-		tlen = wcslcpy(out + cur, c, len - cur);
-		if (tlen > len - cur) {
+		tlen = template_exec_cmd(value, tok.len, out + cur, len - cur,
+		    prevempty, errstrp);
+		if (*errstrp != NULL)
+			return (-1);
+		if (tlen > 0 && tlen >= len - cur - 1) {
 			*errstrp = ERRSTR_OUTPUT_SIZE;
 			return (-1);
 		}
+		template_layout_add(lay, out, cur, tlen,
+		    lay != NULL && is_word(value, tok.len, "path") &&
+		    template_exec_cuttable(value, tok.len) ? value : NULL,
+		    tok.len);
+		prevempty = (tlen == 0);
 		cur += tlen;
 	}
 
-	out[cur] = L'\0';
+	if (flow.depth != 0) {
+		*errstrp = ERRSTR_NO_ENDIF;
+		return (-1);
+	}
+
+	out[cur] = '\0';
+	if (lay != NULL)
+		template_layout_apply(lay, out, len);
+
+	return (0);
+}
+
+/*
+ * Execute the provided template 'tmpl' and add the result to the output 'o'
+ * as segments: the static spans are referenced in place and the commands
+ * write into the output scratch buffer.  Nothing limits the size of the
+ * result, segments are written out as the output fills up.  Branches are
+ * handled as in render_buffer(), segments are ignored.  In case of error,
+ * return -1 and set errstrp to an error message.
+ */
+static int
+render_output(const char *tmpl, struct output *o, const char **errstrp)
+{
+	struct token tok;
+	struct flow flow;
+	char *buf;
+	size_t pos, blen, tlen;
+	int i, prevempty;
+
+	*errstrp = NULL;
+	pos = 0;
+	prevempty = 0;
+	memset(&flow, 0, sizeof(flow));
+	while (template_tokenize(tmpl, &pos, &tok)) {
+		if (tok.type == TOKEN_COMMAND) {
+			i = flow_update(&flow, tmpl + tok.off, tok.len,
+			    errstrp);
+			if (i == -1)
+				return (-1);
+			if (i == 1)
+				continue;
+		}
+		if (flow.skip != 0)
+			continue;
+
+		if (tok.type == TOKEN_COMMAND &&
+		    is_segment(tmpl + tok.off, tok.len))
+			continue;
+
+		if (tok.type == TOKEN_STATIC) {
+			if (output_append(o, tmpl + tok.off, tok.len) == -1) {
+				*errstrp = ERRSTR_WRITE;
+				return (-1);
+			}
+			prevempty = 0;
+			continue;
+		}
+
+		if ((buf = output_reserve(o, &blen)) == NULL) {
+			*errstrp = ERRSTR_WRITE;
+			return (-1);
+		}
+		tlen = template_exec_cmd(tmpl + tok.off, tok.len, buf, blen,
+		    prevempty, errstrp);
+		if (*errstrp != NULL)
+			return (-1);
+		if (tlen > 0 && tlen >= blen - 1) {
+			*errstrp = ERRSTR_CMD_SIZE;
+			return (-1);
+		}
+		output_commit(o, tlen);
+		prevempty = (tlen == 0);
+	}
+
+	if (flow.depth != 0) {
+		*errstrp = ERRSTR_NO_ENDIF;
+		return (-1);
+	}
+
+	return (0);
+}
+
+int
+template_render(const char *tmpl, char *out, size_t len,
+    const char **errstrp)
+{
+	size_t mark;
+	int r;
+
+	PROBE_RENDER_START(tmpl);
+	mark = arena_mark();
+	r = render_buffer(tmpl, out, len, NULL, errstrp);
+	arena_release(mark);
+	PROBE_RENDER_END(tmpl, r);
+
+	return (r);
+}
+
+/*
+ * Count what the layout of a template needs room for: its paths and segment
+ * commands (cuts) and its segments, in all the branches.
+ */
+static void
+layout_count(const char *tmpl, size_t *cuts, int *segments)
+{
+	struct token tok;
+	const char *value;
+	size_t pos = 0;
+
+	*cuts = 0;
+	*segments = 0;
+	while (template_tokenize(tmpl, &pos, &tok)) {
+		if (tok.type != TOKEN_COMMAND)
+			continue;
+		value = tmpl + tok.off;
+		if (is_segment(value, tok.len) || is_word(value, tok.len, "path"))
+			(*cuts)++;
+		if (is_word(value, tok.len, "segment"))
+			(*segments)++;
+	}
+}
+
+/*
+ * Render the template as template_render() does, fit in budget columns by
+ * dropping segments and cutting paths (0 for no limit).
+ */
+int
+template_render_fit(const char *tmpl, char *out, size_t len, size_t budget,
+    const char **errstrp)
+{
+	struct layout lay;
+	size_t mark, cuts;
+	int r, segments;
+
+	if (budget == 0)
+		return (template_render(tmpl, out, len, errstrp));
+
+	PROBE_RENDER_START(tmpl);
+	mark = arena_mark();
+	layout_count(tmpl, &cuts, &segments);
+	if (template_layout_init(&lay, budget, cuts, segments) == -1) {
+		*errstrp = ERRSTR_LAYOUT;
+		r = -1;
+	} else {
+		r = render_buffer(tmpl, out, len, &lay, errstrp);
+	}
+	arena_release(mark);
+	PROBE_RENDER_END(tmpl, r);
+
+	return (r);
+}
+
+int
+template_render_output(const char *tmpl, struct output *o,
+    const char **errstrp)
+{
+	size_t mark;
+	int r;
+
+	PROBE_RENDER_START(tmpl);
+	mark = arena_mark();
+	r = render_output(tmpl, o, errstrp);
+	arena_release(mark);
+	PROBE_RENDER_END(tmpl, r);
+
+	return (r);
+}
+
+/*
+ * Render a set of named templates in one pass (e.g. prompt, right prompt and
+ * terminal title).  All of them share the same facts and memoized command
+ * outputs, the commands they have in common are only executed once.  Each
+ * output is fit to its budget and its display width measured on the way.  In
+ * case of error, return -1 and set errstrp to an error message.
+ */
+int
+template_render_many(struct rendering *r, size_t count,
+    const char **errstrp)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (template_render_fit(r[i].tmpl, r[i].out, r[i].len,
+		    r[i].budget, errstrp) == -1)
+			return (-1);
+		r[i].width = shell_width(r[i].out, strlen(r[i].out));
+	}
+
+	return (0);
+}
+
+/*
+ * Parse all the commands of a template once, before it is rendered for the
+ * first time, they are then only executed.  This is where invalid options
+ * (e.g. "${path -l 999}"), unknown commands and unbalanced if/endif or
+ * segment/endsegment are found, whether or not a render would reach them.
+ * In case of error, return -1 and set errstrp to an error message.
+ */
+int
+template_compile(const char *tmpl, const char **errstrp)
+{
+	struct token tok;
+	const char *value;
+	size_t pos = 0;
+	int depth = 0, insegment = 0;
+
+	*errstrp = NULL;
+	while (template_tokenize(tmpl, &pos, &tok)) {
+		if (tok.type != TOKEN_COMMAND)
+			continue;
+
+		value = tmpl + tok.off;
+		if (is_word(value, tok.len, "if")) {
+			if (template_compile_if(value, tok.len, errstrp) == -1)
+				return (-1);
+			depth++;
+		} else if (is_word(value, tok.len, "else") ||
+		    is_word(value, tok.len, "endif")) {
+			if (depth == 0) {
+				*errstrp = ERRSTR_NO_IF;
+				return (-1);
+			}
+			if (is_word(value, tok.len, "endif"))
+				depth--;
+		} else if (is_word(value, tok.len, "segment")) {
+			if (insegment) {
+				*errstrp = ERRSTR_NESTED_SEGMENT;
+				return (-1);
+			}
+			if (template_layout_priority(value, tok.len,
+			    errstrp) == -1)
+				return (-1);
+			insegment = 1;
+		} else if (is_word(value, tok.len, "endsegment")) {
+			if (!insegment) {
+				*errstrp = ERRSTR_NO_SEGMENT;
+				return (-1);
+			}
+			insegment = 0;
+		} else if (template_compile_cmd(value, tok.len, errstrp) == -1) {
+			return (-1);
+		}
+	}
+
+	if (depth != 0) {
+		*errstrp = ERRSTR_NO_ENDIF;
+		return (-1);
+	}
+	if (insegment) {
+		*errstrp = ERRSTR_NO_ENDSEGMENT;
+		return (-1);
+	}
 
 	return (0);
 }
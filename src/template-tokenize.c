@@ -14,128 +14,68 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
-#include <string.h>
 
-#include "wcslcpy.h"
 #include "template.h"
-
-enum fsm_state {
-	STATE_DOLLAR,
-	STATE_STATIC,
-	STATE_STATIC_END,
-	STATE_COMMAND,
-	STATE_COMMAND_END,
-	STATE_APPEND_TOKEN
-};
-
-#define ERRSTR_TOKEN_SIZE L"invalid token size"
-#define ERRSTR_TOO_MANY L"too many tokens"
+#include "trace.h"
 
 /*
- * Given a template wide-char string 's', split all the tokens within and set
- * them on the tokens string array, the size of the array is passed as 'len'.
- * The number of tokens saved on 'tokens' is returned. In case of error, -1 is
- * returned.
+ * Find the next token of the template 'tmpl' starting at offset '*pos' and
+ * describe it in 'tok' as a span (offset and length) of the template itself,
+ * nothing is copied.  On return, '*pos' points right after the token and can
+ * be passed back as-is to get the following one.  Returns 1 if a token was
+ * found, 0 at the end of the template.  There is no limit to the number or
+ * the size of the tokens.
  *
  * For example, given the following string "this is ${a var} foo ${bar}",
- * the 'tokens' array would contain the following strings:
+ * the successive calls would return the following spans:
  *
  *     - this is	(TOKEN_STATIC)
  *     - a var		(TOKEN_COMMAND)
  *     - foo		(TOKEN_STATIC)
  *     - bar		(TOKEN_COMMAND)
  *
- * The return value would be 4.
+ * A '$' not followed by '{' is part of the static text, an unterminated
+ * command runs until the end of the template and empty tokens (e.g. "${}")
+ * are skipped.
  */
 int
-template_tokenize(wchar_t *s, struct token *tokens, size_t len,
-    const wchar_t **errstrp)
+template_tokenize(const char *tmpl, size_t *pos, struct token *tok)
 {
-	enum fsm_state state, next_state;
-	wchar_t buf[MAX_TOKEN_LEN];
-	size_t cur;
-	int count = 0;
+	const char *s, *start;
+	int span;
 
-	*errstrp = NULL;
-	state = next_state = STATE_STATIC;
-	cur = 0;
-	for (;;) {
-		switch (state) {
-		case STATE_STATIC:
-			if (*s == L'\0') {
-				state = STATE_STATIC_END;
-				break;
-			}
-			if (*s == L'$') {
-				state = STATE_DOLLAR;
+	span = trace_begin("tokenize", 8);
+	s = tmpl + *pos;
+	while (*s != '\0') {
+		if (s[0] == '$' && s[1] == '{') {
+			tok->type = TOKEN_COMMAND;
+			start = s + 2;
+			for (s = start; *s != '\0' && *s != '}'; s++)
+				;
+			tok->off = start - tmpl;
+			tok->len = s - start;
+			if (*s == '}')
 				s++;
-				break;
-			}
-			buf[cur++] = *(s++);
-			break;
-		case STATE_STATIC_END:
-			tokens[count].type = TOKEN_STATIC;
-			state = STATE_APPEND_TOKEN;
-			next_state = STATE_COMMAND;
-			break;
-		case STATE_DOLLAR:
-			if (*s == L'{') {
-				state = STATE_STATIC_END;
-				break;
-			}
-			buf[cur++] = L'$';
-			state = STATE_STATIC;
-			break;
-		case STATE_COMMAND:
-			if (*s == L'\0') {
-				state = STATE_COMMAND_END;
-				break;
+		} else {
+			tok->type = TOKEN_STATIC;
+			start = s;
+			for (s++; *s != '\0'; s++) {
+				if (s[0] == '$' && s[1] == '{')
+					break;
 			}
-			if (*s == L'}') {
-				state = STATE_COMMAND_END;
-				break;
-			}
-			buf[cur++] = *(s++);
-			break;
-		case STATE_COMMAND_END:
-			tokens[count].type = TOKEN_COMMAND;
-			state = STATE_APPEND_TOKEN;
-			next_state = STATE_STATIC;
-			break;
-		case STATE_APPEND_TOKEN:
-			/* Copy the new token on the array */
-			if (cur > 0) {
-				buf[cur] = L'\0';
-				if (wcslcpy(tokens[count].value, buf,
-				    MAX_TOKEN_LEN) > MAX_TOKEN_LEN) {
-					*errstrp = ERRSTR_TOKEN_SIZE;
-					return (-1);
-				}
-				count++;
-				if ((size_t)count >= len) {
-					*errstrp = ERRSTR_TOO_MANY;
-					return (-1);
-				}
-				cur = 0;
-			}
-
-			if (*s == L'\0')
-				goto done;
-
-			state = next_state;
-			s++;
-			break;
-		default:
-			break;
+			tok->off = start - tmpl;
+			tok->len = s - start;
 		}
 
-		if (cur >= MAX_TOKEN_LEN) {
-			*errstrp = ERRSTR_TOKEN_SIZE;
-			return (-1);
+		*pos = s - tmpl;
+		if (tok->len > 0) {
+			trace_end(span);
+			return (1);
 		}
 	}
 
-done:
-	return (count);
+	*pos = s - tmpl;
+	trace_end(span);
+
+	return (0);
 }
@@ -14,12 +14,12 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <wchar.h>
-#include <wctype.h>
+#include <ctype.h>
 #include <string.h>
 
+#include "arena.h"
 #include "prwd.h"
-#include "wcslcpy.h"
+#include "strlcpy.h"
 #include "template.h"
 #include "utils.h"
 
@@ -33,8 +33,8 @@ enum fsm_state {
 	STATE_ESCAPED
 };
 
-#define ERRSTR_TOO_LARGE L"argument list too large"
-#define ERRSTR_UNMATCHED_QUOTE L"unmatched quote"
+#define ERRSTR_TOO_LARGE "argument list too large"
+#define ERRSTR_UNMATCHED_QUOTE "unmatched quote"
 
 /*
  * Run a lexical analysis on a variable token extracted from a template.  This
@@ -53,37 +53,46 @@ enum fsm_state {
  *     * bar baz
  *
  * The return value would be 4.  The result is written on the provided arglist,
- * which could be passed to getopt() with its argc and argv properties.
+ * which could be passed to getopt() with its argc and argv properties.  The
+ * variable is read up to 'len' bytes, it does not need to be NUL-terminated.
+ * No argument can be longer than the variable, that is all the room the
+ * lexer takes from the arena.
  */
 size_t
-template_variable_lexer(wchar_t *s, struct arglist *al,
-    const wchar_t **errstrp)
+template_variable_lexer(const char *s, size_t len, struct arglist *al,
+    const char **errstrp)
 {
 	enum fsm_state state, next_state;
-	wchar_t buf[MAX_ARGLIST_SIZE];
+	const char *end = s + len;
 	size_t cur;
+	char *buf;
 
 	*errstrp = NULL;
+	if ((buf = arena_alloc(len + 1)) == NULL) {
+		*errstrp = ERRSTR_TOO_LARGE;
+		return ((size_t)-1);
+	}
+
 	state = next_state = STATE_ARG;
 	cur = 0;
 	for (;;) {
 		switch (state) {
 		case STATE_ARG:
-			if (*s == L'\0') {
+			if (s == end) {
 				state = STATE_ARG_END;
 				break;
 			}
-			if (*s == L'\\') {
+			if (*s == '\\') {
 				state = STATE_BACKSLASH;
 				s++;
 				break;
 			}
-			if (*s == L'"') {
+			if (*s == '"') {
 				state = STATE_QUOTED;
 				s++;
 				break;
 			}
-			if (iswspace(*s)) {
+			if (isspace((unsigned char)*s)) {
 				state = STATE_ARG_END;
 				next_state = STATE_SPACE;
 				break;
@@ -91,13 +100,13 @@ template_variable_lexer(wchar_t *s, struct arglist *al,
 			buf[cur++] = *(s++);
 			break;
 		case STATE_SPACE:
-			if (*s == L'\0')
+			if (s == end)
 				goto done;
-			if (iswspace(*s)) {
+			if (isspace((unsigned char)*s)) {
 				s++;
 				break;
 			}
-			if (*s == L'"') {
+			if (*s == '"') {
 				state = STATE_QUOTED;
 				s++;
 				break;
@@ -105,13 +114,14 @@ template_variable_lexer(wchar_t *s, struct arglist *al,
 			state = STATE_ARG;
 			break;
 		case STATE_BACKSLASH:
-			buf[cur++] = *(s++);
+			if (s != end)
+				buf[cur++] = *(s++);
 			state = STATE_ARG;
 			break;
 		case STATE_ARG_END:
 			/* Copy the new arg on the array */
 			if (cur > 0) {
-				buf[cur] = L'\0';
+				buf[cur] = '\0';
 				if (template_arglist_insert(al, buf) ==
 				    (size_t)-1) {
 					*errstrp = ERRSTR_TOO_LARGE;
@@ -120,41 +130,40 @@ template_variable_lexer(wchar_t *s, struct arglist *al,
 				cur = 0;
 			}
 
-			if (*s == L'\0')
+			if (s == end)
 				goto done;
 
 			state = next_state;
 			s++;
 			break;
 		case STATE_QUOTED:
-			if (*s == L'\\') {
+			if (s == end) {
+				*errstrp = ERRSTR_UNMATCHED_QUOTE;
+				return ((size_t)-1);
+			}
+			if (*s == '\\') {
 				state = STATE_QUOTED_BACKSLASH;
 				s++;
 				break;
 			}
-			if (*s == L'"') {
+			if (*s == '"') {
 				state = STATE_ARG;
 				s++;
 				break;
 			}
-			if (*s == L'\0') {
-				*errstrp = ERRSTR_UNMATCHED_QUOTE;
-				return ((size_t)-1);
-			}
 			buf[cur++] = *(s++);
 			break;
 		case STATE_QUOTED_BACKSLASH:
+			if (s == end) {
+				*errstrp = ERRSTR_UNMATCHED_QUOTE;
+				return ((size_t)-1);
+			}
 			buf[cur++] = *(s++);
 			state = STATE_QUOTED;
 			break;
 		default:
 			break;
 		}
-
-		if (cur >= sizeof(buf) / sizeof(wchar_t)) {
-			*errstrp = ERRSTR_TOO_LARGE;
-			return ((size_t)-1);
-		}
 	}
 
 done:
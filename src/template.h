@@ -17,60 +17,136 @@
 /*
  * This is the order of operation for template rendering:
  *
- *  1. template_tokenize() will take a full template string and turn it into a
- *     list of tokens.
+ *  1. template_tokenize() will find the next token in a template string and
+ *     return it as a span of this string (no copy).
  *  2. template_render() will loop over the tokens and copy or execute them
  *     depending on their type (STATIC vs COMMAND):
  *      2.1. template_exec_cmd() is run from render on command tokens:
  *            a) template_variable_lexer() will split the command tokens
  *               into an arglist which is suitable for getopt().
  *            b) execute the comand based on the arglist.
+ *      2.2. the if, else and endif commands are handled by the renderer
+ *           itself, the tokens of a branch not taken are skipped without
+ *           being executed.
  */
 
 #ifndef _TEMPLATE_H_
 #define _TEMPLATE_H_
 
-#include <wchar.h>
+#include <stddef.h>
 
-/* Maximum number of tokens in a template */
-#define MAX_TOKEN_COUNT 64
+/* Maximum number of command outputs memoized during an invocation */
+#define MAX_MEMO_COUNT 16
 
-/* Maximum token length (wide-chars) */
-#define MAX_TOKEN_LEN 128
+/* Maximum length of a memoized command (bytes) */
+#define MAX_MEMO_KEY_LEN 128
 
-/* Maximum Number of arguments in a single template variable */
-#define MAX_ARG_COUNT 64
-
-/* Maximum number of characters (including NUL-bytes) stored in an arglist */
-#define MAX_ARGLIST_SIZE (64 * MAX_ARG_COUNT)
+/* Maximum length of a memoized command output (bytes) */
+#define MAX_MEMO_LEN 256
 
 enum tokentype { TOKEN_STATIC, TOKEN_COMMAND };
 
+/*
+ * type: static text or command
+ * off, len: span of the token within the template
+ */
 struct token {
 	enum tokentype type;
-	wchar_t value[MAX_TOKEN_LEN];
+	size_t off;
+	size_t len;
 };
 
 /*
  * argc: count of arguments
- * len: number of significant bytes in value
- * argv: pointer to all the arguments in value
- * value: NUL-byte delimited arguments
+ * cap: number of pointers argv has room for
+ * argv: the arguments, followed by a NULL pointer
  */
 struct arglist {
 	size_t argc;
-	size_t len;
-	wchar_t *argv[MAX_ARG_COUNT];
-	wchar_t value[MAX_ARGLIST_SIZE];
+	size_t cap;
+	char **argv;
+};
+
+/*
+ * off, len: bytes of the rendered output
+ * width: columns they take once displayed
+ * segment: segment they belong to, -1 if they are never dropped
+ * cmd, clen: path command which wrote them if it can be cut, else NULL
+ */
+struct span {
+	size_t		 off;
+	size_t		 len;
+	size_t		 width;
+	int		 segment;
+	const char	*cmd;
+	size_t		 clen;
 };
 
-int	 template_tokenize(wchar_t *, struct token *, size_t, const wchar_t **);
-int	 template_render(wchar_t *, wchar_t *, size_t, const wchar_t **);
-size_t	 template_exec_cmd(wchar_t *, wchar_t *, size_t, int,
-		const wchar_t **);
-size_t	 template_variable_lexer(wchar_t *, struct arglist *, const wchar_t **);
+/*
+ * budget: columns the output may take
+ * spans, span_count, span_cap: the output recorded so far, in the arena
+ * priority, dropped: priority of each segment and whether it was dropped
+ * segment_count, segment_cap: segments recorded so far and room for them
+ * current: segment being rendered, -1 if none
+ * overflow: set if the template has more spans or segments than it was
+ *     counted to have
+ */
+struct layout {
+	size_t		 budget;
+	struct span	*spans;
+	size_t		 span_count;
+	size_t		 span_cap;
+	int		*priority;
+	int		*dropped;
+	int		 segment_count;
+	int		 segment_cap;
+	int		 current;
+	int		 overflow;
+};
+
+/*
+ * name: template keyword (e.g. template, rtemplate, title)
+ * tmpl: template to render
+ * out, len: output buffer and its size
+ * budget: columns the output may take, 0 for no limit
+ * width: columns taken by the output once displayed, set by the render
+ */
+struct rendering {
+	const char	*name;
+	char		*tmpl;
+	char		*out;
+	size_t		 len;
+	size_t		 budget;
+	size_t		 width;
+};
+
+int	 template_tokenize(const char *, size_t *, struct token *);
+struct output;
+
+int	 template_render(const char *, char *, size_t, const char **);
+int	 template_render_fit(const char *, char *, size_t, size_t,
+		const char **);
+int	 template_render_output(const char *, struct output *, const char **);
+int	 template_render_many(struct rendering *, size_t, const char **);
+size_t	 template_exec_cmd(const char *, size_t, char *, size_t, int,
+		const char **);
+int	 template_exec_if(const char *, size_t, const char **);
+int	 template_compile(const char *, const char **);
+int	 template_compile_cmd(const char *, size_t, const char **);
+int	 template_compile_if(const char *, size_t, const char **);
+int	 template_exec_cuttable(const char *, size_t);
+size_t	 template_exec_fit(const char *, size_t, size_t, char *, size_t);
+int	 template_layout_priority(const char *, size_t, const char **);
+int	 template_layout_init(struct layout *, size_t, size_t, int);
+void	 template_layout_segment(struct layout *, const char *, size_t);
+void	 template_layout_add(struct layout *, const char *, size_t, size_t,
+		const char *, size_t);
+void	 template_layout_apply(struct layout *, char *, size_t);
+size_t	 template_variable_lexer(const char *, size_t, struct arglist *,
+		const char **);
+void	 template_memo_purge_all(void);
 void	 template_arglist_init(struct arglist *);
-size_t	 template_arglist_insert(struct arglist *, wchar_t *);
+size_t	 template_arglist_insert(struct arglist *, char *);
 
-void	 template_from_config(wchar_t *, size_t);
+void	 template_from_config(char *, size_t);
 #endif /* ifndef _TEMPLATE_H_ */
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "stats.h"
+#include "trace.h"
+
+enum trace_format trace_format = TRACE_OFF;
+unsigned trace_fs_calls = 0;
+
+static struct trace_span spans[MAX_TRACE_SPANS];
+static size_t span_count = 0;
+
+static long long
+clock_us(clockid_t clock)
+{
+	struct timespec ts;
+
+	if (clock_gettime(clock, &ts) == -1)
+		return (0);
+
+	return ((long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+/*
+ * Current time of the monotonic clock (microseconds).
+ */
+long long
+trace_now(void)
+{
+	return (clock_us(CLOCK_MONOTONIC));
+}
+
+/*
+ * Whether the spans are timed, either for -T or for the statistics.
+ */
+int
+trace_enabled(void)
+{
+	return (trace_format != TRACE_OFF || stats_enabled());
+}
+
+/*
+ * Open the span with the given name (not NUL-terminated), creating it the
+ * first time.  Returns the span to pass to trace_end() or -1 if we are neither
+ * tracing nor recording statistics, or the table is full.
+ */
+int
+trace_begin(const char *name, size_t len)
+{
+	struct trace_span *span;
+	size_t i;
+
+	if (!trace_enabled())
+		return (-1);
+
+	if (len >= MAX_TRACE_NAME_LEN)
+		len = MAX_TRACE_NAME_LEN - 1;
+
+	for (i = 0; i < span_count; i++) {
+		if (strncmp(spans[i].name, name, len) == 0 &&
+		    spans[i].name[len] == '\0')
+			break;
+	}
+	if (i == span_count) {
+		if (span_count >= MAX_TRACE_SPANS)
+			return (-1);
+		memset(&spans[i], 0, sizeof(spans[i]));
+		memcpy(spans[i].name, name, len);
+		span_count++;
+	}
+
+	span = &spans[i];
+	span->calls++;
+	span->fs_start = trace_fs_calls;
+	span->cpu_start = clock_us(CLOCK_PROCESS_CPUTIME_ID);
+	span->wall_start = clock_us(CLOCK_MONOTONIC);
+
+	return ((int)i);
+}
+
+void
+trace_end(int i)
+{
+	struct trace_span *span;
+	long long wall;
+
+	if (i < 0)
+		return;
+
+	span = &spans[i];
+	wall = clock_us(CLOCK_MONOTONIC) - span->wall_start;
+	span->wall_us += wall;
+	stats_record(span->name, wall);
+	span->cpu_us += clock_us(CLOCK_PROCESS_CPUTIME_ID) - span->cpu_start;
+	span->fs_calls += trace_fs_calls - span->fs_start;
+}
+
+/*
+ * Print a span name as a JSON string.
+ */
+static void
+json_string(FILE *fp, const char *s)
+{
+	fputc('"', fp);
+	for (; *s != '\0'; s++) {
+		if (*s == '"' || *s == '\\')
+			fprintf(fp, "\\%c", *s);
+		else if ((unsigned char)*s < 0x20)
+			fprintf(fp, "\\u%04x", *s);
+		else
+			fputc(*s, fp);
+	}
+	fputc('"', fp);
+}
+
+/*
+ * Print all the spans in the order they were first opened, in the format
+ * selected with trace_format.
+ */
+void
+trace_report(FILE *fp)
+{
+	struct trace_span *span;
+	size_t i;
+
+	if (trace_format == TRACE_HUMAN) {
+		fprintf(fp, "%-32s %6s %10s %10s %6s\n", "span", "calls",
+		    "wall(us)", "cpu(us)", "fs");
+		for (i = 0; i < span_count; i++) {
+			span = &spans[i];
+			fprintf(fp, "%-32.32s %6u %10lld %10lld %6u\n",
+			    span->name, span->calls, span->wall_us,
+			    span->cpu_us, span->fs_calls);
+		}
+		return;
+	}
+
+	if (trace_format != TRACE_JSON)
+		return;
+
+	fprintf(fp, "{\"spans\":[");
+	for (i = 0; i < span_count; i++) {
+		span = &spans[i];
+		fprintf(fp, "%s{\"name\":", i > 0 ? "," : "");
+		json_string(fp, span->name);
+		fprintf(fp, ",\"calls\":%u,\"wall_us\":%lld,\"cpu_us\":%lld,"
+		    "\"fs_calls\":%u}", span->calls, span->wall_us,
+		    span->cpu_us, span->fs_calls);
+	}
+	fprintf(fp, "]}\n");
+}
+
+/*
+ * Forget all the spans, this is used by the test suite.
+ */
+void
+trace_purge_all(void)
+{
+	span_count = 0;
+	trace_fs_calls = 0;
+	trace_format = TRACE_OFF;
+}
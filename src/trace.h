@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * The tracer records how long each phase of an invocation takes (config,
+ * tokenize, lex, each command, output) when prwd runs with -T.  Spans with
+ * the same name are merged, the times are inclusive of the nested spans.
+ * The filesystem calls made by prwd are always counted (TRACE_FS()), a span
+ * reports how many happened while it was open.  The spans are also timed
+ * when statistics are recorded (see stats.h), each duration is added there.
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define MAX_TRACE_SPANS		64
+#define MAX_TRACE_NAME_LEN	64
+
+enum trace_format { TRACE_OFF, TRACE_HUMAN, TRACE_JSON };
+
+/*
+ * name: phase or command (e.g. "config", "${branch}")
+ * calls: number of times the span was opened
+ * wall_us, cpu_us: cumulated wall clock and CPU time (microseconds)
+ * fs_calls: filesystem calls made while the span was open
+ */
+struct trace_span {
+	char		 name[MAX_TRACE_NAME_LEN];
+	unsigned	 calls;
+	long long	 wall_us;
+	long long	 cpu_us;
+	unsigned	 fs_calls;
+	long long	 wall_start;
+	long long	 cpu_start;
+	unsigned	 fs_start;
+};
+
+extern enum trace_format trace_format;
+extern unsigned trace_fs_calls;
+
+#define TRACE_FS()	(trace_fs_calls++)
+
+long long trace_now(void);
+int	 trace_enabled(void);
+int	 trace_begin(const char *, size_t);
+void	 trace_end(int);
+void	 trace_report(FILE *);
+void	 trace_purge_all(void);
+
+#endif /* ifndef _TRACE_H_ */
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Terminal display width of UTF-8 strings.  The East Asian wide and
+ * fullwidth characters (CJK, most emoji) take two columns, the combining
+ * marks, variation selectors and zero-width characters take none.  Widths are
+ * computed per code point from the tables below instead of wcwidth(3), whose
+ * answer depends on the locale and the age of the libc.  Grapheme clusters
+ * (e.g. emoji joined with U+200D) are not merged.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "utf8width.h"
+
+struct range {
+	uint32_t	first;
+	uint32_t	last;
+};
+
+/* Code points taking no column. */
+static const struct range zero_width[] = {
+	{ 0x0300, 0x036F }, { 0x0483, 0x0489 }, { 0x0591, 0x05BD },
+	{ 0x05BF, 0x05BF }, { 0x05C1, 0x05C2 }, { 0x05C4, 0x05C5 },
+	{ 0x05C7, 0x05C7 }, { 0x0610, 0x061A }, { 0x064B, 0x065F },
+	{ 0x0670, 0x0670 }, { 0x06D6, 0x06DC }, { 0x06DF, 0x06E4 },
+	{ 0x06E7, 0x06E8 }, { 0x06EA, 0x06ED }, { 0x0900, 0x0902 },
+	{ 0x093A, 0x093A }, { 0x093C, 0x093C }, { 0x0941, 0x0948 },
+	{ 0x094D, 0x094D }, { 0x0951, 0x0957 }, { 0x0E31, 0x0E31 },
+	{ 0x0E34, 0x0E3A }, { 0x0E47, 0x0E4E }, { 0x1160, 0x11FF },
+	{ 0x1AB0, 0x1AFF }, { 0x1DC0, 0x1DFF }, { 0x200B, 0x200F },
+	{ 0x202A, 0x202E }, { 0x2060, 0x2064 }, { 0x20D0, 0x20FF },
+	{ 0xFE00, 0xFE0F }, { 0xFE20, 0xFE2F }, { 0xFEFF, 0xFEFF },
+	{ 0x1F3FB, 0x1F3FF }, { 0xE0000, 0xE0FFF },
+};
+
+/* Code points taking two columns. */
+static const struct range double_width[] = {
+	{ 0x1100, 0x115F }, { 0x231A, 0x231B }, { 0x2329, 0x232A },
+	{ 0x23E9, 0x23EC }, { 0x23F0, 0x23F0 }, { 0x23F3, 0x23F3 },
+	{ 0x25FD, 0x25FE }, { 0x2614, 0x2615 }, { 0x2648, 0x2653 },
+	{ 0x267F, 0x267F }, { 0x2693, 0x2693 }, { 0x26A1, 0x26A1 },
+	{ 0x26AA, 0x26AB }, { 0x26BD, 0x26BE }, { 0x26C4, 0x26C5 },
+	{ 0x26CE, 0x26CE }, { 0x26D4, 0x26D4 }, { 0x26EA, 0x26EA },
+	{ 0x26F2, 0x26F3 }, { 0x26F5, 0x26F5 }, { 0x26FA, 0x26FA },
+	{ 0x26FD, 0x26FD }, { 0x2705, 0x2705 }, { 0x270A, 0x270B },
+	{ 0x2728, 0x2728 }, { 0x274C, 0x274C }, { 0x274E, 0x274E },
+	{ 0x2753, 0x2755 }, { 0x2757, 0x2757 }, { 0x2795, 0x2797 },
+	{ 0x27B0, 0x27B0 }, { 0x27BF, 0x27BF }, { 0x2B1B, 0x2B1C },
+	{ 0x2B50, 0x2B50 }, { 0x2B55, 0x2B55 }, { 0x2E80, 0x303E },
+	{ 0x3041, 0x33FF }, { 0x3400, 0x4DBF }, { 0x4E00, 0x9FFF },
+	{ 0xA000, 0xA4CF }, { 0xA960, 0xA97F }, { 0xAC00, 0xD7A3 },
+	{ 0xF900, 0xFAFF }, { 0xFE10, 0xFE19 }, { 0xFE30, 0xFE6F },
+	{ 0xFF00, 0xFF60 }, { 0xFFE0, 0xFFE6 }, { 0x1F004, 0x1F004 },
+	{ 0x1F0CF, 0x1F0CF }, { 0x1F18E, 0x1F18E }, { 0x1F191, 0x1F19A },
+	{ 0x1F200, 0x1F202 }, { 0x1F210, 0x1F23B }, { 0x1F240, 0x1F248 },
+	{ 0x1F250, 0x1F251 }, { 0x1F300, 0x1F320 }, { 0x1F32D, 0x1F335 },
+	{ 0x1F337, 0x1F37C }, { 0x1F37E, 0x1F393 }, { 0x1F3A0, 0x1F3CA },
+	{ 0x1F3CF, 0x1F3D3 }, { 0x1F3E0, 0x1F3F0 }, { 0x1F3F4, 0x1F3F4 },
+	{ 0x1F3F8, 0x1F3FA }, { 0x1F400, 0x1F43E }, { 0x1F440, 0x1F440 },
+	{ 0x1F442, 0x1F4FC }, { 0x1F4FF, 0x1F53D }, { 0x1F54B, 0x1F54E },
+	{ 0x1F550, 0x1F567 }, { 0x1F57A, 0x1F57A }, { 0x1F595, 0x1F596 },
+	{ 0x1F5A4, 0x1F5A4 }, { 0x1F5FB, 0x1F64F }, { 0x1F680, 0x1F6C5 },
+	{ 0x1F6CC, 0x1F6CC }, { 0x1F6D0, 0x1F6D2 }, { 0x1F6D5, 0x1F6D7 },
+	{ 0x1F6EB, 0x1F6EC }, { 0x1F6F4, 0x1F6FC }, { 0x1F7E0, 0x1F7EB },
+	{ 0x1F90C, 0x1F93A }, { 0x1F93C, 0x1F945 }, { 0x1F947, 0x1F9FF },
+	{ 0x1FA70, 0x1FAFF }, { 0x20000, 0x2FFFD }, { 0x30000, 0x3FFFD },
+};
+
+#define NELEM(a) (sizeof(a) / sizeof((a)[0]))
+
+/*
+ * Binary search of the code point in a sorted table of ranges.
+ */
+static int
+in_table(uint32_t cp, const struct range *table, size_t count)
+{
+	size_t lo = 0, hi = count, mid;
+
+	if (cp < table[0].first || cp > table[count - 1].last)
+		return (0);
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (cp > table[mid].last)
+			lo = mid + 1;
+		else if (cp < table[mid].first)
+			hi = mid;
+		else
+			return (1);
+	}
+
+	return (0);
+}
+
+/*
+ * Check whether the first len bytes of s are all ASCII, eight bytes at a time:
+ * any byte with its high bit set makes the word and the mask overlap.
+ */
+int
+utf8_is_ascii(const char *s, size_t len)
+{
+	const uint64_t mask = 0x8080808080808080ULL;
+	uint64_t word;
+
+	for (; len >= sizeof(word); s += sizeof(word), len -= sizeof(word)) {
+		memcpy(&word, s, sizeof(word));
+		if (word & mask)
+			return (0);
+	}
+
+	for (; len > 0; s++, len--) {
+		if (*s & 0x80)
+			return (0);
+	}
+
+	return (1);
+}
+
+/*
+ * Decode the character at s into cp and return its size in bytes.  Invalid or
+ * truncated sequences are decoded as U+FFFD one byte at a time.
+ */
+size_t
+utf8_decode(const char *s, uint32_t *cp)
+{
+	const unsigned char *u = (const unsigned char *)s;
+	size_t n, i;
+
+	if (u[0] < 0x80) {
+		*cp = u[0];
+		return (1);
+	} else if ((u[0] & 0xE0) == 0xC0) {
+		*cp = u[0] & 0x1F;
+		n = 2;
+	} else if ((u[0] & 0xF0) == 0xE0) {
+		*cp = u[0] & 0x0F;
+		n = 3;
+	} else if ((u[0] & 0xF8) == 0xF0) {
+		*cp = u[0] & 0x07;
+		n = 4;
+	} else {
+		*cp = 0xFFFD;
+		return (1);
+	}
+
+	for (i = 1; i < n; i++) {
+		if ((u[i] & 0xC0) != 0x80) {
+			*cp = 0xFFFD;
+			return (1);
+		}
+		*cp = (*cp << 6) | (u[i] & 0x3F);
+	}
+
+	return (n);
+}
+
+/*
+ * Number of columns taken by a code point on a terminal: 0, 1 or 2.
+ */
+int
+utf8_cpwidth(uint32_t cp)
+{
+	if (cp < 0x300)
+		return (1);
+	if (in_table(cp, zero_width, NELEM(zero_width)))
+		return (0);
+	if (in_table(cp, double_width, NELEM(double_width)))
+		return (2);
+
+	return (1);
+}
+
+/*
+ * Display width of a whole UTF-8 string.
+ */
+size_t
+utf8_width(const char *s)
+{
+	uint32_t cp;
+	size_t len, width = 0;
+
+	len = strlen(s);
+	if (utf8_is_ascii(s, len))
+		return (len);
+
+	while (*s != '\0') {
+		s += utf8_decode(s, &cp);
+		width += utf8_cpwidth(cp);
+	}
+
+	return (width);
+}
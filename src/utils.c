@@ -19,13 +19,15 @@
 
 #include <err.h>
 #include <errno.h>
-#include <wchar.h>
+#include <fcntl.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "utils.h"
+#include "trace.h"
 
 /*
  * Check if a file exists (works fine for directories too).
@@ -36,8 +38,9 @@ path_is_valid(char *path)
 {
 	struct stat sb;
 
+	TRACE_FS();
 	if (stat(path, &sb) != 0) {
-		if (errno == ENOENT) {
+		if (errno == ENOENT || errno == ENOTDIR) {
 			return (0);
 		}
 		err(1, "stat() failed on %s", path);
@@ -47,17 +50,6 @@ path_is_valid(char *path)
 }
 #endif	// ifndef REGRESS
 
-/*
- * Checks if a file exists given a wchar path.
- */
-int
-wc_path_is_valid(wchar_t *wpath)
-{
-	char path[MAXPATHLEN];
-	wcstombs(path, wpath, MAXPATHLEN);
-	return (path_is_valid(path));
-}
-
 /*
  * Check if a path is valid using a format string.
  */
@@ -80,7 +72,7 @@ fmt_path_is_valid(char *fmt, ...)
  * Copy all the characters from input to token until we find a '/' or NUL-byte.
  */
 void
-tokcpy(wchar_t *input, wchar_t *token)
+tokcpy(const char *input, char *token)
 {
 	int i;
 
@@ -91,6 +83,110 @@ tokcpy(wchar_t *input, wchar_t *token)
 	token[i] = '\0';
 }
 
+/*
+ * Append n bytes of s to output at *idx.  Returns -1 if output is full, in
+ * which case it is NUL-terminated as is.
+ */
+int
+bufappend(char *output, size_t *idx, size_t len, const char *s, size_t n)
+{
+	if (*idx + n >= len) {
+		output[*idx] = '\0';
+		return (-1);
+	}
+
+	memcpy(output + *idx, s, n);
+	*idx += n;
+	output[*idx] = '\0';
+
+	return (0);
+}
+
+/*
+ * Count the characters of a UTF-8 string, continuation bytes are not counted.
+ */
+size_t
+utf8_len(const char *s)
+{
+	size_t n = 0;
+
+	for (; *s != '\0'; s++) {
+		if ((*s & 0xC0) != 0x80)
+			n++;
+	}
+
+	return (n);
+}
+
+/*
+ * Return a pointer n characters into the UTF-8 string s, or to its NUL-byte if
+ * it is shorter than that.
+ */
+const char *
+utf8_skip(const char *s, size_t n)
+{
+	while (*s != '\0') {
+		if ((*s & 0xC0) != 0x80) {
+			if (n == 0)
+				break;
+			n--;
+		}
+		s++;
+	}
+
+	return (s);
+}
+
+/*
+ * Copy at most n characters of the UTF-8 string src to dst of size len,
+ * without ever splitting a character.  Always NUL terminates (unless
+ * len == 0).  Returns the number of characters copied.
+ */
+size_t
+utf8_ncpy(char *dst, const char *src, size_t len, size_t n)
+{
+	const char *end;
+	size_t count = 0;
+
+	if (len == 0)
+		return (0);
+
+	for (end = src; *end != '\0' && count < n; count++) {
+		end = utf8_skip(end, 1);
+		if ((size_t)(end - src) >= len) {
+			end = src + (len - 1);
+			while (end > src && (*end & 0xC0) == 0x80)
+				end--;
+			break;
+		}
+	}
+
+	memcpy(dst, src, end - src);
+	dst[end - src] = '\0';
+
+	return (utf8_len(dst));
+}
+
+/*
+ * Detach a background child from the terminal and from our standard streams.
+ * The shell reads the prompt until the end of our stdout, a child holding it
+ * open would make it wait for the child.
+ */
+void
+detach_stdio(void)
+{
+	int fd;
+
+	setsid();
+	if ((fd = open("/dev/null", O_RDWR)) == -1)
+		return;
+	dup2(fd, STDIN_FILENO);
+	dup2(fd, STDOUT_FILENO);
+	dup2(fd, STDERR_FILENO);
+	if (fd > STDERR_FILENO)
+		close(fd);
+}
+
 /*
  * Overridable gethostname().
  */
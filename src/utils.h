@@ -15,10 +15,14 @@
  */
 
 #include <stdarg.h>
+#include <stddef.h>
 
 int	 path_is_valid(char *);
-int	 wc_path_is_valid(wchar_t *);
 int	 fmt_path_is_valid(char *, ...);
-void	 tokcpy(wchar_t *, wchar_t *);
+void	 tokcpy(const char *, char *);
+int	 bufappend(char *, size_t *, size_t, const char *, size_t);
 int	 lgethostname(char *, size_t);
-int	 wcswd(wchar_t *, size_t);
+void	 detach_stdio(void);
+size_t	 utf8_len(const char *);
+const char	*utf8_skip(const char *, size_t);
+size_t	 utf8_ncpy(char *, const char *, size_t, size_t);
@@ -0,0 +1,73 @@
+#!/bin/sh
+#
+# Run prwd with the syscount.so shim preloaded for each template listed in the
+# budgets file and fail if it makes more filesystem calls than its budget.
+#
+# usage: budgets.sh prwd budgets
+#
+# Each line of the budgets file is "name|fixture|budget|template" where the
+# fixture is the directory (within the fixture tree) prwd runs from.  Each
+# template is run once to fill the caches, the second run is the one counted,
+# as it would be for all the prompts but the first.
+
+PRWD=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+BUDGETS=$2
+SHIM=$(pwd)/syscount.so
+
+if [ "$(uname)" != "Linux" ]; then
+	echo "syscall budgets are only checked on Linux"
+	exit 0
+fi
+
+base=$(mktemp -d /tmp/prwd-budget-XXXXXX) || exit 1
+trap 'rm -rf "$base"' EXIT
+
+# Fixtures: an empty home, a deep tree, a git repository and a cache dir.
+mkdir -p "$base/home" "$base/run"
+mkdir -p "$base/deep/d00/d01/d02/d03/d04/d05/d06/d07/d08/d09/d10/d11"
+mkdir -p "$base/git/.git" "$base/git/src/lib/util"
+echo "ref: refs/heads/master" > "$base/git/.git/HEAD"
+
+# Directories modified within the last second are never cached.
+find "$base" -exec touch -t 202001010000 {} +
+
+tested=0
+passed=0
+failed=0
+
+while IFS='|' read -r name fixture budget template; do
+	case "$name" in
+	""|\#*)
+		continue
+		;;
+	esac
+
+	for output in /dev/null "$base/counts"; do
+		rm -f "$base/counts"
+		(
+			cd "$base/$fixture" && \
+			HOME="$base/home" XDG_RUNTIME_DIR="$base/run" \
+			SYSCOUNT_OUTPUT="$output" LD_PRELOAD="$SHIM" \
+			"$PRWD" -t "$template" > /dev/null
+		)
+	done
+	calls=$(awk '{ n += $2 } END { print n + 0 }' "$base/counts" \
+	    2>/dev/null)
+
+	tested=$((tested + 1))
+	printf "%-60s" "budget_$name"
+	if [ -n "$calls" ] && [ "$calls" -le "$budget" ]; then
+		echo "PASS"
+		passed=$((passed + 1))
+	else
+		echo "FAIL"
+		echo "    $calls filesystem calls, budget is $budget:"
+		sed 's/^/        /' "$base/counts" 2>/dev/null
+		failed=$((failed + 1))
+	fi
+done < "$BUDGETS"
+
+echo
+echo "$tested budgets ($passed PASS, $failed FAIL)"
+
+[ "$failed" -eq 0 ]
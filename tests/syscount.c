@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Counting shim preloaded in front of prwd by run-budgets: every filesystem
+ * call prwd makes through the libc is counted and the totals are appended to
+ * the file named by $SYSCOUNT_OUTPUT when the process exits, one "call count"
+ * line per kind of call.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+enum { C_STAT, C_LSTAT, C_OPEN, C_FOPEN, C_OPENDIR, C_GETCWD, C_ACCESS,
+    C_COUNT };
+
+static const char *names[C_COUNT] = {
+	"stat", "lstat", "open", "fopen", "opendir", "getcwd", "access"
+};
+static unsigned long counts[C_COUNT];
+
+#define REAL(f)	static __typeof__(f) *real;				\
+	if (real == NULL)						\
+		*(void **)&real = dlsym(RTLD_NEXT, #f)
+
+int
+stat(const char *path, struct stat *sb)
+{
+	REAL(stat);
+	counts[C_STAT]++;
+	return (real(path, sb));
+}
+
+int
+lstat(const char *path, struct stat *sb)
+{
+	REAL(lstat);
+	counts[C_LSTAT]++;
+	return (real(path, sb));
+}
+
+int
+open(const char *path, int flags, ...)
+{
+	va_list ap;
+	mode_t mode = 0;
+
+	REAL(open);
+	counts[C_OPEN]++;
+	if (flags & O_CREAT) {
+		va_start(ap, flags);
+		mode = va_arg(ap, int);
+		va_end(ap);
+	}
+	return (real(path, flags, mode));
+}
+
+FILE *
+fopen(const char *path, const char *mode)
+{
+	REAL(fopen);
+	counts[C_FOPEN]++;
+	return (real(path, mode));
+}
+
+DIR *
+opendir(const char *path)
+{
+	REAL(opendir);
+	counts[C_OPENDIR]++;
+	return (real(path));
+}
+
+char *
+getcwd(char *buf, size_t len)
+{
+	REAL(getcwd);
+	counts[C_GETCWD]++;
+	return (real(buf, len));
+}
+
+int
+access(const char *path, int mode)
+{
+	REAL(access);
+	counts[C_ACCESS]++;
+	return (real(path, mode));
+}
+
+static void __attribute__((destructor))
+syscount_report(void)
+{
+	const char *path;
+	char line[64];
+	int fd, i, n;
+
+	if ((path = getenv("SYSCOUNT_OUTPUT")) == NULL)
+		return;
+
+	/* Use the real open(2), this one is not prwd's. */
+	REAL(open);
+	if ((fd = real(path, O_WRONLY | O_CREAT | O_APPEND, 0600)) == -1)
+		return;
+	for (i = 0; i < C_COUNT; i++) {
+		n = snprintf(line, sizeof(line), "%s %lu\n", names[i],
+		    counts[i]);
+		if (write(fd, line, n) != n)
+			break;
+	}
+	close(fd);
+}
@@ -17,98 +17,98 @@
 static int
 test_alias__replace__none(void)
 {
-	wchar_t pwd[] = L"/usr/src";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char pwd[] = "/usr/src";
+	char output[MAX_OUTPUT_LEN];
 	alias_purge_all();
 	alias_replace(output, pwd, MAX_OUTPUT_LEN);
-	return (assert_wstring_equals(output, L"/usr/src"));
+	return (assert_string_equals(output, "/usr/src"));
 }
 
 static int
 test_alias__replace__home_alone(void)
 {
-	wchar_t pwd[] = L"/home/foo";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char pwd[] = "/home/foo";
+	char output[MAX_OUTPUT_LEN];
 	alias_purge_all();
-	ALIAS_ADD(L"~", L"/home/foo");
+	ALIAS_ADD("~", "/home/foo");
 	alias_replace(output, pwd, MAX_OUTPUT_LEN);
-	return (assert_wstring_equals(output, L"~"));
+	return (assert_string_equals(output, "~"));
 }
 
 static int
 test_alias__replace__home_and_one(void)
 {
-	wchar_t pwd[] = L"/home/foo/x";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char pwd[] = "/home/foo/x";
+	char output[MAX_OUTPUT_LEN];
 	alias_purge_all();
-	ALIAS_ADD(L"~", L"/home/foo");
+	ALIAS_ADD("~", "/home/foo");
 	alias_replace(output, pwd, MAX_OUTPUT_LEN);
-	return (assert_wstring_equals(output, L"~/x"));
+	return (assert_string_equals(output, "~/x"));
 }
 
 static int
 test_alias__replace__home_and_tree(void)
 {
-	wchar_t pwd[] = L"/home/foo/x/projects/prwd";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char pwd[] = "/home/foo/x/projects/prwd";
+	char output[MAX_OUTPUT_LEN];
 	alias_purge_all();
-	ALIAS_ADD(L"~", L"/home/foo");
+	ALIAS_ADD("~", "/home/foo");
 	alias_replace(output, pwd, MAX_OUTPUT_LEN);
-	return (assert_wstring_equals(output, L"~/x/projects/prwd"));
+	return (assert_string_equals(output, "~/x/projects/prwd"));
 }
 
 static int
 test_alias__replace__five_unmatching_aliases(void)
 {
-	wchar_t pwd[] = L"/home/foo/x/projects";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char pwd[] = "/home/foo/x/projects";
+	char output[MAX_OUTPUT_LEN];
 	alias_purge_all();
-	ALIAS_ADD(L"a1", L"/the/first/path");
-	ALIAS_ADD(L"b2", L"/path/second");
-	ALIAS_ADD(L"c3", L"/third/path");
-	ALIAS_ADD(L"d4", L"foo/bar/fourth/path");
-	ALIAS_ADD(L"e5", L"/home/föö");
+	ALIAS_ADD("a1", "/the/first/path");
+	ALIAS_ADD("b2", "/path/second");
+	ALIAS_ADD("c3", "/third/path");
+	ALIAS_ADD("d4", "foo/bar/fourth/path");
+	ALIAS_ADD("e5", "/home/föö");
 	alias_replace(output, pwd, MAX_OUTPUT_LEN);
-	return (assert_wstring_equals(output, L"/home/foo/x/projects"));
+	return (assert_string_equals(output, "/home/foo/x/projects"));
 }
 
 static int
 test_alias__replace__duplicate_aliases(void)
 {
-	wchar_t pwd[] = L"/home/foo/x/projects";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char pwd[] = "/home/foo/x/projects";
+	char output[MAX_OUTPUT_LEN];
 	alias_purge_all();
-	ALIAS_ADD(L"aa", L"/home/foo");
-	ALIAS_ADD(L"aa", L"/home/foo");
-	ALIAS_ADD(L"aa", L"/home/foo");
+	ALIAS_ADD("aa", "/home/foo");
+	ALIAS_ADD("aa", "/home/foo");
+	ALIAS_ADD("aa", "/home/foo");
 	alias_replace(output, pwd, MAX_OUTPUT_LEN);
-	return (assert_wstring_equals(output, L"aa/x/projects"));
+	return (assert_string_equals(output, "aa/x/projects"));
 }
 
 static int
 test_alias__replace__find_smallest(void)
 {
-	wchar_t pwd[] = L"/home/foo/x/y/z/projects/prwd";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char pwd[] = "/home/foo/x/y/z/projects/prwd";
+	char output[MAX_OUTPUT_LEN];
 	alias_purge_all();
-	ALIAS_ADD(L"bad1", L"/home/foo");
-	ALIAS_ADD(L"bad2", L"/home");
-	ALIAS_ADD(L"bad3", L"/home/foo/x");
-	ALIAS_ADD(L"good", L"/home/foo/x/y/z");
+	ALIAS_ADD("bad1", "/home/foo");
+	ALIAS_ADD("bad2", "/home");
+	ALIAS_ADD("bad3", "/home/foo/x");
+	ALIAS_ADD("good", "/home/foo/x/y/z");
 	alias_replace(output, pwd, MAX_OUTPUT_LEN);
-	return (assert_wstring_equals(output, L"good/projects/prwd"));
+	return (assert_string_equals(output, "good/projects/prwd"));
 }
 
 static int
 test_alias__replace__nested(void)
 {
-	wchar_t pwd[] = L"/home/foo/projects/prwd";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char pwd[] = "/home/foo/projects/prwd";
+	char output[MAX_OUTPUT_LEN];
 	alias_purge_all();
-	ALIAS_ADD(L"$p", L"/home/foo/projects");
-	ALIAS_ADD(L"$prwd", L"$p/prwd");
+	ALIAS_ADD("$p", "/home/foo/projects");
+	ALIAS_ADD("$prwd", "$p/prwd");
 	alias_replace_recursive(output, pwd, MAX_OUTPUT_LEN);
-	return (assert_wstring_equals(output, L"$prwd"));
+	return (assert_string_equals(output, "$prwd"));
 }
 
 static int
@@ -117,53 +117,53 @@ test_alias__add__too_many(void)
 	int i;
 	alias_purge_all();
 	for (i = 0; i < MAX_ALIASES * 2; i++) {
-		ALIAS_ADD(L"aa", L"/home/foo");
+		ALIAS_ADD("aa", "/home/foo");
 	}
 
-	alias_add(L"aa", L"/home/foo", &errstr);
+	alias_add("aa", "/home/foo", &errstr);
 	if (errstr == NULL) {
 		snprintf(details, sizeof(details),
 		    "alias_add should have returned an error");
 		return (0);
 	}
 
-	return (assert_wstring_equals(errstr, L"too many aliases"));
+	return (assert_string_equals(errstr, "too many aliases"));
 }
 
 static int
 test_alias__expand_prefix__normal(void)
 {
-	wchar_t s[MAX_OUTPUT_LEN] = L"$local/man/cat1";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char s[MAX_OUTPUT_LEN] = "$local/man/cat1";
+	char output[MAX_OUTPUT_LEN];
 
 	alias_purge_all();
-	ALIAS_ADD(L"$local", L"/usr/local");
+	ALIAS_ADD("$local", "/usr/local");
 	alias_expand_prefix(s, output);
-	return (assert_wstring_equals(output, L"/usr/local/man/cat1"));
+	return (assert_string_equals(output, "/usr/local/man/cat1"));
 }
 
 static int
 test_alias__expand_prefix__with_slash(void)
 {
-	wchar_t s[MAX_OUTPUT_LEN] = L"$local/man/cat1/";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char s[MAX_OUTPUT_LEN] = "$local/man/cat1/";
+	char output[MAX_OUTPUT_LEN];
 
 	alias_purge_all();
-	ALIAS_ADD(L"$local", L"/usr/local/");
+	ALIAS_ADD("$local", "/usr/local/");
 	alias_expand_prefix(s, output);
-	return (assert_wstring_equals(output, L"/usr/local//man/cat1/"));
+	return (assert_string_equals(output, "/usr/local//man/cat1/"));
 }
 
 static int
 test_alias__expand_prefix__single(void)
 {
-	wchar_t s[MAX_OUTPUT_LEN] = L"$local";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char s[MAX_OUTPUT_LEN] = "$local";
+	char output[MAX_OUTPUT_LEN];
 
 	alias_purge_all();
-	ALIAS_ADD(L"$local", L"/usr/local");
+	ALIAS_ADD("$local", "/usr/local");
 	alias_expand_prefix(s, output);
-	return (assert_wstring_equals(output, L"/usr/local"));
+	return (assert_string_equals(output, "/usr/local"));
 }
 
 /*
@@ -173,11 +173,11 @@ test_alias__expand_prefix__single(void)
 static int
 test_alias__expand_prefix__no_alias(void)
 {
-	wchar_t s[MAX_OUTPUT_LEN] = L"local";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char s[MAX_OUTPUT_LEN] = "local";
+	char output[MAX_OUTPUT_LEN];
 
 	alias_purge_all();
-	ALIAS_ADD(L"$local", L"/usr/local");
+	ALIAS_ADD("$local", "/usr/local");
 	alias_expand_prefix(s, output);
-	return (assert_wstring_equals(output, L"local"));
+	return (assert_string_equals(output, "local"));
 }
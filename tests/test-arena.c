@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+static int
+test_arena__aligned(void)
+{
+	char *a, *b;
+
+	a = arena_alloc(3);
+	b = arena_alloc(1);
+
+	return (
+	    assert_int_equals((size_t)a % ARENA_ALIGN, 0) &&
+	    assert_size_t_equals(b - a, ARENA_ALIGN)
+	);
+}
+
+static int
+test_arena__release(void)
+{
+	char *a, *b;
+	size_t mark;
+
+	arena_alloc(100);
+	mark = arena_mark();
+	a = arena_alloc(500);
+	arena_release(mark);
+	b = arena_alloc(10);
+
+	return (
+	    assert_int_equals(a == b, 1) &&
+	    assert_size_t_equals(arena_mark(), mark + ARENA_ALIGN)
+	);
+}
+
+static int
+test_arena__full(void)
+{
+	void *a, *b, *c;
+
+	a = arena_alloc(ARENA_SIZE - 32);
+	b = arena_alloc(64);
+	c = arena_alloc(32);
+
+	return (
+	    assert_int_equals(a != NULL, 1) &&
+	    assert_null(b) &&
+	    assert_int_equals(c != NULL, 1) &&
+	    assert_null(arena_alloc(1))
+	);
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Run a template command line through cmd_color_exec into buf, as seen by a
+ * terminal with the given $TERM and $COLORTERM.
+ */
+static void
+color_template(const char *template, const char *term, const char *colorterm,
+    char *buf, size_t len)
+{
+	char input[MAX_OUTPUT_LEN];
+	struct arglist al;
+
+	setenv("TERM", term, 1);
+	if (colorterm != NULL)
+		setenv("COLORTERM", colorterm, 1);
+	else
+		unsetenv("COLORTERM");
+	facts_purge_all();
+
+	strlcpy(input, template, sizeof(input));
+	template_arglist_init(&al);
+	template_variable_lexer(input, strlen(input), &al, &errstr);
+	cmd_color_exec(al.argc, al.argv, buf, len);
+}
+
+static int
+test_cmd_color_exec__code(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color 208", "xterm-256color", NULL, buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "\033[38;5;208m"));
+}
+
+static int
+test_cmd_color_exec__reset(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color reset", "xterm", NULL, buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "\033[0;0m"));
+}
+
+static int
+test_cmd_color_exec__name_attributes(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color -bu brightred", "xterm", NULL, buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "\033[1;4;91m"));
+}
+
+static int
+test_cmd_color_exec__bold_only(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color -b", "xterm", NULL, buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "\033[1m"));
+}
+
+static int
+test_cmd_color_exec__truecolor(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color #ff8700", "xterm", "truecolor", buf,
+	    sizeof(buf));
+
+	return (assert_string_equals(buf, "\033[38;2;255;135;0m"));
+}
+
+static int
+test_cmd_color_exec__truecolor_to_256(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color #FF8700", "xterm-256color", NULL, buf,
+	    sizeof(buf));
+
+	return (assert_string_equals(buf, "\033[38;5;208m"));
+}
+
+static int
+test_cmd_color_exec__truecolor_to_gray(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color #808080", "xterm-256color", NULL, buf,
+	    sizeof(buf));
+
+	return (assert_string_equals(buf, "\033[38;5;244m"));
+}
+
+static int
+test_cmd_color_exec__256_to_16(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color 196", "linux", NULL, buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "\033[91m"));
+}
+
+static int
+test_cmd_color_exec__low_code_on_16(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color 4", "vt220", NULL, buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "\033[34m"));
+}
+
+static int
+test_cmd_color_exec__err_bad_hex(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color #12345g", "xterm", NULL, buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "<color-bad-code>"));
+}
+
+static int
+test_cmd_color_exec__err_reset_bold(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	color_template("color -b reset", "xterm", NULL, buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "<color-bad-arg>"));
+}
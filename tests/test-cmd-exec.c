@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Run a template command line through cmd_exec_exec into buf.
+ */
+static void
+exec_template(const char *template, char *buf, size_t len)
+{
+	char input[MAX_OUTPUT_LEN];
+	struct arglist al;
+
+	strlcpy(input, template, sizeof(input));
+	template_arglist_init(&al);
+	template_variable_lexer(input, strlen(input), &al, &errstr);
+	cmd_exec_exec(al.argc, al.argv, buf, len);
+}
+
+static int
+test_cmd_exec_exec__simple(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	exec_template("exec echo foo bar", buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "foo bar"));
+}
+
+static int
+test_cmd_exec_exec__trailing_newlines(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	exec_template("exec seq 2", buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "1\n2"));
+}
+
+static int
+test_cmd_exec_exec__timeout(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	exec_template("exec -w 50 sleep 5", buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "<exec-timeout>"));
+}
+
+/*
+ * Closing its output doesn't let a command run past the timeout.
+ */
+static int
+test_cmd_exec_exec__timeout_closed_output(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	exec_template("exec -w 50 sh -c \"exec >&- ; sleep 5\"", buf,
+	    sizeof(buf));
+
+	return (assert_string_equals(buf, "<exec-timeout>"));
+}
+
+static int
+test_cmd_exec_exec__not_found(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	exec_template("exec /nonexistent/prwd-command", buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "<exec-failed>"));
+}
+
+static int
+test_cmd_exec_exec__bad_arg(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	exec_template("exec -t foo echo", buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "<exec-bad-arg>"));
+}
+
+static int
+test_cmd_exec_exec__no_command(void)
+{
+	char buf[MAX_OUTPUT_LEN];
+
+	exec_template("exec -t 10", buf, sizeof(buf));
+
+	return (assert_string_equals(buf, "<exec-bad-arg>"));
+}
+
+static int
+exec_rm(const char *path, const struct stat *sb, int flag, struct FTW *ftw)
+{
+	(void)sb;
+	(void)flag;
+	(void)ftw;
+	return (remove(path));
+}
+
+/*
+ * A command with a TTL is only run once, the second call is served from the
+ * cache even though the command's output changed.
+ */
+static int
+test_cmd_exec_exec__ttl_cache(void)
+{
+	char base[MAXPATHLEN] = "/tmp/prwd-test-XXXXXX";
+	char first[MAX_OUTPUT_LEN], second[MAX_OUTPUT_LEN];
+
+	if (mkdtemp(base) == NULL)
+		return (0);
+	setenv("XDG_RUNTIME_DIR", base, 1);
+
+	exec_template("exec -t 60 date +%s.%N", first, sizeof(first));
+	exec_template("exec -t 60 date +%s.%N", second, sizeof(second));
+
+	nftw(base, exec_rm, 8, FTW_DEPTH | FTW_PHYS);
+
+	return (
+	    assert_string_equals(first, second) &&
+	    assert_int_equals(strchr(first, '<') == NULL, 1)
+	);
+}
@@ -17,31 +17,118 @@
 static int
 test_cmd_hostname_exec__short(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"hostname";
-	wchar_t buf[MAX_OUTPUT_LEN];
+	char input[MAX_OUTPUT_LEN] = "hostname";
+	char buf[MAX_OUTPUT_LEN];
 	struct arglist al;
 
 	strlcpy(test_hostname_value, "foobar.example.com", MAXHOSTNAMELEN);
 
 	template_arglist_init(&al);
-	template_variable_lexer(input, &al, &errstr);
+	template_variable_lexer(input, strlen(input), &al, &errstr);
 	cmd_hostname_exec(al.argc, al.argv, buf, MAX_OUTPUT_LEN);
 
-	return (assert_wstring_equals(buf, L"foobar"));
+	return (assert_string_equals(buf, "foobar"));
 }
 
 static int
 test_cmd_hostname_exec__long(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"hostname -l";
-	wchar_t buf[MAX_OUTPUT_LEN];
+	char input[MAX_OUTPUT_LEN] = "hostname -l";
+	char buf[MAX_OUTPUT_LEN];
 	struct arglist al;
 
 	strlcpy(test_hostname_value, "foobar.example.com", MAXHOSTNAMELEN);
 
 	template_arglist_init(&al);
-	template_variable_lexer(input, &al, &errstr);
+	template_variable_lexer(input, strlen(input), &al, &errstr);
 	cmd_hostname_exec(al.argc, al.argv, buf, MAX_OUTPUT_LEN);
 
-	return (assert_wstring_equals(buf, L"foobar.example.com"));
+	return (assert_string_equals(buf, "foobar.example.com"));
+}
+
+static int
+test_cmd_hostname_exec__fqdn_already_qualified(void)
+{
+	char input[MAX_OUTPUT_LEN] = "hostname -f";
+	char buf[MAX_OUTPUT_LEN];
+	struct arglist al;
+
+	strlcpy(test_hostname_value, "foobar.example.com", MAXHOSTNAMELEN);
+
+	template_arglist_init(&al);
+	template_variable_lexer(input, strlen(input), &al, &errstr);
+	cmd_hostname_exec(al.argc, al.argv, buf, MAX_OUTPUT_LEN);
+
+	return (assert_string_equals(buf, "foobar.example.com"));
+}
+
+/*
+ * Write a hosts(5) file in a scratch location, path is set to its name.
+ */
+static int
+hosts_fixture(char *path, size_t len)
+{
+	FILE *fp;
+	int fd;
+
+	strlcpy(path, "/tmp/prwd-hosts-XXXXXX", len);
+	if ((fd = mkstemp(path)) == -1)
+		return (-1);
+	if ((fp = fdopen(fd, "w")) == NULL)
+		return (-1);
+	fputs("# comment foobar.invalid foobar\n"
+	    "127.0.0.1\tlocalhost\n"
+	    "10.0.0.1 foobar.example.com foobar  # main\n"
+	    "10.0.0.2 bar baz.example.org baz\n", fp);
+	fclose(fp);
+
+	return (0);
+}
+
+static int
+test_fqdn_from_hosts__canonical(void)
+{
+	char path[MAXPATHLEN], out[MAX_FQDN_LEN];
+	int i;
+
+	if (hosts_fixture(path, sizeof(path)) == -1)
+		return (0);
+	i = fqdn_from_hosts(path, "foobar", out, sizeof(out));
+	unlink(path);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(out, "foobar.example.com")
+	);
+}
+
+static int
+test_fqdn_from_hosts__alias(void)
+{
+	char path[MAXPATHLEN], out[MAX_FQDN_LEN];
+	int i;
+
+	if (hosts_fixture(path, sizeof(path)) == -1)
+		return (0);
+	i = fqdn_from_hosts(path, "baz", out, sizeof(out));
+	unlink(path);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(out, "baz.example.org")
+	);
+}
+
+static int
+test_fqdn_from_hosts__not_found(void)
+{
+	char path[MAXPATHLEN], out[MAX_FQDN_LEN];
+	int i;
+
+	if (hosts_fixture(path, sizeof(path)) == -1)
+		return (0);
+	i = fqdn_from_hosts(path, "localhost", out, sizeof(out));
+	unlink(path);
+
+	return (assert_int_equals(i, -1));
 }
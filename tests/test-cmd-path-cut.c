@@ -19,203 +19,303 @@
 static int
 test_path_quickcut__empty(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 32;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_quickcut(out, L"", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "");
+	path_quickcut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L""));
+	return (assert_string_equals(out, ""));
 }
 
 static int
 test_path_quickcut__one_to_one(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 1;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_quickcut(out, L"o", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "o");
+	path_quickcut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"o"));
+	return (assert_string_equals(out, "o"));
 }
 
 static int
 test_path_quickcut__one_to_two(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 2;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_quickcut(out, L"o", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "o");
+	path_quickcut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"o"));
+	return (assert_string_equals(out, "o"));
 }
 
 static int
 test_path_quickcut__thirty_to_ten(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 10;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_quickcut(out, L"qwertyuiopasdfghjklzxcvbnmqwer", TBUFLEN,
+	path_index_build(&pi, "qwertyuiopasdfghjklzxcvbnmqwer");
+	path_quickcut(out, &pi, TBUFLEN,
 	    maxlen, filler);
 
-	return (assert_wstring_equals(out, L"...bnmqwer"));
+	return (assert_string_equals(out, "...bnmqwer"));
 }
 
 static int
 test_path_quickcut__ten_to_thirty(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 30;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_quickcut(out, L"1234567890", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "1234567890");
+	path_quickcut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"1234567890"));
+	return (assert_string_equals(out, "1234567890"));
 }
 
 static int
 test_path_quickcut__ten_to_ten(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 10;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_quickcut(out, L"1234567890", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "1234567890");
+	path_quickcut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"1234567890"));
+	return (assert_string_equals(out, "1234567890"));
 }
 
 static int
 test_path_cleancut__empty(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 10;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_cleancut(out, L"", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L""));
+	return (assert_string_equals(out, ""));
 }
 
 static int
 test_path_cleancut__root_to_ten(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 10;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_cleancut(out, L"/", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "/");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"/"));
+	return (assert_string_equals(out, "/"));
 }
 
 static int
 test_path_cleancut__root_to_one(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 1;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_cleancut(out, L"/", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "/");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"/"));
+	return (assert_string_equals(out, "/"));
 }
 
 static int
 test_path_cleancut__tmp_to_one(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 1;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_cleancut(out, L"/tmp", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "/tmp");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"."));
+	return (assert_string_equals(out, "."));
 }
 
 static int
 test_path_cleancut__tmp_to_three(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 3;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_cleancut(out, L"/tmp", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "/tmp");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"..."));
+	return (assert_string_equals(out, "..."));
 }
 
 static int
 test_path_cleancut__tmp_to_four(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 4;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_cleancut(out, L"/tmp", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "/tmp");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"/tmp"));
+	return (assert_string_equals(out, "/tmp"));
 }
 
 static int
 test_path_cleancut__tmp_to_ten(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 10;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_cleancut(out, L"/tmp", TBUFLEN, maxlen, filler);
-	return (assert_wstring_equals(out, L"/tmp"));
+	path_index_build(&pi, "/tmp");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
+	return (assert_string_equals(out, "/tmp"));
 }
 
 static int
 test_path_cleancut__uld_to_one(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 1;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_cleancut(out, L"/usr/local/doc", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "/usr/local/doc");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"."));
+	return (assert_string_equals(out, "."));
 }
 
 static int
 test_path_cleancut__uld_to_five(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 5;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_cleancut(out, L"/usr/local/doc", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "/usr/local/doc");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"...oc"));
+	return (assert_string_equals(out, "...oc"));
 }
 
 static int
 test_path_cleancut__uld_to_ten(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 10;
-	wchar_t filler[] = L"...";
+	char filler[] = "...";
 
-	path_cleancut(out, L"/usr/local/doc", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "/usr/local/doc");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L".../doc"));
+	return (assert_string_equals(out, ".../doc"));
 }
 
 static int
 test_path_cleancut__uld_to_eleven(void)
 {
-	wchar_t out[TBUFLEN];
+	struct path_index pi;
+	char out[TBUFLEN];
 	size_t maxlen = 11;
-	wchar_t filler[] = L"_";
+	char filler[] = "_";
 
-	path_cleancut(out, L"/usr/local/doc", TBUFLEN, maxlen, filler);
+	path_index_build(&pi, "/usr/local/doc");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
 
-	return (assert_wstring_equals(out, L"_/local/doc"));
+	return (assert_string_equals(out, "_/local/doc"));
+}
+
+static int
+test_path_quickcut__utf8_counts_characters(void)
+{
+	struct path_index pi;
+	char out[TBUFLEN];
+	size_t maxlen = 6;
+	char filler[] = "...";
+
+	path_index_build(&pi, "/home/tëst/ünï");
+	path_quickcut(out, &pi, TBUFLEN, maxlen, filler);
+
+	return (assert_string_equals(out, "...ünï"));
+}
+
+static int
+test_path_cleancut__utf8_counts_characters(void)
+{
+	struct path_index pi;
+	char out[TBUFLEN];
+	size_t maxlen = 8;
+	char filler[] = "...";
+
+	path_index_build(&pi, "/home/tëst/ünï");
+	path_cleancut(out, &pi, TBUFLEN, maxlen, filler);
+
+	return (assert_string_equals(out, ".../ünï"));
+}
+
+static int
+test_path_quickcut__wide_characters(void)
+{
+	struct path_index pi;
+	char out[TBUFLEN];
+
+	/* Each ideograph takes two columns, the cut cannot split one. */
+	path_index_build(&pi, "/home/日本語/文書");
+	path_quickcut(out, &pi, TBUFLEN, 8, "...");
+
+	return (assert_string_equals(out, ".../文書"));
+}
+
+static int
+test_path_quickcut__combining_characters(void)
+{
+	struct path_index pi;
+	char out[TBUFLEN];
+
+	/* The accent is not separated from its letter. */
+	path_index_build(&pi, "/tmp/cafe\xcc\x81s");
+	path_quickcut(out, &pi, TBUFLEN, 4, ".");
+
+	return (assert_string_equals(out, ".fe\xcc\x81s"));
+}
+
+static int
+test_path_cleancut__wide_characters(void)
+{
+	struct path_index pi;
+	char out[TBUFLEN];
+
+	path_index_build(&pi, "/home/日本語/文書");
+	path_cleancut(out, &pi, TBUFLEN, 10, "...");
+
+	return (assert_string_equals(out, ".../文書"));
 }
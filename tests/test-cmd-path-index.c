@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+static int
+test_path_index__components(void)
+{
+	struct path_index pi;
+
+	path_index_build(&pi, "~/föö/bar/");
+
+	return (
+	    assert_int_equals(pi.count, 3) &&
+	    assert_int_equals(pi.off[1], 1) &&
+	    assert_int_equals(pi.off[2], 7) &&
+	    assert_int_equals(pi.off[3], 12) &&
+	    assert_int_equals(pi.width[2], 5) &&
+	    assert_int_equals(path_index_width_from(&pi, 0), 10) &&
+	    assert_int_equals(path_index_width_from(&pi, 2), 5)
+	);
+}
+
+static int
+test_path_index__root(void)
+{
+	struct path_index pi;
+
+	path_index_build(&pi, "/");
+
+	return (
+	    assert_int_equals(pi.count, 1) &&
+	    assert_int_equals(path_index_width_from(&pi, 0), 1)
+	);
+}
+
+static int
+test_path_index__skip(void)
+{
+	struct path_index pi;
+
+	path_index_build(&pi, "/usr/löcal/doc");
+
+	return (
+	    assert_string_equals(path_index_skip(&pi, 0), "/usr/löcal/doc") &&
+	    assert_string_equals(path_index_skip(&pi, 7), "cal/doc") &&
+	    assert_string_equals(path_index_skip(&pi, 10), "/doc") &&
+	    assert_string_equals(path_index_skip(&pi, 42), "")
+	);
+}
+
+static int
+test_path_index__too_many_components(void)
+{
+	struct path_index pi;
+	char path[MAX_OUTPUT_LEN * 2 + 1];
+	size_t i;
+
+	for (i = 0; i < MAX_OUTPUT_LEN; i++) {
+		path[i * 2] = '/';
+		path[i * 2 + 1] = 'a';
+	}
+	path[MAX_OUTPUT_LEN * 2] = '\0';
+	path_index_build(&pi, path);
+
+	return (
+	    assert_int_equals(pi.count, MAX_PATH_COMPONENTS) &&
+	    assert_int_equals(path_index_width_from(&pi, 0),
+		MAX_OUTPUT_LEN * 2)
+	);
+}
@@ -17,7 +17,7 @@
 static int
 test_path_newsgroupize__null(void)
 {
-	wchar_t out[64];
+	char out[64];
 	path_newsgroupize(out, NULL, 64);
 	return (1);
 }
@@ -25,87 +25,119 @@ test_path_newsgroupize__null(void)
 static int
 test_path_newsgroupize__empty(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"", 64);
-	return (assert_wstring_equals(out, L""));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, ""));
 }
 
 static int
 test_path_newsgroupize__one(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"a", 64);
-	return (assert_wstring_equals(out, L"a"));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "a");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "a"));
 }
 
 static int
 test_path_newsgroupize__root(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"/", 64);
-	return (assert_wstring_equals(out, L"/"));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "/");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "/"));
 }
 
 static int
 test_path_newsgroupize__slash_one(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"/a", 64);
-	return (assert_wstring_equals(out, L"/a"));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "/a");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "/a"));
 }
 
 static int
 test_path_newsgroupize__tmp(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"/foo", 64);
-	return (assert_wstring_equals(out, L"/foo"));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "/foo");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "/foo"));
 }
 
 static int
 test_path_newsgroupize__home(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"/foo/bar", 64);
-	return (assert_wstring_equals(out, L"/f/bar"));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "/foo/bar");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "/f/bar"));
 }
 
 static int
 test_path_newsgroupize__shortpath(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"~/foo/bar", 64);
-	return (assert_wstring_equals(out, L"~/f/bar"));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "~/foo/bar");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "~/f/bar"));
 }
 
 static int
 test_path_newsgroupize__shortpath_one_level(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"~/foo", 64);
-	return (assert_wstring_equals(out, L"~/foo"));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "~/foo");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "~/foo"));
 }
 
 static int
 test_path_newsgroupize__alreadyshort(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"/a/b/c/d/e/f/g/h/i/j", 64);
-	return (assert_wstring_equals(out, L"/a/b/c/d/e/f/g/h/i/j"));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "/a/b/c/d/e/f/g/h/i/j");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "/a/b/c/d/e/f/g/h/i/j"));
 }
 
 static int
 test_path_newsgroupize__trailingslash(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"/foo/bar/", 64);
-	return (assert_wstring_equals(out, L"/f/bar/"));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "/foo/bar/");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "/f/bar/"));
 }
 
 static int
 test_path_newsgroupize__alias(void)
 {
-	wchar_t out[64];
-	path_newsgroupize(out, L"$alias/foo/bar/baz", 64);
-	return (assert_wstring_equals(out, L"$alias/f/b/baz"));
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "$alias/foo/bar/baz");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "$alias/f/b/baz"));
+}
+
+static int
+test_path_newsgroupize__double_slash(void)
+{
+	struct path_index pi;
+	char out[64];
+	path_index_build(&pi, "/usr//löcal/doc");
+	path_newsgroupize(out, &pi, 64);
+	return (assert_string_equals(out, "/u//l/doc"));
 }
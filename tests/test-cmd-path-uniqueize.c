@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Write base followed by path on out.  Returns -1 if it doesn't fit.
+ */
+static int
+uniqueize_join(char *out, size_t len, const char *base, const char *path)
+{
+	int n;
+
+	n = snprintf(out, len, "%s%s", base, path);
+	if (n < 0 || (size_t)n >= len)
+		return (-1);
+
+	return (0);
+}
+
+/*
+ * Create a directory and set its modification time and its parent's in the
+ * past, a directory modified within the last second is never cached.
+ */
+static void
+uniqueize_mkdir(const char *base, const char *path)
+{
+	char full[MAXPATHLEN];
+	struct timeval tv[2];
+
+	if (uniqueize_join(full, sizeof(full), base, path) == -1)
+		return;
+	mkdir(full, 0700);
+	tv[0].tv_sec = tv[1].tv_sec = time(NULL) - 60;
+	tv[0].tv_usec = tv[1].tv_usec = 0;
+	utimes(full, tv);
+	*strrchr(full, '/') = '\0';
+	utimes(full, tv);
+}
+
+static int
+uniqueize_rm(const char *path, const struct stat *sb, int flag,
+    struct FTW *ftw)
+{
+	(void)sb;
+	(void)flag;
+	(void)ftw;
+	return (remove(path));
+}
+
+/*
+ * Remove the scratch tree and its cache.
+ */
+static void
+uniqueize_teardown(const char *base)
+{
+	nftw(base, uniqueize_rm, 8, FTW_DEPTH | FTW_PHYS);
+}
+
+/*
+ * Build a scratch tree with a private cache directory, base is set to the
+ * top of the tree.
+ */
+static int
+uniqueize_setup(char *base, size_t len)
+{
+	char runtime[MAXPATHLEN];
+
+	strlcpy(base, "/tmp/prwd-test-XXXXXX", len);
+	if (mkdtemp(base) == NULL)
+		return (-1);
+	if (uniqueize_join(runtime, sizeof(runtime), base, "/run") == -1)
+		return (-1);
+	mkdir(runtime, 0700);
+	setenv("XDG_RUNTIME_DIR", runtime, 1);
+
+	uniqueize_mkdir(base, "/usr");
+	uniqueize_mkdir(base, "/usr/lib");
+	uniqueize_mkdir(base, "/usr/local");
+	uniqueize_mkdir(base, "/usr/local/share");
+	uniqueize_mkdir(base, "/usr/local/share/doc");
+	uniqueize_mkdir(base, "/usr/local/src");
+
+	return (0);
+}
+
+static int
+test_path_uniqueize__siblings(void)
+{
+	struct path_index pi;
+	char base[MAXPATHLEN], cwd[MAXPATHLEN], out[MAXPATHLEN];
+	const char *c;
+
+	if (uniqueize_setup(base, sizeof(base)) == -1)
+		return (0);
+
+	if (uniqueize_join(cwd, sizeof(cwd), base, "/usr/local/share/doc") == -1) {
+		uniqueize_teardown(base);
+		return (0);
+	}
+	path_index_build(&pi, cwd);
+	path_uniqueize(out, &pi, cwd, sizeof(out));
+
+	/* Skip the shortened scratch directory. */
+	c = strstr(out, "/u/");
+	uniqueize_teardown(base);
+
+	return (assert_string_equals(c, "/u/lo/sh/doc"));
+}
+
+static int
+test_path_uniqueize__alias(void)
+{
+	struct path_index pi;
+	char base[MAXPATHLEN], cwd[MAXPATHLEN], out[MAXPATHLEN];
+
+	if (uniqueize_setup(base, sizeof(base)) == -1)
+		return (0);
+
+	if (uniqueize_join(cwd, sizeof(cwd), base, "/usr/local/share/doc") == -1) {
+		uniqueize_teardown(base);
+		return (0);
+	}
+	path_index_build(&pi, "$root/local/share/doc");
+	path_uniqueize(out, &pi, cwd, sizeof(out));
+	uniqueize_teardown(base);
+
+	return (assert_string_equals(out, "$root/lo/sh/doc"));
+}
+
+static int
+test_path_uniqueize__cache_invalidation(void)
+{
+	struct path_index pi;
+	char base[MAXPATHLEN], cwd[MAXPATHLEN], out[MAXPATHLEN];
+	char entry[MAXPATHLEN], name[64];
+	struct stat sb;
+	int cached;
+
+	if (uniqueize_setup(base, sizeof(base)) == -1)
+		return (0);
+
+	if (uniqueize_join(cwd, sizeof(cwd), base, "/usr/local/share/doc") == -1) {
+		uniqueize_teardown(base);
+		return (0);
+	}
+	path_index_build(&pi, "$root/local/share/doc");
+	path_uniqueize(out, &pi, cwd, sizeof(out));
+
+	/* The listing of /usr/local is in the cache. */
+	if (uniqueize_join(entry, sizeof(entry), base, "/usr/local") == -1) {
+		uniqueize_teardown(base);
+		return (0);
+	}
+	stat(entry, &sb);
+	snprintf(name, sizeof(name), "dir-%llx-%llx",
+	    (unsigned long long)sb.st_dev, (unsigned long long)sb.st_ino);
+	cache_path(name, entry, sizeof(entry));
+	cached = (stat(entry, &sb) == 0);
+
+	/* A new sibling changes the modification time. */
+	uniqueize_mkdir(base, "/usr/local/shared");
+	if (uniqueize_join(entry, sizeof(entry), base, "/usr/local") == -1) {
+		uniqueize_teardown(base);
+		return (0);
+	}
+	utimes(entry, NULL);
+	path_uniqueize(out, &pi, cwd, sizeof(out));
+	uniqueize_teardown(base);
+
+	return (
+	    assert_int_equals(cached, 1) &&
+	    assert_string_equals(out, "$root/lo/share/doc")
+	);
+}
@@ -17,35 +17,35 @@
 static int
 test_cmd_path_exec__path_n(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"path -n";
-	wchar_t buf[MAX_OUTPUT_LEN];
+	char input[MAX_OUTPUT_LEN] = "path -n";
+	char buf[MAX_OUTPUT_LEN];
 	struct arglist al;
 
-	wcslcpy(path_wcswd_fakepwd, L"/usr/local/bin", MAXPATHLEN);
+	strlcpy(path_cwd_fakepwd, "/usr/local/bin", MAXPATHLEN);
 
 	alias_purge_all();
 
 	template_arglist_init(&al);
-	template_variable_lexer(input, &al, &errstr);
+	template_variable_lexer(input, strlen(input), &al, &errstr);
 	cmd_path_exec(al.argc, al.argv, buf, MAX_OUTPUT_LEN);
 
-	return (assert_wstring_equals(buf, L"/u/l/bin"));
+	return (assert_string_equals(buf, "/u/l/bin"));
 }
 
 static int
 test_cmd_path_exec__path(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"path";
-	wchar_t out[MAX_OUTPUT_LEN];
+	char input[MAX_OUTPUT_LEN] = "path";
+	char out[MAX_OUTPUT_LEN];
 	struct arglist al;
 
-	wcslcpy(path_wcswd_fakepwd, L"/usr/local/bin", MAXPATHLEN);
+	strlcpy(path_cwd_fakepwd, "/usr/local/bin", MAXPATHLEN);
 
 	alias_purge_all();
 
 	template_arglist_init(&al);
-	template_variable_lexer(input, &al, &errstr);
+	template_variable_lexer(input, strlen(input), &al, &errstr);
 	cmd_path_exec(al.argc, al.argv, out, MAX_OUTPUT_LEN);
 
-	return (assert_wstring_equals(out, L"/usr/local/bin"));
+	return (assert_string_equals(out, "/usr/local/bin"));
 }
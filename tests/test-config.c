@@ -17,23 +17,31 @@
 static int
 test_config__process_config_line__set_no_var(void)
 {
-	wchar_t line[] = L"set";
+	char line[] = "set";
 	process_config_line(line, &errstr);
-	return (assert_wstring_equals(errstr, L"set without variable name"));
+	return (assert_string_equals(errstr, "set without variable name"));
 }
 
 static int
 test_config__process_config_line__alias_no_name(void)
 {
-	wchar_t line[] = L"alias";
+	char line[] = "alias";
 	process_config_line(line, &errstr);
-	return (assert_wstring_equals(errstr, L"alias without name"));
+	return (assert_string_equals(errstr, "alias without name"));
+}
+
+static int
+test_config__process_config_line__alias_no_path(void)
+{
+	char line[] = "alias foo";
+	process_config_line(line, &errstr);
+	return (assert_string_equals(errstr, "alias without path"));
 }
 
 static int
 test_config__process_config_line__just_spaces(void)
 {
-	wchar_t line[] = L"        ";
+	char line[] = "        ";
 	process_config_line(line, &errstr);
 	return (assert_null(errstr));
 }
@@ -41,7 +49,7 @@ test_config__process_config_line__just_spaces(void)
 static int
 test_config__process_config_line__comments(void)
 {
-	wchar_t line[] = L"# comments";
+	char line[] = "# comments";
 	process_config_line(line, &errstr);
 	return (assert_null(errstr));
 }
@@ -49,7 +57,7 @@ test_config__process_config_line__comments(void)
 static int
 test_config__process_config_line__set_maxlength_250(void)
 {
-	wchar_t line[] = L"set maxlength 250";
+	char line[] = "set maxlength 250";
 	process_config_line(line, &errstr);
 	return (assert_null(errstr) &&
 	    assert_int_equals(cfg_maxpwdlen, 250));
@@ -58,28 +66,59 @@ test_config__process_config_line__set_maxlength_250(void)
 static int
 test_config__process_config_line__set_maxlength_bad(void)
 {
-	wchar_t line[] = L"set maxlength $F@#$";
+	char line[] = "set maxlength $F@#$";
 	process_config_line(line, &errstr);
-	return (assert_wstring_equals(errstr,
-	    L"invalid number for set maxlength"));
+	return (assert_string_equals(errstr,
+	    "invalid number for set maxlength"));
 }
 
 static int
 test_config__process_config_line__set_maxlength_overflow(void)
 {
-	wchar_t line[] = L"set maxlength 5000";
+	char line[] = "set maxlength 5000";
 	process_config_line(line, &errstr);
-	return (assert_wstring_equals(errstr,
-	    L"invalid number for set maxlength"));
+	return (assert_string_equals(errstr,
+	    "invalid number for set maxlength"));
 }
 
 static int
 test_config__process_config_line__set_maxlength_quoted(void)
 {
-	wchar_t line[] = L"set maxlength \"50\"";
+	char line[] = "set maxlength \"50\"";
 	process_config_line(line, &errstr);
 	return (
 	    assert_null(errstr) &&
 	    assert_int_equals(cfg_maxpwdlen, 50)
 	);
 }
+
+static int
+test_config__process_config_line__rtemplate(void)
+{
+	char line[] = "rtemplate \"${branch}\"";
+	process_config_line(line, &errstr);
+	return (
+	    assert_null(errstr) &&
+	    assert_string_equals(cfg_rtemplate, "${branch}")
+	);
+}
+
+static int
+test_config__process_config_line__title_twice(void)
+{
+	char line1[] = "title \"${path}\"";
+	char line2[] = "title \"${path}\"";
+	process_config_line(line1, &errstr);
+	process_config_line(line2, &errstr);
+	return (assert_string_equals(errstr, "template is already defined"));
+}
+
+static int
+test_config__process_config_line__template_bad_arg(void)
+{
+	char line[] = "template \"${path -l 999}\"";
+	process_config_line(line, &errstr);
+	return (
+	    assert_string_equals(errstr, "<path-bad-arg> in ${path -l 999}")
+	);
+}
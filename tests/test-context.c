@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+extern char home[MAXPATHLEN];
+
+/*
+ * Feed a configuration made of several lines to process_config_line, stops at
+ * the first error.
+ */
+static void
+context_config(const char **lines)
+{
+	char line[MAX_OUTPUT_LEN];
+
+	for (; *lines != NULL; lines++) {
+		strlcpy(line, *lines, sizeof(line));
+		process_config_line(line, &errstr);
+		if (errstr != NULL)
+			return;
+	}
+}
+
+static int
+test_context__first_match_wins(void)
+{
+	const struct context *ctx;
+	const char *lines[] = {
+		"context lab {",
+		"    hostname lab*",
+		"    template \"lab\"",
+		"}",
+		"context other {",
+		"    hostname *.example.com",
+		"    template \"example\"",
+		"}",
+		"context any {",
+		"    template \"any\"",
+		"}",
+		NULL
+	};
+
+	strlcpy(test_hostname_value, "foo.example.com", MAXHOSTNAMELEN);
+	context_config(lines);
+	ctx = context_select();
+
+	return (assert_null(errstr) &&
+	    assert_string_equals(ctx->name, "other") &&
+	    assert_string_equals(ctx->template, "example"));
+}
+
+static int
+test_context__no_match(void)
+{
+	const char *lines[] = {
+		"context lab {",
+		"    hostname lab*",
+		"    template \"lab\"",
+		"}",
+		NULL
+	};
+
+	strlcpy(test_hostname_value, "foo.example.com", MAXHOSTNAMELEN);
+	context_config(lines);
+
+	return (assert_null(errstr) && assert_null(context_select()));
+}
+
+static int
+test_context__all_conditions(void)
+{
+	const struct context *ctx;
+	char uid[32];
+	const char *lines[] = {
+		"context home {",
+		"    path ~/src/*",
+		uid,
+		"    hostname foo",
+		"    template \"home\"",
+		"}",
+		NULL
+	};
+
+	snprintf(uid, sizeof(uid), "uid %u", (unsigned)getuid());
+	strlcpy(home, "/home/foo", MAXPATHLEN);
+	strlcpy(path_cwd_fakepwd, "/home/foo/src/prwd", MAXPATHLEN);
+	strlcpy(test_hostname_value, "foo", MAXHOSTNAMELEN);
+	context_config(lines);
+	ctx = context_select();
+
+	return (assert_null(errstr) &&
+	    assert_string_equals(ctx->template, "home"));
+}
+
+/*
+ * The path is the most expensive condition, it is only looked up once the
+ * cheaper hostname condition matched.
+ */
+static int
+test_context__cheap_conditions_first(void)
+{
+	const char *lines[] = {
+		"context lab {",
+		"    path /tmp*",
+		"    hostname lab",
+		"    template \"lab\"",
+		"}",
+		NULL
+	};
+
+	strlcpy(test_hostname_value, "foo", MAXHOSTNAMELEN);
+	path_cwd_calls = 0;
+	context_config(lines);
+
+	return (assert_null(errstr) &&
+	    assert_null(context_select()) &&
+	    assert_int_equals(path_cwd_calls, 0));
+}
+
+static int
+test_context__time_range(void)
+{
+	const struct context *ctx;
+	char range[64];
+	struct tm *tm;
+	time_t now;
+	int from, to;
+	const char *lines[] = {
+		"context never {",
+		"    time 00:00-00:00",
+		"    template \"never\"",
+		"}",
+		"context now {",
+		range,
+		"    template \"now\"",
+		"}",
+		NULL
+	};
+
+	now = time(NULL);
+	tm = localtime(&now);
+	from = tm->tm_hour * 60 + tm->tm_min;
+	to = (from + 2) % (24 * 60);
+	snprintf(range, sizeof(range), "time %02d:%02d-%02d:%02d",
+	    from / 60, from % 60, to / 60, to % 60);
+	context_config(lines);
+	ctx = context_select();
+
+	return (assert_null(errstr) &&
+	    assert_string_equals(ctx->template, "now"));
+}
+
+static int
+test_context__vcs(void)
+{
+	const struct context *ctx;
+	const char *lines[] = {
+		"context norepo {",
+		"    vcs none",
+		"    template \"plain\"",
+		"}",
+		"context repo {",
+		"    vcs hg",
+		"    template \"hg\"",
+		"}",
+		NULL
+	};
+
+	/* Every file exists, .hg/branch is found first. */
+	test_file_exists = 1;
+	context_config(lines);
+	ctx = context_select();
+
+	return (assert_null(errstr) &&
+	    assert_string_equals(ctx->template, "hg"));
+}
+
+static int
+test_context__bad_time(void)
+{
+	const char *lines[] = {
+		"context night {",
+		"    time 22:00",
+		NULL
+	};
+
+	context_config(lines);
+
+	return (assert_string_equals(errstr,
+	    "invalid time range (HH:MM-HH:MM)"));
+}
+
+static int
+test_context__unknown_condition(void)
+{
+	const char *lines[] = {
+		"context night {",
+		"    moon full",
+		NULL
+	};
+
+	context_config(lines);
+
+	return (assert_string_equals(errstr, "unknown condition"));
+}
+
+static int
+test_context__nested(void)
+{
+	const char *lines[] = {
+		"context a {",
+		"    context b {",
+		NULL
+	};
+
+	context_config(lines);
+
+	return (assert_string_equals(errstr, "context inside a context"));
+}
+
+static int
+test_context__no_brace(void)
+{
+	const char *lines[] = {
+		"context a",
+		NULL
+	};
+
+	context_config(lines);
+
+	return (assert_string_equals(errstr, "context without {"));
+}
+
+/*
+ * Conditions rejected because their context is full don't use up the room of
+ * the other contexts.
+ */
+static int
+test_context__full_context_keeps_slots(void)
+{
+	char value[32];
+	int i;
+
+	context_open("full", &errstr);
+	for (i = 0; i < MAX_CONDITIONS; i++) {
+		snprintf(value, sizeof(value), "host%d", i);
+		context_add_condition("hostname", value, &errstr);
+	}
+	if (!assert_string_equals(errstr, "too many conditions in context"))
+		return (0);
+	context_close();
+
+	context_open("other", &errstr);
+	context_add_condition("hostname", "other", &errstr);
+	context_close();
+
+	return (assert_null(errstr));
+}
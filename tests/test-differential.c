@@ -0,0 +1,593 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Differential tests: the optimized code is run side by side with the most
+ * straightforward implementation of the same behavior (the "ref_" functions
+ * below) on randomized inputs, any divergence is reported with the input
+ * which caused it.  The inputs are the same on every run, set $DIFF_SEED to
+ * explore others.
+ */
+
+#define DIFF_ROUNDS 2000
+
+int _findr_target(char *, size_t, char *);
+int _findr_repository(char *, size_t);
+int _findr_readme(char *, size_t);
+
+static unsigned long diff_state;
+
+static void
+diff_seed(void)
+{
+	const char *s;
+
+	diff_state = 0x9e3779b97f4a7c15UL;
+	if ((s = getenv("DIFF_SEED")) != NULL)
+		diff_state ^= strtoul(s, NULL, 10);
+}
+
+static unsigned long
+diff_rand(unsigned long n)
+{
+	/* xorshift64 */
+	diff_state ^= diff_state << 13;
+	diff_state ^= diff_state >> 7;
+	diff_state ^= diff_state << 17;
+	return (diff_state % n);
+}
+
+/*
+ * A random string made of the given pieces, up to 'count' of them.
+ */
+static void
+diff_string(char *buf, size_t len, const char **pieces, size_t npieces,
+    size_t count)
+{
+	size_t i, n;
+
+	buf[0] = '\0';
+	n = diff_rand(count + 1);
+	for (i = 0; i < n; i++) {
+		if (strlen(buf) + strlen(pieces[0]) + 16 >= len)
+			break;
+		strcat(buf, pieces[diff_rand(npieces)]);
+	}
+}
+
+static int
+diff_report(const char *what, const char *input, const char *value,
+    const char *expected)
+{
+	int n;
+
+	n = snprintf(details, sizeof(details),
+	    "    %s diverged on \"%s\":\n"
+	    "           value=\"%s\"\n"
+	    "        expected=\"%s\"", what, input, value, expected);
+	if (n < 0 || (size_t)n >= sizeof(details))
+		strlcpy(details + sizeof(details) - 4, "...", 4);
+	return (0);
+}
+
+/*
+ * Tokenize one character at a time: "${" opens a command closed by "}" or the
+ * end of the template, everything else is static, empty tokens are dropped.
+ * Each token is appended to out as "S[text]" or "C[text]".
+ */
+static void
+ref_tokenize(const char *tmpl, char *out, size_t len)
+{
+	char token[MAX_OUTPUT_LEN];
+	size_t n = 0, used = 0;
+	int command = 0, w;
+
+	out[0] = '\0';
+	for (;;) {
+		if (*tmpl == '\0' || (!command && tmpl[0] == '$' &&
+		    tmpl[1] == '{') || (command && *tmpl == '}')) {
+			token[n] = '\0';
+			if (n > 0) {
+				w = snprintf(out + used, len - used, "%c[%s]",
+				    command ? 'C' : 'S', token);
+				if (w < 0 || (size_t)w >= len - used)
+					return;
+				used += w;
+			}
+			n = 0;
+			if (*tmpl == '\0')
+				return;
+			if (command) {
+				command = 0;
+				tmpl++;
+			} else {
+				command = 1;
+				tmpl += 2;
+			}
+			continue;
+		}
+		token[n++] = *tmpl++;
+	}
+}
+
+static int
+test_differential__tokenize(void)
+{
+	const char *pieces[] = { "$", "{", "}", "${", "a", " ", "path -l 2",
+	    "\\", "\"" };
+	char tmpl[256], value[1024], expected[1024];
+	struct token tok;
+	size_t pos, i;
+
+	diff_seed();
+	for (i = 0; i < DIFF_ROUNDS; i++) {
+		diff_string(tmpl, sizeof(tmpl), pieces, 9, 24);
+
+		value[0] = '\0';
+		pos = 0;
+		while (template_tokenize(tmpl, &pos, &tok))
+			snprintf(value + strlen(value),
+			    sizeof(value) - strlen(value), "%c[%.*s]",
+			    tok.type == TOKEN_COMMAND ? 'C' : 'S',
+			    (int)tok.len, tmpl + tok.off);
+		ref_tokenize(tmpl, expected, sizeof(expected));
+
+		if (strcmp(value, expected) != 0)
+			return (diff_report("template_tokenize", tmpl, value,
+			    expected));
+	}
+
+	return (1);
+}
+
+static int
+test_differential__utf8_is_ascii(void)
+{
+	char buf[80], value[8], expected[8];
+	size_t i, j, off, len;
+	int ascii;
+
+	diff_seed();
+	for (i = 0; i < DIFF_ROUNDS; i++) {
+		for (j = 0; j < sizeof(buf); j++)
+			buf[j] = (char)(1 + diff_rand(0x7f));
+		if (diff_rand(2))
+			buf[diff_rand(sizeof(buf))] |= 0x80;
+		off = diff_rand(8);
+		len = diff_rand(sizeof(buf) - off);
+
+		ascii = 1;
+		for (j = off; j < off + len; j++)
+			if ((unsigned char)buf[j] >= 0x80)
+				ascii = 0;
+
+		snprintf(value, sizeof(value), "%d",
+		    utf8_is_ascii(buf + off, len));
+		snprintf(expected, sizeof(expected), "%d", ascii);
+		if (strcmp(value, expected) != 0)
+			return (diff_report("utf8_is_ascii", "(bytes)", value,
+			    expected));
+	}
+
+	return (1);
+}
+
+/*
+ * Walk the path from its start until column n, see path_index_skip().
+ */
+static const char *
+ref_skip(const char *path, size_t n)
+{
+	const char *c = path, *next;
+	uint32_t cp;
+	size_t col = 0;
+
+	while (*c != '\0' && col < n) {
+		c += utf8_decode(c, &cp);
+		col += utf8_cpwidth(cp);
+	}
+	while (*c != '\0') {
+		next = c + utf8_decode(c, &cp);
+		if (utf8_cpwidth(cp) != 0)
+			break;
+		c = next;
+	}
+
+	return (c);
+}
+
+static const char *diff_path_pieces[] = { "/", "/", "a", "usr", "b.c",
+    "日本", "e\xcc\x81", "~", "$p", "-" };
+
+static int
+test_differential__path_index_skip(void)
+{
+	char path[256], value[256], expected[256];
+	struct path_index pi;
+	size_t i, n;
+
+	diff_seed();
+	for (i = 0; i < DIFF_ROUNDS; i++) {
+		diff_string(path, sizeof(path), diff_path_pieces, 10, 20);
+		path_index_build(&pi, path);
+		n = diff_rand(utf8_width(path) + 2);
+
+		strlcpy(value, path_index_skip(&pi, n), sizeof(value));
+		strlcpy(expected, ref_skip(path, n), sizeof(expected));
+		if (strcmp(value, expected) != 0)
+			return (diff_report("path_index_skip", path, value,
+			    expected));
+	}
+
+	return (1);
+}
+
+/*
+ * The path shortening functions as they were before the path index, they
+ * count bytes, which are also the columns of ASCII paths.  The old
+ * newsgroupize repeated the slashes of empty components ("a//b" became
+ * "a///b") and cleancut could keep a lone trailing slash, these follow the
+ * path index instead.
+ */
+static void
+ref_quickcut(char *out, const char *path, size_t maxlen, const char *filler)
+{
+	size_t plen, offset;
+
+	plen = strlen(path);
+	if (plen <= maxlen) {
+		strlcpy(out, path, maxlen + 1);
+		return;
+	}
+
+	offset = strlcpy(out, filler, maxlen + 1);
+	if (offset >= maxlen)
+		return;
+
+	strlcpy(out + offset, path + plen - maxlen + offset,
+	    maxlen + 1 - offset);
+}
+
+static void
+ref_cleancut(char *out, const char *path, size_t maxlen, const char *filler)
+{
+	const char *c;
+	size_t flen;
+
+	if (strlen(path) <= maxlen) {
+		strlcpy(out, path, maxlen + 1);
+		return;
+	}
+
+	flen = strlcpy(out, filler, maxlen + 1);
+	if (flen >= maxlen)
+		return;
+
+	for (c = path; strlen(c) > maxlen - flen;) {
+		if (*c == '/')
+			c++;
+		if ((c = strchr(c, '/')) == NULL || c[1] == '\0') {
+			ref_quickcut(out, path, maxlen, filler);
+			return;
+		}
+	}
+
+	strlcpy(out + flen, c, maxlen + 1 - flen);
+}
+
+static void
+ref_newsgroupize(char *out, const char *path, size_t len)
+{
+	const char *last = NULL, *c = path;
+	size_t idx = 0;
+
+	if (*path != '/') {
+		do {
+			out[idx++] = *(c++);
+		} while (*c != '/' && *c != '\0');
+	}
+
+	if (*c == '\0') {
+		out[idx] = '\0';
+		return;
+	}
+
+	for (;;) {
+		out[idx++] = *(c++);
+		last = c;
+		if ((c = strchr(c, '/')) == NULL)
+			break;
+		if (*(c + 1) == '\0')
+			break;
+		/* Empty components ("//") are kept as they are. */
+		if (*last != '/')
+			out[idx++] = *last;
+	}
+
+	strlcpy(out + idx, last, len - idx);
+}
+
+static int
+test_differential__path_cut(void)
+{
+	const char *pieces[] = { "/", "/", "a", "usr", "local", "b.c", "~",
+	    "$p" };
+	const char *fillers[] = { "...", "", "~", "<-->" };
+	char path[256], value[256], expected[256], input[300];
+	struct path_index pi;
+	const char *filler;
+	size_t i, maxlen;
+
+	diff_seed();
+	for (i = 0; i < DIFF_ROUNDS; i++) {
+		diff_string(path, sizeof(path), pieces, 8, 16);
+		if (path[0] == '\0')
+			continue;
+		path_index_build(&pi, path);
+		maxlen = diff_rand(strlen(path) + 4);
+		filler = fillers[diff_rand(4)];
+		snprintf(input, sizeof(input), "%s\" -l %zu -f \"%s", path,
+		    maxlen, filler);
+
+		path_quickcut(value, &pi, sizeof(value), maxlen, filler);
+		ref_quickcut(expected, path, maxlen, filler);
+		if (strcmp(value, expected) != 0)
+			return (diff_report("path_quickcut", input, value,
+			    expected));
+
+		path_cleancut(value, &pi, sizeof(value), maxlen, filler);
+		ref_cleancut(expected, path, maxlen, filler);
+		if (strcmp(value, expected) != 0)
+			return (diff_report("path_cleancut", input, value,
+			    expected));
+
+		path_newsgroupize(value, &pi, sizeof(value));
+		ref_newsgroupize(expected, path, sizeof(expected));
+		if (strcmp(value, expected) != 0)
+			return (diff_report("path_newsgroupize", path, value,
+			    expected));
+	}
+
+	return (1);
+}
+
+static int
+test_differential__memo(void)
+{
+	const char *pieces[] = { "${path}", "${hostname}", "${path -l 6}",
+	    "${path -n}", "${uid}", " ", ":", "${sep}" };
+	char tmpl[256], value[MAX_OUTPUT_LEN], expected[MAX_OUTPUT_LEN];
+	size_t i;
+
+	strlcpy(path_cwd_fakepwd, "/usr/local/share/prwd", MAXPATHLEN);
+	strlcpy(test_hostname_value, "gobo.example.com", MAXHOSTNAMELEN);
+
+	diff_seed();
+	for (i = 0; i < DIFF_ROUNDS; i++) {
+		diff_string(tmpl, sizeof(tmpl), pieces, 8, 10);
+
+		/* The memoized outputs of the previous rounds are reused. */
+		if (template_render(tmpl, value, sizeof(value), &errstr) == -1)
+			return (0);
+
+		facts_purge_all();
+		template_memo_purge_all();
+		if (template_render(tmpl, expected, sizeof(expected),
+		    &errstr) == -1)
+			return (0);
+
+		if (strcmp(value, expected) != 0)
+			return (diff_report("template memo", tmpl, value,
+			    expected));
+	}
+
+	return (1);
+}
+
+/*
+ * Replace the longest alias path prefixing path with the alias name, over
+ * and over until nothing changes, see alias_replace_recursive().  The
+ * aliases are given as name and path pairs.
+ */
+static void
+ref_alias_replace(char *out, const char *path, size_t len,
+    char aliases[][2][32], size_t count)
+{
+	char buf[256];
+	size_t i, plen, best, bestlen;
+	int round;
+
+	strlcpy(out, path, len);
+	for (round = 0; round < 100; round++) {
+		best = count;
+		bestlen = 0;
+		for (i = 0; i < count; i++) {
+			plen = strlen(aliases[i][1]);
+			if (plen > bestlen &&
+			    strncmp(out, aliases[i][1], plen) == 0) {
+				best = i;
+				bestlen = plen;
+			}
+		}
+		if (best == count)
+			return;
+
+		strlcpy(buf, aliases[best][0], sizeof(buf));
+		strlcpy(buf + strlen(buf), out + bestlen,
+		    sizeof(buf) - strlen(buf));
+		if (strcmp(buf, out) == 0)
+			return;
+		strlcpy(out, buf, len);
+	}
+}
+
+static int
+test_differential__alias_replace(void)
+{
+	const char *pieces[] = { "/", "/", "usr", "local", "a", "~" };
+	const char *names[] = { "~", "$a", "$bb", "@", "~~" };
+	char aliases[8][2][32], path[256], value[256], expected[256];
+	size_t i, j, count;
+
+	diff_seed();
+	for (i = 0; i < DIFF_ROUNDS; i++) {
+		alias_purge_all();
+		count = 0;
+		for (j = diff_rand(8); j > 0; j--) {
+			strlcpy(aliases[count][0], names[diff_rand(5)], 32);
+			diff_string(aliases[count][1], 32, pieces, 6, 4);
+			alias_add(aliases[count][0], aliases[count][1],
+			    &errstr);
+			if (errstr == NULL)
+				count++;
+		}
+		diff_string(path, sizeof(path), pieces, 6, 12);
+
+		alias_replace_recursive(value, path, sizeof(value));
+		ref_alias_replace(expected, path, sizeof(expected), aliases,
+		    count);
+		if (strcmp(value, expected) != 0)
+			return (diff_report("alias_replace_recursive", path,
+			    value, expected));
+	}
+	alias_purge_all();
+
+	return (1);
+}
+
+/*
+ * Look for any of the files in dir and each of its parents up to the root,
+ * copy the first directory holding one on out.  Returns 0 if none does.
+ */
+static int
+ref_findr(const char *dir, const char **files, size_t nfiles, char *out,
+    size_t outlen)
+{
+	char path[MAXPATHLEN];
+	struct stat sb;
+	size_t i, len = strlen(dir);
+	int n;
+
+	for (;;) {
+		for (i = 0; i < nfiles; i++) {
+			n = snprintf(path, sizeof(path), "%.*s/%s", (int)len,
+			    dir, files[i]);
+			if (n < 0 || (size_t)n >= sizeof(path))
+				return (0);
+			if (stat(path, &sb) == 0) {
+				snprintf(out, outlen, "%.*s", (int)len, dir);
+				return (1);
+			}
+		}
+		if (len == 0)
+			return (0);
+		while (len > 0 && dir[len - 1] != '/')
+			len--;
+		if (len > 0)
+			len--;
+	}
+}
+
+static int
+findr_diff_rm(const char *path, const struct stat *sb, int flag,
+    struct FTW *ftw)
+{
+	(void)sb;
+	(void)flag;
+	(void)ftw;
+	return (remove(path));
+}
+
+/*
+ * The findr lookups, on random trees of real directories with the files they
+ * look for scattered in them.
+ */
+static int
+test_differential__findr(void)
+{
+	const char *dirs[] = { "a", "b", "src", ".x" };
+	const char *markers[] = { ".git", ".hg", "README", "README.md",
+	    "README.txt", "TARGET" };
+	const char *repository[] = { ".hg", ".git" };
+	const char *readme[] = { "README", "README.md", "README.txt" };
+	const char *target[] = { "TARGET" };
+	char base[MAXPATHLEN], dir[MAXPATHLEN], real[MAXPATHLEN];
+	char path[MAXPATHLEN], value[MAXPATHLEN], expected[MAXPATHLEN];
+	size_t i, depth, m, used;
+	int found, r = 1, n;
+	FILE *fp;
+
+	diff_seed();
+	test_file_exists = -1;
+	for (i = 0; i < DIFF_ROUNDS / 20 && r; i++) {
+		strlcpy(base, "/tmp/prwd-test-XXXXXX", sizeof(base));
+		if (mkdtemp(base) == NULL) {
+			r = 0;
+			break;
+		}
+
+		used = strlcpy(dir, base, sizeof(dir));
+		for (depth = diff_rand(6); ; depth--) {
+			for (m = 0; m < 6; m++) {
+				if (diff_rand(8) != 0)
+					continue;
+				n = snprintf(path, sizeof(path), "%s/%s", dir,
+				    markers[m]);
+				if (n > 0 && (size_t)n < sizeof(path) &&
+				    (fp = fopen(path, "w")) != NULL)
+					fclose(fp);
+			}
+			if (depth == 0)
+				break;
+			n = snprintf(dir + used, sizeof(dir) - used, "/%s",
+			    dirs[diff_rand(4)]);
+			if (n < 0 || (size_t)n >= sizeof(dir) - used)
+				break;
+			used += n;
+			mkdir(dir, 0700);
+		}
+
+		facts_purge_all();
+		strlcpy(path_cwd_fakepwd, dir, MAXPATHLEN);
+		if (realpath(dir, real) == NULL)
+			strlcpy(real, dir, sizeof(real));
+
+		value[0] = expected[0] = '\0';
+		found = _findr_repository(value, sizeof(value));
+		if (found != ref_findr(real, repository, 2, expected,
+		    sizeof(expected)) || strcmp(value, expected) != 0)
+			r = diff_report("_findr_repository", dir, value,
+			    expected);
+
+		value[0] = expected[0] = '\0';
+		found = _findr_readme(value, sizeof(value));
+		if (r && (found != ref_findr(real, readme, 3, expected,
+		    sizeof(expected)) || strcmp(value, expected) != 0))
+			r = diff_report("_findr_readme", dir, value, expected);
+
+		value[0] = expected[0] = '\0';
+		found = _findr_target(value, sizeof(value), "TARGET");
+		if (r && (found != ref_findr(real, target, 1, expected,
+		    sizeof(expected)) || strcmp(value, expected) != 0))
+			r = diff_report("_findr_target", dir, value, expected);
+
+		nftw(base, findr_diff_rm, 8, FTW_DEPTH | FTW_PHYS);
+	}
+	test_file_exists = 1;
+	strlcpy(path_cwd_fakepwd, "/tmp", MAXPATHLEN);
+
+	return (r);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+static int
+test_facts__hostname_computed_once(void)
+{
+	const char *a, *b;
+
+	strlcpy(test_hostname_value, "first.example.com", MAXHOSTNAMELEN);
+	a = fact_hostname();
+	strlcpy(test_hostname_value, "second.example.com", MAXHOSTNAMELEN);
+	b = fact_hostname();
+
+	return (
+	    assert_string_equals(a, "first.example.com") &&
+	    assert_string_equals(b, "first.example.com")
+	);
+}
+
+static int
+test_facts__cwd_computed_once(void)
+{
+	const char *cwd;
+
+	strlcpy(path_cwd_fakepwd, "/usr/local", MAXPATHLEN);
+	cwd = fact_cwd(&errstr);
+	strlcpy(path_cwd_fakepwd, "/usr/src", MAXPATHLEN);
+	cwd = fact_cwd(&errstr);
+
+	return (
+	    assert_null(errstr) &&
+	    assert_string_equals(cwd, "/usr/local")
+	);
+}
+
+static int
+test_facts__purge_all(void)
+{
+	const char *hostname;
+
+	strlcpy(test_hostname_value, "first.example.com", MAXHOSTNAMELEN);
+	fact_hostname();
+	facts_purge_all();
+	strlcpy(test_hostname_value, "second.example.com", MAXHOSTNAMELEN);
+	hostname = fact_hostname();
+
+	return (assert_string_equals(hostname, "second.example.com"));
+}
+
+static int
+test_facts__columns_from_env(void)
+{
+	size_t columns;
+
+	setenv("COLUMNS", "123", 1);
+	columns = fact_columns();
+	unsetenv("COLUMNS");
+
+	return (assert_size_t_equals(columns, 123));
+}
+
+/*
+ * Every fact has a name and the -D report has room for all of them.
+ */
+static int
+test_facts__evaluated_all(void)
+{
+	const char **names, *e1, *e2;
+	size_t count, i, j;
+
+	strlcpy(test_hostname_value, "foo.example.com", MAXHOSTNAMELEN);
+	fact_cwd(&e1);
+	fact_cwd_physical(&e1);
+	fact_fqdn();
+	fact_user();
+	fact_vcs(&e1, &e2);
+	fact_colors();
+	fact_columns();
+	names = facts_evaluated(&count);
+
+	if (!assert_size_t_equals(count, FACT_COUNT))
+		return (0);
+	for (i = 0; i < count; i++) {
+		if (names[i] == NULL)
+			return (0);
+		for (j = 0; j < i; j++)
+			if (strcmp(names[i], names[j]) == 0)
+				return (0);
+	}
+
+	return (1);
+}
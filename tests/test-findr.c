@@ -26,9 +26,7 @@ int _findr_readme(char *, size_t);
 static int
 test_findr__target(void)
 {
-	char path[MAXPATHLEN], cwd[MAXPATHLEN];
-
-	getcwd(cwd, MAXPATHLEN);
+	char path[MAXPATHLEN], *cwd = path_cwd_fakepwd;
 
 	int ret = _findr_target(path, MAXPATHLEN, "FOO.BAR.txt");
 	return (
@@ -39,9 +37,7 @@ test_findr__target(void)
 static int
 test_findr__repository(void)
 {
-	char path[MAXPATHLEN], cwd[MAXPATHLEN];
-
-	getcwd(cwd, MAXPATHLEN);
+	char path[MAXPATHLEN], *cwd = path_cwd_fakepwd;
 
 	int ret = _findr_repository(path, MAXPATHLEN);
 	return (
@@ -52,12 +48,56 @@ test_findr__repository(void)
 static int
 test_findr__readme(void)
 {
-	char path[MAXPATHLEN], cwd[MAXPATHLEN];
-
-	getcwd(cwd, MAXPATHLEN);
+	char path[MAXPATHLEN], *cwd = path_cwd_fakepwd;
 
 	int ret = _findr_readme(path, MAXPATHLEN);
 	return (
 	    assert_int_equals(ret, 1) && assert_string_equals(path, cwd)
 	);
 }
+
+static int
+findr_rm(const char *path, const struct stat *sb, int flag, struct FTW *ftw)
+{
+	(void)sb;
+	(void)flag;
+	(void)ftw;
+	return (remove(path));
+}
+
+/*
+ * The search walks up from the physical current directory: when the shell is
+ * in a symlink to a directory within a repository, the parents of the symlink
+ * are not the repository's.
+ */
+static int
+test_findr__repository_through_symlink(void)
+{
+	char base[MAXPATHLEN] = "/tmp/prwd-test-XXXXXX";
+	char sub[MAXPATHLEN], link[MAXPATHLEN], expected[MAXPATHLEN];
+	char path[MAXPATHLEN] = "";
+	int ret;
+
+	if (mkdtemp(base) == NULL)
+		return (0);
+	snprintf(sub, MAXPATHLEN, "%s/r", base);
+	mkdir(sub, 0700);
+	snprintf(sub, MAXPATHLEN, "%s/r/sub", base);
+	mkdir(sub, 0700);
+	snprintf(link, MAXPATHLEN, "%s/h", base);
+	mkdir(link, 0700);
+	snprintf(link, MAXPATHLEN, "%s/h/link", base);
+	symlink(sub, link);
+	if (realpath(sub, expected) == NULL)
+		expected[0] = '\0';
+
+	strlcpy(path_cwd_fakepwd, link, MAXPATHLEN);
+	ret = _findr_repository(path, MAXPATHLEN);
+
+	nftw(base, findr_rm, 8, FTW_DEPTH | FTW_PHYS);
+	strlcpy(path_cwd_fakepwd, "/tmp", MAXPATHLEN);
+
+	return (
+	    assert_int_equals(ret, 1) && assert_string_equals(path, expected)
+	);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Read back at most len - 1 bytes written on the pipe.
+ */
+static void
+output_read_pipe(int fd, char *buf, size_t len)
+{
+	ssize_t n;
+
+	n = read(fd, buf, len - 1);
+	buf[n < 0 ? 0 : n] = '\0';
+}
+
+static int
+test_output__segments_in_order(void)
+{
+	struct output o;
+	char buf[MAX_OUTPUT_LEN], *c;
+	size_t len;
+	int fds[2];
+
+	if (pipe(fds) == -1)
+		return (0);
+
+	output_init(&o, fds[1]);
+	output_append(&o, "foo ", 4);
+	c = output_reserve(&o, &len);
+	strlcpy(c, "bar", len);
+	output_commit(&o, 3);
+	output_append(&o, " baz", 4);
+	output_flush(&o);
+	output_read_pipe(fds[0], buf, sizeof(buf));
+	close(fds[0]);
+	close(fds[1]);
+
+	return (assert_string_equals(buf, "foo bar baz"));
+}
+
+static int
+test_output__flush_when_full(void)
+{
+	struct output o;
+	char buf[MAX_OUTPUT_LEN];
+	int fds[2], i;
+
+	if (pipe(fds) == -1)
+		return (0);
+
+	output_init(&o, fds[1]);
+	for (i = 0; i < MAX_OUTPUT_SEGMENTS * 2 + 1; i++)
+		output_append(&o, "ab", 2);
+	output_flush(&o);
+	output_read_pipe(fds[0], buf, sizeof(buf));
+	close(fds[0]);
+	close(fds[1]);
+
+	return (
+	    assert_int_equals(o.iovcnt, 0) &&
+	    assert_int_equals(strlen(buf), (MAX_OUTPUT_SEGMENTS * 2 + 1) * 2)
+	);
+}
+
+static int
+test_output__render_longer_than_max_output(void)
+{
+	struct output o;
+	char input[MAX_OUTPUT_LEN * 2], buf[MAX_OUTPUT_LEN * 4];
+	int fds[2], i;
+
+	if (pipe(fds) == -1)
+		return (0);
+
+	/* Twice the size the buffered renderer accepts. */
+	memset(input, 'x', sizeof(input) - 8);
+	strlcpy(input + sizeof(input) - 8, "${uid}", 8);
+
+	output_init(&o, fds[1]);
+	i = template_render_output(input, &o, &errstr);
+	output_flush(&o);
+	output_read_pipe(fds[0], buf, sizeof(buf));
+	close(fds[0]);
+	close(fds[1]);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_null(errstr) &&
+	    assert_int_equals(strlen(buf), sizeof(input) - 8 + 1)
+	);
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+static int
+test_shell__format__sh(void)
+{
+	char out[MAX_OUTPUT_LEN];
+
+	shell_format(SHELL_SH, "template", "it's 100%", out, MAX_OUTPUT_LEN);
+
+	return (assert_string_equals(out, "PRWD_PROMPT='it'\\''s 100%'"));
+}
+
+static int
+test_shell__format__zsh(void)
+{
+	char out[MAX_OUTPUT_LEN];
+
+	shell_format(SHELL_ZSH, "rtemplate", "it's 100%", out,
+	    MAX_OUTPUT_LEN);
+
+	return (assert_string_equals(out, "RPROMPT='it'\\''s 100%%'"));
+}
+
+static int
+test_shell__format__fish(void)
+{
+	char out[MAX_OUTPUT_LEN];
+
+	shell_format(SHELL_FISH, "template", "it's C:\\", out,
+	    MAX_OUTPUT_LEN);
+
+	return (assert_string_equals(out,
+	    "set -g PRWD_PROMPT 'it\\'s C:\\\\'"));
+}
+
+static int
+test_shell__format__title(void)
+{
+	char out[MAX_OUTPUT_LEN];
+
+	shell_format(SHELL_ZSH, "title", "100%", out, MAX_OUTPUT_LEN);
+
+	return (assert_string_equals(out,
+	    "printf '\\033]0;%s\\007' '100%'"));
+}
+
+static int
+test_shell__format__too_short(void)
+{
+	char out[8];
+	size_t len;
+
+	len = shell_format(SHELL_SH, "template", "foo", out, 8);
+
+	return (assert_size_t_equals(len, (size_t)-1));
+}
+
+static int
+test_shell__from_name__unknown(void)
+{
+	enum shell_dialect dialect;
+
+	return (assert_int_equals(shell_from_name("tcsh", &dialect), -1));
+}
+
+static int
+test_shell__format__zsh_markers(void)
+{
+	char out[MAX_OUTPUT_LEN];
+
+	shell_format(SHELL_ZSH, "template", "\001\033[31m\002%", out,
+	    MAX_OUTPUT_LEN);
+
+	return (assert_string_equals(out, "PROMPT='%{\033[31m%}%%'"));
+}
+
+static int
+test_shell__format__title_markers(void)
+{
+	char out[MAX_OUTPUT_LEN];
+
+	shell_format(SHELL_SH, "title", "\001\033[31m\002x", out,
+	    MAX_OUTPUT_LEN);
+
+	return (assert_string_equals(out,
+	    "printf '\\033]0;%s\\007' '\033[31mx'"));
+}
+
+static int
+test_shell__width__escapes(void)
+{
+	const char *color = "\033[1;31mfoo\033[0;0m";
+	const char *title = "\033]0;title\007ab";
+	const char *wide = "\xe6\x97\xa5\001x\002";
+
+	return (
+	    assert_size_t_equals(shell_width(color, strlen(color)), 3) &&
+	    assert_size_t_equals(shell_width(title, strlen(title)), 2) &&
+	    assert_size_t_equals(shell_width(wide, strlen(wide)), 3)
+	);
+}
+
+static int
+test_shell__width__span(void)
+{
+	return (assert_size_t_equals(shell_width("\033[31mfoo\033[0m", 6), 1));
+}
+
+static int
+test_shell__width__zsh_markers(void)
+{
+	const char *s = "%{#%}ab%{";
+
+	shell_init(SHELL_ZSH, 0);
+
+	return (assert_size_t_equals(shell_width(s, strlen(s)), 2));
+}
+
+/*
+ * The escape sequences of the color command are marked when it is parsed.
+ */
+static int
+test_shell__color_bash(void)
+{
+	char output[MAX_OUTPUT_LEN];
+
+	shell_init(SHELL_BASH, 0);
+	setenv("TERM", "xterm", 1);
+	template_compile("${color red}$", &errstr);
+	template_render("${color red}$", output, MAX_OUTPUT_LEN, &errstr);
+
+	return (
+	    assert_string_equals(output, "\001\033[31m\002$") &&
+	    assert_size_t_equals(shell_width(output, strlen(output)), 1)
+	);
+}
+
+static int
+test_shell__color_zsh(void)
+{
+	char output[MAX_OUTPUT_LEN];
+
+	shell_init(SHELL_ZSH, 0);
+	setenv("TERM", "xterm", 1);
+	template_render("${color reset}", output, MAX_OUTPUT_LEN, &errstr);
+
+	return (assert_string_equals(output, "%{\033[0;0m%}"));
+}
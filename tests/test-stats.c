@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+static int
+stats_rm(const char *path, const struct stat *sb, int flag, struct FTW *ftw)
+{
+	(void)sb;
+	(void)flag;
+	(void)ftw;
+	return (remove(path));
+}
+
+/*
+ * Open fresh histograms in a temporary cache directory.
+ */
+static int
+stats_setup(char *base)
+{
+	if (mkdtemp(base) == NULL)
+		return (-1);
+	setenv("XDG_RUNTIME_DIR", base, 1);
+
+	return (stats_open());
+}
+
+static void
+stats_teardown(char *base)
+{
+	stats_close();
+	nftw(base, stats_rm, 8, FTW_DEPTH | FTW_PHYS);
+}
+
+static int
+test_stats__percentiles(void)
+{
+	char base[MAXPATHLEN] = "/tmp/prwd-test-XXXXXX";
+	struct stats_summary s;
+	int i, r;
+
+	if (stats_setup(base) == -1)
+		return (0);
+	for (i = 1; i <= 1000; i++)
+		stats_record("render", i);
+	r = stats_summary("render", &s);
+	stats_teardown(base);
+
+	return (
+	    assert_int_equals(r, 0) &&
+	    assert_size_t_equals(s.count, 1000) &&
+	    assert_size_t_equals(s.p50, 511) &&
+	    assert_size_t_equals(s.p99, 991) &&
+	    assert_size_t_equals(s.p999, 1023) &&
+	    assert_size_t_equals(s.max, 1000)
+	);
+}
+
+static int
+test_stats__exact_small_values(void)
+{
+	char base[MAXPATHLEN] = "/tmp/prwd-test-XXXXXX";
+	struct stats_summary s;
+	int i;
+
+	if (stats_setup(base) == -1)
+		return (0);
+	for (i = 0; i < 5; i++)
+		stats_record("${uid}", 3);
+	stats_record("${uid}", 17);
+	stats_summary("${uid}", &s);
+	stats_teardown(base);
+
+	return (
+	    assert_size_t_equals(s.count, 6) &&
+	    assert_size_t_equals(s.p50, 3) &&
+	    assert_size_t_equals(s.p999, 17)
+	);
+}
+
+static int
+test_stats__clamp(void)
+{
+	char base[MAXPATHLEN] = "/tmp/prwd-test-XXXXXX";
+	struct stats_summary s;
+
+	if (stats_setup(base) == -1)
+		return (0);
+	stats_record("slow", 1LL << 40);
+	stats_record("slow", -5);
+	stats_summary("slow", &s);
+	stats_teardown(base);
+
+	return (
+	    assert_size_t_equals(s.p50, 0) &&
+	    assert_size_t_equals(s.p999, UINT32_MAX) &&
+	    assert_size_t_equals(s.max, UINT32_MAX)
+	);
+}
+
+/*
+ * The histograms outlive the process which recorded them.
+ */
+static int
+test_stats__shared(void)
+{
+	char base[MAXPATHLEN] = "/tmp/prwd-test-XXXXXX";
+	struct stats_summary s;
+	int r;
+
+	if (stats_setup(base) == -1)
+		return (0);
+	stats_record("total", 100);
+	stats_close();
+	r = stats_open();
+	stats_record("total", 200);
+	stats_summary("total", &s);
+	stats_teardown(base);
+
+	return (
+	    assert_int_equals(r, 0) &&
+	    assert_size_t_equals(s.count, 2) &&
+	    assert_size_t_equals(s.max, 200)
+	);
+}
+
+static int
+test_stats__unknown(void)
+{
+	char base[MAXPATHLEN] = "/tmp/prwd-test-XXXXXX";
+	struct stats_summary s;
+	int r;
+
+	if (stats_setup(base) == -1)
+		return (0);
+	r = stats_summary("nothing", &s);
+	stats_teardown(base);
+
+	return (assert_int_equals(r, -1));
+}
+
+/*
+ * Spans are timed without -T when the statistics are enabled.
+ */
+static int
+test_stats__trace_spans(void)
+{
+	char base[MAXPATHLEN] = "/tmp/prwd-test-XXXXXX";
+	struct stats_summary s;
+	int span, r;
+
+	if (stats_setup(base) == -1)
+		return (0);
+	span = trace_begin("${path}", 7);
+	trace_end(span);
+	r = stats_summary("${path}", &s);
+	stats_teardown(base);
+
+	return (
+	    assert_int_equals(span >= 0, 1) &&
+	    assert_int_equals(r, 0) &&
+	    assert_size_t_equals(s.count, 1)
+	);
+}
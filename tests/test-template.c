@@ -17,114 +17,143 @@
 static int
 test_template_tokenize__empty(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"";
-	struct token tokens[10];
+	char input[MAX_OUTPUT_LEN] = "";
+	struct token tok;
+	size_t pos = 0;
 	int i;
 
-	i = template_tokenize(input, tokens, 10, &errstr);
+	i = template_tokenize(input, &pos, &tok);
 
 	return (
 	    assert_int_equals(i, 0) &&
-	    assert_null(errstr)
+	    assert_int_equals(pos, 0)
 	);
 }
 
 static int
 test_template_tokenize__one_static(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo";
-	struct token tokens[10];
+	char input[MAX_OUTPUT_LEN] = "foo";
+	struct token tok;
+	size_t pos = 0;
 	int i;
 
-	i = template_tokenize(input, tokens, 10, &errstr);
+	i = template_tokenize(input, &pos, &tok);
 
 	return (
 	    assert_int_equals(i, 1) &&
-	    assert_wstring_equals(tokens[0].value, L"foo") &&
-	    assert_int_equals(tokens[0].type, TOKEN_STATIC) &&
-	    assert_null(errstr)
+	    assert_int_equals(tok.off, 0) &&
+	    assert_int_equals(tok.len, 3) &&
+	    assert_int_equals(tok.type, TOKEN_STATIC) &&
+	    assert_int_equals(template_tokenize(input, &pos, &tok), 0)
 	);
 }
 
 static int
 test_template_tokenize__one_command(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"${bar}";
-	struct token tokens[10];
+	char input[MAX_OUTPUT_LEN] = "${bar}";
+	struct token tok;
+	size_t pos = 0;
 	int i;
 
-	i = template_tokenize(input, tokens, 10, &errstr);
+	i = template_tokenize(input, &pos, &tok);
 
 	return (
 	    assert_int_equals(i, 1) &&
-	    assert_wstring_equals(tokens[0].value, L"bar") &&
-	    assert_int_equals(tokens[0].type, TOKEN_COMMAND) &&
-	    assert_null(errstr)
+	    assert_int_equals(tok.off, 2) &&
+	    assert_int_equals(tok.len, 3) &&
+	    assert_int_equals(tok.type, TOKEN_COMMAND) &&
+	    assert_int_equals(template_tokenize(input, &pos, &tok), 0)
 	);
 }
 
 static int
 test_template_tokenize__complex(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo ${bar} and fooba${r}";
-	struct token tokens[10];
-	int i;
-
-	i = template_tokenize(input, tokens, 10, &errstr);
+	char input[MAX_OUTPUT_LEN] = "foo ${bar} and $fooba${r}${}";
+	char output[MAX_OUTPUT_LEN] = "";
+	struct token tok;
+	size_t pos = 0;
+	int i = 0;
+
+	while (template_tokenize(input, &pos, &tok)) {
+		snprintf(output + strlen(output), MAX_OUTPUT_LEN -
+		    strlen(output), "%d[%.*s]", tok.type, (int)tok.len,
+		    input + tok.off);
+		i++;
+	}
 
 	return (
 	    assert_int_equals(i, 4) &&
-	    assert_wstring_equals(tokens[0].value, L"foo ") &&
-	    assert_wstring_equals(tokens[1].value, L"bar") &&
-	    assert_wstring_equals(tokens[2].value, L" and fooba") &&
-	    assert_wstring_equals(tokens[3].value, L"r") &&
-	    assert_int_equals(tokens[0].type, TOKEN_STATIC) &&
-	    assert_int_equals(tokens[1].type, TOKEN_COMMAND) &&
-	    assert_int_equals(tokens[2].type, TOKEN_STATIC) &&
-	    assert_int_equals(tokens[3].type, TOKEN_COMMAND) &&
-	    assert_null(errstr)
+	    assert_string_equals(output, "0[foo ]1[bar]0[ and $fooba]1[r]")
 	);
 }
 
 static int
-test_template_tokenize__too_many_tokens(void)
+test_template_tokenize__unterminated_command(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo ${bar} and fooba${r}";
-	struct token tokens[2];
+	char input[MAX_OUTPUT_LEN] = "foo ${bar";
+	struct token tok;
+	size_t pos = 4;
 	int i;
 
-	i = template_tokenize(input, tokens, 2, &errstr);
+	i = template_tokenize(input, &pos, &tok);
 
 	return (
-	    assert_int_equals(i, -1) &&
-	    assert_wstring_equals(errstr, L"too many tokens")
+	    assert_int_equals(i, 1) &&
+	    assert_int_equals(tok.type, TOKEN_COMMAND) &&
+	    assert_int_equals(tok.len, 3) &&
+	    assert_int_equals(pos, 9)
 	);
 }
 
 static int
-test_template_tokenize__token_too_long(void)
+test_template_render__many_long_tokens(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foobarfoobarfoobarfoobarfoobar"\
-					L"foobarfoobarfoobarfoobarfoobar"\
-					L"foobarfoobarfoobarfoobarfoobar"\
-					L"foobarfoobarfoobarfoobarfoobar"\
-					L"foobarfoobarfoobarfoobarfoobar";
-	struct token tokens[2];
-	int i;
+	char input[MAX_OUTPUT_LEN], *c;
+	char output[MAX_OUTPUT_LEN];
+	size_t i;
+	int r;
+
+	/* 100 tokens, well past the limits of the old tokenizer. */
+	c = input;
+	for (i = 0; i < 50; i++)
+		c += sprintf(c, "${uid}");
+	memset(c, 'x', 300);
+	c += 300;
+	for (i = 0; i < 49; i++)
+		c += sprintf(c, "${uid}-");
 
-	i = template_tokenize(input, tokens, 2, &errstr);
+	r = template_render(input, output, MAX_OUTPUT_LEN, &errstr);
 
 	return (
-	    assert_int_equals(i, -1) &&
-	    assert_wstring_equals(errstr, L"invalid token size")
+	    assert_int_equals(r, 0) &&
+	    assert_null(errstr) &&
+	    assert_int_equals(strlen(output), 50 + 300 + 49 * 2)
+	);
+}
+
+static int
+test_template_render__output_too_short(void)
+{
+	char output[8];
+	int r;
+
+	r = template_render("foo bar baz", output, sizeof(output), &errstr);
+
+	return (
+	    assert_int_equals(r, -1) &&
+	    assert_string_equals(errstr,
+		"output buffer too short for rendered template")
 	);
 }
 
 static int
 test_template_render__empty(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char input[MAX_OUTPUT_LEN] = "";
+	char output[MAX_OUTPUT_LEN];
 	int i;
 
 	i = template_render(input, output, MAX_OUTPUT_LEN, &errstr);
@@ -132,15 +161,15 @@ test_template_render__empty(void)
 	return (
 	    assert_int_equals(i, 0) &&
 	    assert_null(errstr) &&
-	    assert_wstring_equals(output, L"")
+	    assert_string_equals(output, "")
 	);
 }
 
 static int
 test_template_render__just_static(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo bar and foobaz";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char input[MAX_OUTPUT_LEN] = "foo bar and foobaz";
+	char output[MAX_OUTPUT_LEN];
 	int i;
 
 	i = template_render(input, output, MAX_OUTPUT_LEN, &errstr);
@@ -148,7 +177,7 @@ test_template_render__just_static(void)
 	return (
 	    assert_int_equals(i, 0) &&
 	    assert_null(errstr) &&
-	    assert_wstring_equals(output, L"foo bar and foobaz")
+	    assert_string_equals(output, "foo bar and foobaz")
 	);
 }
 
@@ -169,12 +198,12 @@ test_template_arglist__insert_one(void)
 	size_t argc;
 
 	template_arglist_init(&al);
-	argc = template_arglist_insert(&al, L"foo");
+	argc = template_arglist_insert(&al, "foo");
 
 	return (
 	    assert_int_equals(argc, 1) &&
 	    assert_int_equals(al.argc, 1) &&
-	    assert_wstring_equals(al.argv[0], L"foo")
+	    assert_string_equals(al.argv[0], "foo")
 	);
 }
 
@@ -185,96 +214,65 @@ test_template_arglist__insert_many(void)
 	size_t argc;
 
 	template_arglist_init(&al);
-	argc = template_arglist_insert(&al, L"foo");
-	argc = template_arglist_insert(&al, L"bar");
-	argc = template_arglist_insert(&al, L"baz");
+	argc = template_arglist_insert(&al, "foo");
+	argc = template_arglist_insert(&al, "bar");
+	argc = template_arglist_insert(&al, "baz");
 
 	return (
 	    assert_int_equals(argc, 3) &&
 	    assert_int_equals(al.argc, 3) &&
-	    assert_wstring_equals(al.argv[0], L"foo") &&
-	    assert_wstring_equals(al.argv[1], L"bar") &&
-	    assert_wstring_equals(al.argv[2], L"baz")
+	    assert_string_equals(al.argv[0], "foo") &&
+	    assert_string_equals(al.argv[1], "bar") &&
+	    assert_string_equals(al.argv[2], "baz")
 	);
 }
 
 static int
-test_template_arglist__insert_err_too_many_args(void)
+test_template_arglist__insert_grows(void)
 {
 	struct arglist al;
-	size_t argc;
-	wchar_t s[] = L"foobar0";
-	int i, a;
+	size_t i, argc = 0;
+	char s[] = "foobar0";
 
 	template_arglist_init(&al);
-
-	/* Add just enough arguments to border the limit */
-	for (i = 0; i < MAX_ARG_COUNT; i++) {
+	for (i = 0; i < 1000; i++) {
 		argc = template_arglist_insert(&al, s);
-		if (argc == (size_t)-1) {
+		if (argc == (size_t)-1)
 			return (0);
-		}
 	}
 
-	a = (
-	    assert_int_equals(argc, MAX_ARG_COUNT) &&
-	    assert_int_equals(al.argc, MAX_ARG_COUNT) &&
-	    assert_wstring_equals(al.argv[0], s) &&
-	    assert_wstring_equals(al.argv[MAX_ARG_COUNT - 1], s)
+	return (
+	    assert_size_t_equals(argc, 1000) &&
+	    assert_string_equals(al.argv[0], s) &&
+	    assert_string_equals(al.argv[999], s) &&
+	    assert_null(al.argv[1000])
 	);
-
-	if (!a)
-		return (a);
-
-	/* This final insert should cause an error. */
-	argc = template_arglist_insert(&al, s);
-	return (assert_size_t_equals(argc, (size_t)-1));
 }
 
 static int
-test_template_arglist__insert_err_too_many_chars(void)
+test_template_arglist__insert_err_arena_full(void)
 {
 	struct arglist al;
-	size_t i, argc = 0, max;
-	wchar_t s[] = L"foobarfoobarfoobarfoobarfoobarfoobarfoobarfoobar" \
-		      L"foobarfoobarfoobarfoobarfoobarfoobarfoobarfoobar";
-	int a;
+	size_t argc, mark;
 
+	mark = arena_mark();
 	template_arglist_init(&al);
+	arena_alloc(ARENA_SIZE - arena_mark() - 16);
+	argc = template_arglist_insert(&al, "foo");
+	arena_release(mark);
 
-	max = MAX_ARGLIST_SIZE / (wcslen(s) + 1);
-
-	for (i = 0; i < max; i++) {
-		argc = template_arglist_insert(&al, s);
-		if (argc == (size_t)-1) {
-			break;
-		}
-	}
-
-	a = (
-	    assert_size_t_equals(argc, max) &&
-	    assert_size_t_equals(al.argc, max) &&
-	    assert_wstring_equals(al.argv[0], s) &&
-	    assert_wstring_equals(al.argv[max - 1], s)
-	);
-
-	if (!a)
-		return (a);
-
-	/* This final insert should cause an error. */
-	argc = template_arglist_insert(&al, s);
 	return (assert_size_t_equals(argc, (size_t)-1));
 }
 
 static int
 test_template_variable_lexer__empty(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"";
+	char input[MAX_OUTPUT_LEN] = "";
 	int i;
 	struct arglist al;
 
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
 
 	return (
 	    assert_int_equals(i, 0) &&
@@ -285,175 +283,661 @@ test_template_variable_lexer__empty(void)
 static int
 test_template_variable_lexer__one(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foobar";
+	char input[MAX_OUTPUT_LEN] = "foobar";
 	int i;
 	struct arglist al;
 
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
 
 	return (
 	    assert_int_equals(i, 1) &&
 	    assert_null(errstr) &&
-	    assert_wstring_equals(al.argv[0], L"foobar")
+	    assert_string_equals(al.argv[0], "foobar")
 	);
 }
 
 static int
 test_template_variable_lexer__two(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo bar";
+	char input[MAX_OUTPUT_LEN] = "foo bar";
 	int i;
 	struct arglist al;
 
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
 
 	return (
 	    assert_int_equals(i, 2) &&
 	    assert_null(errstr) &&
-	    assert_wstring_equals(al.argv[0], L"foo") &&
-	    assert_wstring_equals(al.argv[1], L"bar")
+	    assert_string_equals(al.argv[0], "foo") &&
+	    assert_string_equals(al.argv[1], "bar")
 	);
 }
 
 static int
 test_template_variable_lexer__trailing_spaces(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo ";
+	char input[MAX_OUTPUT_LEN] = "foo ";
 	int i;
 	struct arglist al;
 
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
 
 	return (
 	    assert_int_equals(i, 1) &&
 	    assert_null(errstr) &&
-	    assert_wstring_equals(al.argv[0], L"foo")
+	    assert_string_equals(al.argv[0], "foo")
 	);
 }
 
 static int
 test_template_variable_lexer__quoted_space(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo \"bar baz\"";
+	char input[MAX_OUTPUT_LEN] = "foo \"bar baz\"";
 	int i;
 	struct arglist al;
 
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
 
 	return (
 	    assert_int_equals(i, 2) &&
 	    assert_null(errstr) &&
-	    assert_wstring_equals(al.argv[0], L"foo") &&
-	    assert_wstring_equals(al.argv[1], L"bar baz")
+	    assert_string_equals(al.argv[0], "foo") &&
+	    assert_string_equals(al.argv[1], "bar baz")
 	);
 }
 
 static int
 test_template_variable_lexer__quoted_quote(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo \"bar\\\"baz\"";
+	char input[MAX_OUTPUT_LEN] = "foo \"bar\\\"baz\"";
 	int i;
 	struct arglist al;
 
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
 
 	return (
 	    assert_int_equals(i, 2) &&
 	    assert_null(errstr) &&
-	    assert_wstring_equals(al.argv[0], L"foo") &&
-	    assert_wstring_equals(al.argv[1], L"bar\"baz")
+	    assert_string_equals(al.argv[0], "foo") &&
+	    assert_string_equals(al.argv[1], "bar\"baz")
 	);
 }
 
 static int
 test_template_variable_lexer__quoted_double_quote(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo \"bar\"\"baz\"";
+	char input[MAX_OUTPUT_LEN] = "foo \"bar\"\"baz\"";
 	int i;
 	struct arglist al;
 
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
 
 	return (
 	    assert_int_equals(i, 2) &&
 	    assert_null(errstr) &&
-	    assert_wstring_equals(al.argv[0], L"foo") &&
-	    assert_wstring_equals(al.argv[1], L"barbaz")
+	    assert_string_equals(al.argv[0], "foo") &&
+	    assert_string_equals(al.argv[1], "barbaz")
 	);
 }
 
 static int
 test_template_variable_lexer__unmatched_quote(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo \"bar";
+	char input[MAX_OUTPUT_LEN] = "foo \"bar";
 	size_t i;
 	struct arglist al;
 
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
 
 	return (
 	    assert_size_t_equals(i, (size_t)-1) &&
-	    assert_wstring_equals(errstr, L"unmatched quote")
+	    assert_string_equals(errstr, "unmatched quote")
 	);
 }
 
 static int
 test_template_variable_lexer__large_arg(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN + 1];
+	char input[MAX_OUTPUT_LEN + 1];
 	size_t i;
 	struct arglist al;
 
-	wmemset(input, L'?', MAX_OUTPUT_LEN + 1);
-	input[MAX_OUTPUT_LEN] = L'\0';
+	memset(input, '?', MAX_OUTPUT_LEN + 1);
+	input[MAX_OUTPUT_LEN] = '\0';
 
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
 
 	return (assert_size_t_equals(i, 1));
 }
 
 static int
-test_template_variable_lexer__err_arg_size(void)
+test_template_variable_lexer__long_arg(void)
 {
-	wchar_t input[MAX_ARGLIST_SIZE * 2 + 1];
+	char input[8192 + 1];
 	size_t i;
 	struct arglist al;
 
-	wmemset(input, L'?', MAX_ARGLIST_SIZE * 2 + 1);
-	input[MAX_ARGLIST_SIZE * 2] = L'\0';
+	memset(input, '?', sizeof(input) - 1);
+	input[sizeof(input) - 1] = '\0';
 
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
 
 	return (
-	    assert_size_t_equals(i, (size_t)-1) &&
-	    assert_wstring_equals(errstr, L"argument list too large")
+	    assert_size_t_equals(i, 1) &&
+	    assert_size_t_equals(strlen(al.argv[0]), 8192)
 	);
 }
 
 static int
-test_template_variable_lexer__err_too_many(void)
+test_template_variable_lexer__many_args(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"f o o b a r f o o b a r f o o b a " \
-					L"f o o b a r f o o b a r f o o b a " \
-					L"f o o b a r f o o b a r f o o b a " \
-					L"f o o b a r f o o b a r f o o b a ";
-	int i;
+	char input[MAX_OUTPUT_LEN] = "f o o b a r f o o b a r f o o b a " \
+					"f o o b a r f o o b a r f o o b a " \
+					"f o o b a r f o o b a r f o o b a " \
+					"f o o b a r f o o b a r f o o b a ";
+	size_t i;
+	struct arglist al;
+
+	template_arglist_init(&al);
+	i = template_variable_lexer(input, strlen(input), &al, &errstr);
+
+	return (
+	    assert_size_t_equals(i, 68) &&
+	    assert_string_equals(al.argv[67], "a")
+	);
+}
+
+static int
+test_template_variable_lexer__err_arena_full(void)
+{
+	size_t i, mark;
 	struct arglist al;
 
+	mark = arena_mark();
+	arena_alloc(ARENA_SIZE - arena_mark());
 	template_arglist_init(&al);
-	i = template_variable_lexer(input, &al, &errstr);
+	i = template_variable_lexer("path -l 3", 9, &al, &errstr);
+	arena_release(mark);
+
+	return (
+	    assert_size_t_equals(i, (size_t)-1) &&
+	    assert_string_equals(errstr, "argument list too large")
+	);
+}
+
+/*
+ * The scratch memory of the commands is given back after each render.
+ */
+static int
+test_template_render__arena_released(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	size_t mark;
+
+	strlcpy(test_hostname_value, "foobar.example.com", MAXHOSTNAMELEN);
+	mark = arena_mark();
+	template_render("${hostname} ${path}", output, sizeof(output),
+	    &errstr);
+
+	return (assert_size_t_equals(arena_mark(), mark));
+}
+
+static int
+test_template_render__memoized_command(void)
+{
+	char input[MAX_OUTPUT_LEN] = "${hostname}:${hostname -l}";
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	strlcpy(test_hostname_value, "foobar.example.com", MAXHOSTNAMELEN);
+	i = template_render(input, output, MAX_OUTPUT_LEN, &errstr);
+
+	/* A second template sees the same results, even if the host changed. */
+	strlcpy(test_hostname_value, "other.example.com", MAXHOSTNAMELEN);
+	i += template_render("${hostname}", output + strlen(output),
+	    MAX_OUTPUT_LEN - strlen(output), &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_null(errstr) &&
+	    assert_string_equals(output, "foobar:foobar.example.comfoobar")
+	);
+}
+
+static int
+test_template_render_many__shared(void)
+{
+	char left[MAX_OUTPUT_LEN], right[MAX_OUTPUT_LEN];
+	struct rendering r[2] = {
+		{ "template", "${hostname}> ", left, MAX_OUTPUT_LEN, 0, 0 },
+		{ "rtemplate", "<${hostname -l}", right, MAX_OUTPUT_LEN, 0, 0 },
+	};
+	int i;
+
+	strlcpy(test_hostname_value, "foobar.example.com", MAXHOSTNAMELEN);
+	i = template_render_many(r, 2, &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_null(errstr) &&
+	    assert_string_equals(left, "foobar> ") &&
+	    assert_string_equals(right, "<foobar.example.com") &&
+	    assert_size_t_equals(r[0].width, 8) &&
+	    assert_size_t_equals(r[1].width, 19)
+	);
+}
+
+static int
+test_template_render__if(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	strlcpy(test_hostname_value, "foobar", MAXHOSTNAMELEN);
+	i = template_render("a${if hostname foo*}b${else}c${endif}d", output,
+	    MAX_OUTPUT_LEN, &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_null(errstr) &&
+	    assert_string_equals(output, "abd")
+	);
+}
+
+static int
+test_template_render__if_else(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	strlcpy(test_hostname_value, "foobar", MAXHOSTNAMELEN);
+	i = template_render("a${if hostname lab}b${else}c${endif}d", output,
+	    MAX_OUTPUT_LEN, &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_null(errstr) &&
+	    assert_string_equals(output, "acd")
+	);
+}
+
+/*
+ * Nothing within a branch not taken is evaluated, not even the conditions of
+ * the nested ifs.
+ */
+static int
+test_template_render__if_lazy(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	const char **names;
+	size_t count;
+	int i;
+
+	strlcpy(test_hostname_value, "foobar", MAXHOSTNAMELEN);
+	path_cwd_calls = 0;
+	i = template_render("${if hostname lab}${path}"
+	    "${if vcs git}${branch}${endif}${endif}>", output,
+	    MAX_OUTPUT_LEN, &errstr);
+	names = facts_evaluated(&count);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(output, ">") &&
+	    assert_int_equals(path_cwd_calls, 0) &&
+	    assert_size_t_equals(count, 1) &&
+	    assert_string_equals(names[0], "hostname")
+	);
+}
+
+static int
+test_template_render__if_nested(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	strlcpy(test_hostname_value, "foobar", MAXHOSTNAMELEN);
+	i = template_render("${if hostname foobar}1${if hostname lab}2${else}3"
+	    "${endif}4${else}5${if hostname foobar}6${endif}${endif}", output,
+	    MAX_OUTPUT_LEN, &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(output, "134")
+	);
+}
+
+static int
+test_template_render__if_no_endif(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	i = template_render("${if uid 0}#", output, MAX_OUTPUT_LEN, &errstr);
+
+	return (
+	    assert_int_equals(i, -1) &&
+	    assert_string_equals(errstr, "if without endif")
+	);
+}
+
+static int
+test_template_render__endif_no_if(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	i = template_render("#${endif}", output, MAX_OUTPUT_LEN, &errstr);
+
+	return (
+	    assert_int_equals(i, -1) &&
+	    assert_string_equals(errstr, "else or endif without if")
+	);
+}
+
+static int
+test_template_render__if_bad_condition(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	i = template_render("${if vcs}x${endif}", output, MAX_OUTPUT_LEN,
+	    &errstr);
+
+	return (
+	    assert_int_equals(i, -1) &&
+	    assert_string_equals(errstr, "if needs a condition and a value")
+	);
+}
+
+static int
+test_template_compile__ok(void)
+{
+	int i;
+
+	i = template_compile("${if uid 0}#${else}${path -c -l 8}${endif}",
+	    &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_null(errstr)
+	);
+}
+
+static int
+test_template_compile__bad_arg(void)
+{
+	int i;
+
+	i = template_compile("${hostname} ${color -x}", &errstr);
+
+	return (
+	    assert_int_equals(i, -1) &&
+	    assert_string_equals(errstr, "<color-bad-arg> in ${color -x}")
+	);
+}
+
+static int
+test_template_compile__unknown_command(void)
+{
+	int i;
+
+	i = template_compile("${if uid 0}${foobar}${endif}", &errstr);
+
+	return (
+	    assert_int_equals(i, -1) &&
+	    assert_string_equals(errstr, "unknown command")
+	);
+}
+
+static int
+test_template_compile__no_endif(void)
+{
+	int i;
+
+	i = template_compile("${if uid 0}${else}", &errstr);
 
 	return (
 	    assert_int_equals(i, -1) &&
-	    assert_wstring_equals(errstr, L"argument list too large")
+	    assert_string_equals(errstr, "if without endif")
+	);
+}
+
+/*
+ * A compiled command is only executed on render, with the options it was
+ * compiled with.
+ */
+static int
+test_template_render__compiled(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	strlcpy(test_hostname_value, "foobar.example.com", MAXHOSTNAMELEN);
+	i = template_compile("${hostname -l}", &errstr);
+	i += template_render("${hostname -l}", output, MAX_OUTPUT_LEN,
+	    &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_null(errstr) &&
+	    assert_string_equals(output, "foobar.example.com")
+	);
+}
+
+/*
+ * Templates that were never compiled still show the error in place.
+ */
+static int
+test_template_render__not_compiled_bad_arg(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	i = template_render("${path -l 999}", output, MAX_OUTPUT_LEN, &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(output, "<path-bad-arg>")
+	);
+}
+
+static int
+test_template_render_fit__fits(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	strlcpy(test_hostname_value, "foobar", MAXHOSTNAMELEN);
+	strlcpy(path_cwd_fakepwd, "/usr/local/share/doc/prwd", MAXPATHLEN);
+	alias_purge_all();
+	i = template_render_fit("${segment 1}${hostname}:${endsegment}"
+	    "${path}$ ", output, MAX_OUTPUT_LEN, 40, &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(output, "foobar:/usr/local/share/doc/prwd$ ")
+	);
+}
+
+/*
+ * The path gives up what it can before any segment is dropped.
+ */
+static int
+test_template_render_fit__cut_path(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	strlcpy(test_hostname_value, "foobar", MAXHOSTNAMELEN);
+	strlcpy(path_cwd_fakepwd, "/usr/local/share/doc/prwd", MAXPATHLEN);
+	alias_purge_all();
+	i = template_render_fit("${segment 1}${hostname}:${endsegment}"
+	    "${path -c}$ ", output, MAX_OUTPUT_LEN, 30, &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(output, "foobar:.../share/doc/prwd$ ")
+	);
+}
+
+static int
+test_template_render_fit__drop_segment(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	strlcpy(test_hostname_value, "foobar", MAXHOSTNAMELEN);
+	strlcpy(path_cwd_fakepwd, "/usr/local/share/doc/prwd", MAXPATHLEN);
+	alias_purge_all();
+	i = template_render_fit("${segment 1}${hostname}:${endsegment}"
+	    "${path}$ ", output, MAX_OUTPUT_LEN, 15, &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(output, "...e/doc/prwd$ ")
+	);
+}
+
+/*
+ * A path shortened by -n (or -u) ignores any length, it has nothing to give
+ * up and the segment goes.
+ */
+static int
+test_template_render_fit__newsgroup_path(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	strlcpy(test_hostname_value, "foobar", MAXHOSTNAMELEN);
+	strlcpy(path_cwd_fakepwd, "/usr/local/share/doc/prwd", MAXPATHLEN);
+	alias_purge_all();
+	i = template_render_fit("${segment 1}${hostname}:${endsegment}"
+	    "${path -n}$ ", output, MAX_OUTPUT_LEN, 20, &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(output, "/u/l/s/d/prwd$ ")
+	);
+}
+
+static int
+test_template_render_fit__priorities(void)
+{
+	char tmpl[] = "${segment 2}abc${endsegment}${segment 1}defg${endsegment}x";
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	i = template_render_fit(tmpl, output, MAX_OUTPUT_LEN, 4, &errstr);
+	i += template_render_fit(tmpl, output + 10, MAX_OUTPUT_LEN - 10, 2,
+	    &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(output, "abcx") &&
+	    assert_string_equals(output + 10, "x")
+	);
+}
+
+/*
+ * Static parts and commands other than paths are laid out together, there can
+ * be any number of them.
+ */
+static int
+test_template_render_fit__many_parts(void)
+{
+	char tmpl[MAX_OUTPUT_LEN], expected[MAX_OUTPUT_LEN];
+	char output[MAX_OUTPUT_LEN];
+	size_t i, cur = 0;
+	int ret;
+
+	for (i = 0; i < 70; i++) {
+		cur += snprintf(tmpl + cur, sizeof(tmpl) - cur, "${hostname}");
+		expected[i] = 'a';
+	}
+	strlcpy(tmpl + cur, "${path}$ ", sizeof(tmpl) - cur);
+	strlcpy(expected + i, "...e/doc/prwd$ ", sizeof(expected) - i);
+
+	strlcpy(test_hostname_value, "a", MAXHOSTNAMELEN);
+	strlcpy(path_cwd_fakepwd, "/usr/local/share/doc/prwd", MAXPATHLEN);
+	alias_purge_all();
+	ret = template_render_fit(tmpl, output, MAX_OUTPUT_LEN, 70 + 15,
+	    &errstr);
+
+	return (
+	    assert_int_equals(ret, 0) &&
+	    assert_string_equals(output, expected)
+	);
+}
+
+static int
+test_template_render__segments_ignored(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	int i;
+
+	i = template_render("${segment 1}a${endsegment}b", output,
+	    MAX_OUTPUT_LEN, &errstr);
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_string_equals(output, "ab")
+	);
+}
+
+static int
+test_template_compile__segment_errors(void)
+{
+	const char *e1, *e2, *e3, *e4;
+
+	template_compile("${segment}x${endsegment}", &e1);
+	template_compile("${segment 1}${segment 2}", &e2);
+	template_compile("${endsegment}", &e3);
+	template_compile("${segment 100}x", &e4);
+
+	return (
+	    assert_string_equals(e1, "segment needs a priority (0-99)") &&
+	    assert_string_equals(e2, "segment inside a segment") &&
+	    assert_string_equals(e3, "endsegment without segment") &&
+	    assert_string_equals(e4, "segment needs a priority (0-99)")
+	);
+}
+
+/*
+ * The layout makes room for as many segments and paths as the template has,
+ * templates are not limited by it.
+ */
+static int
+test_template_render_fit__many_segments(void)
+{
+	char tmpl[MAX_OUTPUT_LEN], paths[MAX_OUTPUT_LEN];
+	char output[MAX_OUTPUT_LEN];
+	const char *e1, *e2;
+	size_t i, cur = 0;
+	int ret;
+
+	for (i = 0; i < 20; i++)
+		cur += snprintf(tmpl + cur, sizeof(tmpl) - cur,
+		    "${segment %zu}ab${endsegment}", i);
+	strlcpy(tmpl + cur, "x", sizeof(tmpl) - cur);
+	template_compile(tmpl, &e1);
+	ret = template_render_fit(tmpl, output, MAX_OUTPUT_LEN, 5, &errstr);
+
+	for (i = 0, cur = 0; i < 40; i++)
+		cur += strlcpy(paths + cur, "${path}", sizeof(paths) - cur);
+	template_compile(paths, &e2);
+
+	return (
+	    assert_null(e1) && assert_null(e2) &&
+	    assert_int_equals(ret, 0) &&
+	    assert_string_equals(output, "ababx")
 	);
 }
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Render the trace report in buf.
+ */
+static void
+trace_report_string(char *buf, size_t len)
+{
+	FILE *fp;
+	size_t n;
+
+	buf[0] = '\0';
+	if ((fp = tmpfile()) == NULL)
+		return;
+	trace_report(fp);
+	rewind(fp);
+	n = fread(buf, 1, len - 1, fp);
+	buf[n] = '\0';
+	fclose(fp);
+}
+
+static int
+test_trace__off(void)
+{
+	char buf[1024];
+	int span;
+
+	span = trace_begin("config", 6);
+	trace_end(span);
+	trace_report_string(buf, sizeof(buf));
+
+	return (assert_int_equals(span, -1) && assert_string_equals(buf, ""));
+}
+
+static int
+test_trace__spans_are_merged(void)
+{
+	char output[MAX_OUTPUT_LEN], buf[4096];
+	int i;
+
+	trace_format = TRACE_JSON;
+	strlcpy(test_hostname_value, "foobar", MAXHOSTNAMELEN);
+	i = template_render("${hostname}:${uid}:${hostname}", output,
+	    MAX_OUTPUT_LEN, &errstr);
+	trace_report_string(buf, sizeof(buf));
+
+	return (
+	    assert_int_equals(i, 0) &&
+	    assert_int_equals(strstr(buf, "{\"name\":\"tokenize\",\"calls\":6,")
+	        != NULL, 1) &&
+	    assert_int_equals(strstr(buf, "{\"name\":\"${hostname}\",\"calls\":2,")
+	        != NULL, 1) &&
+	    assert_int_equals(strstr(buf, "{\"name\":\"lex\",\"calls\":2,")
+	        != NULL, 1)
+	);
+}
+
+/*
+ * Looking up a cache entry costs a mkdir(2) and lstat(2) of the cache
+ * directory and an open(2) of the entry.
+ */
+static int
+test_trace__fs_calls(void)
+{
+	char base[MAXPATHLEN] = "/tmp/prwd-test-XXXXXX", dir[MAXPATHLEN];
+	char buf[4096];
+	int span;
+
+	if (mkdtemp(base) == NULL)
+		return (0);
+	setenv("XDG_RUNTIME_DIR", base, 1);
+
+	trace_format = TRACE_JSON;
+	span = trace_begin("cache", 5);
+	cache_read("nonexistent", buf, sizeof(buf));
+	trace_end(span);
+	trace_report_string(buf, sizeof(buf));
+
+	snprintf(dir, sizeof(dir), "%s/prwd", base);
+	rmdir(dir);
+	rmdir(base);
+
+	return (assert_int_equals(strstr(buf, "\"fs_calls\":3}") != NULL, 1));
+}
+
+static int
+test_trace__json_escape(void)
+{
+	char buf[4096];
+
+	trace_format = TRACE_JSON;
+	trace_end(trace_begin("a\"b\\c", 5));
+	trace_report_string(buf, sizeof(buf));
+
+	return (assert_int_equals(
+	    strstr(buf, "{\"name\":\"a\\\"b\\\\c\",") != NULL, 1));
+}
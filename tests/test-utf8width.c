@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2025 Bertrand Janin <b@janin.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+static int
+test_utf8width__ascii_detection(void)
+{
+	return (
+	    assert_int_equals(utf8_is_ascii("/usr/local/share/doc", 20), 1) &&
+	    assert_int_equals(utf8_is_ascii("/usr/local/share/dö", 20), 0) &&
+	    assert_int_equals(utf8_is_ascii("/ö", 3), 0) &&
+	    assert_int_equals(utf8_is_ascii("", 0), 1)
+	);
+}
+
+static int
+test_utf8width__width(void)
+{
+	return (
+	    assert_int_equals(utf8_width("/usr/local"), 10) &&
+	    assert_int_equals(utf8_width("föö"), 3) &&
+	    assert_int_equals(utf8_width("日本語"), 6) &&
+	    assert_int_equals(utf8_width("e\xcc\x81t\xc3\xa9"), 3) &&
+	    assert_int_equals(utf8_width("\xf0\x9f\x90\x8d"), 2)
+	);
+}
+
+static int
+test_utf8width__invalid_sequence(void)
+{
+	uint32_t cp;
+	size_t n;
+
+	n = utf8_decode("\xe6\x97", &cp);
+
+	return (
+	    assert_int_equals(n, 1) &&
+	    assert_int_equals(cp, 0xFFFD) &&
+	    assert_int_equals(utf8_width("a\xff" "b"), 3)
+	);
+}
@@ -17,47 +17,69 @@
 static int
 test_utils__tokcpy__unchanged(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char input[MAX_OUTPUT_LEN] = "foo";
+	char output[MAX_OUTPUT_LEN];
 	tokcpy(input, output);
 	return (
-	    assert_wstring_equals(input, L"foo") &&
-	    assert_wstring_equals(output, L"foo")
+	    assert_string_equals(input, "foo") &&
+	    assert_string_equals(output, "foo")
 	);
 }
 
 static int
 test_utils__tokcpy__with_slash(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"foo/bar";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char input[MAX_OUTPUT_LEN] = "foo/bar";
+	char output[MAX_OUTPUT_LEN];
 	tokcpy(input, output);
 	return (
-	    assert_wstring_equals(input, L"foo/bar") &&
-	    assert_wstring_equals(output, L"foo")
+	    assert_string_equals(input, "foo/bar") &&
+	    assert_string_equals(output, "foo")
 	);
 }
 
 static int
 test_utils__tokcpy__empty_string(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char input[MAX_OUTPUT_LEN] = "";
+	char output[MAX_OUTPUT_LEN];
 	tokcpy(input, output);
 	return (
-	    assert_wstring_equals(input, L"") &&
-	    assert_wstring_equals(output, L"")
+	    assert_string_equals(input, "") &&
+	    assert_string_equals(output, "")
 	);
 }
 
 static int
 test_utils__tokcpy__just_a_slash(void)
 {
-	wchar_t input[MAX_OUTPUT_LEN] = L"/";
-	wchar_t output[MAX_OUTPUT_LEN];
+	char input[MAX_OUTPUT_LEN] = "/";
+	char output[MAX_OUTPUT_LEN];
 	tokcpy(input, output);
 	return (
-	    assert_wstring_equals(input, L"/") &&
-	    assert_wstring_equals(output, L"")
+	    assert_string_equals(input, "/") &&
+	    assert_string_equals(output, "")
+	);
+}
+
+static int
+test_utils__utf8_len__multibyte(void)
+{
+	return (
+	    assert_int_equals(utf8_len("föö"), 3) &&
+	    assert_int_equals(utf8_len(""), 0)
+	);
+}
+
+static int
+test_utils__utf8_ncpy__truncates_on_characters(void)
+{
+	char output[MAX_OUTPUT_LEN];
+	size_t n;
+
+	n = utf8_ncpy(output, "ünïcode", sizeof(output), 3);
+	return (
+	    assert_string_equals(output, "ünï") &&
+	    assert_int_equals(n, 3)
 	);
 }
@@ -14,26 +14,50 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <ftw.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <wchar.h>
+#include <time.h>
 #include <unistd.h>
 #include <locale.h>
 
 #include "alias.h"
+#include "arena.h"
+#include "cache.h"
 #include "config.h"
+#include "context.h"
+#include "facts.h"
+#include "fqdn.h"
+#include "output.h"
+#include "utf8width.h"
 #include "utils.h"
 #include "prwd.h"
 #include "template.h"
+#include "trace.h"
 #include "strlcpy.h"
-#include "wcslcpy.h"
+#include "cmd-color.h"
 #include "cmd-path.h"
+#include "cmd-exec.h"
 #include "cmd-hostname.h"
+#include "shell.h"
+#include "stats.h"
 
 #define RUN_TEST(f)						\
 	printf("%-60s", #f);					\
 	fflush(stdout);						\
 	errstr = NULL;						\
+	facts_purge_all();					\
+	template_memo_purge_all();				\
+	context_purge_all();					\
+	trace_purge_all();					\
+	stats_close();						\
+	arena_release(0);					\
+	shell_init(SHELL_RAW, 0);				\
 	if (f()) {						\
 		printf("PASS\n");				\
 		passed++;					\
@@ -44,7 +68,7 @@
 			details[0] = '\0';			\
 		}						\
 		if (errstr != NULL) {				\
-			printf("%17s%ls\n", "errstr=", errstr);	\
+			printf("%17s%s\n", "errstr=", errstr);	\
 		}						\
 		failed++;					\
 	};							\
@@ -56,10 +80,12 @@
 		return (1);					\
 	}							\
 
-extern wchar_t cfg_filler[MAX_FILLER_LEN];
+extern char cfg_filler[MAX_FILLER_LEN];
 extern size_t cfg_maxpwdlen;
+extern char cfg_rtemplate[MAX_OUTPUT_LEN];
+extern char cfg_title[MAX_OUTPUT_LEN];
 extern int alias_count;
-const wchar_t *errstr;
+const char *errstr;
 char details[256] = "";
 char test_hostname_value[MAXHOSTNAMELEN];
 int tested = 0;
@@ -67,17 +93,35 @@ int passed = 0;
 int failed = 0;
 int test_file_exists = 1;
 
-/* Used in the below path_wcswd() override. */
-wchar_t path_wcswd_fakepwd[MAXPATHLEN] = L"/tmp";
+/* Used in the below path_cwd() override. */
+char path_cwd_fakepwd[MAXPATHLEN] = "/tmp";
+int path_cwd_calls = 0;
 
 /*
  * Override with predictable path.
  */
 void
-path_wcswd(wchar_t *wcswd, size_t len, const wchar_t **errstr)
+path_cwd(char *wd, size_t len, struct stat *sb, const char **errstr)
 {
 	(void)errstr;
-	wcslcpy(wcswd, path_wcswd_fakepwd, len);
+	path_cwd_calls++;
+	memset(sb, 0, sizeof(*sb));
+	strlcpy(wd, path_cwd_fakepwd, len);
+}
+
+/*
+ * Override with the fake path, resolved if it exists on this system.
+ */
+void
+path_cwd_physical(char *wd, size_t len, const char **errstr)
+{
+	char resolved[MAXPATHLEN];
+
+	*errstr = NULL;
+	if (realpath(path_cwd_fakepwd, resolved) != NULL)
+		strlcpy(wd, resolved, len);
+	else
+		strlcpy(wd, path_cwd_fakepwd, len);
 }
 
 /*
@@ -91,12 +135,17 @@ lgethostname(char *name, size_t namelen)
 }
 
 /*
- * Override file_exists to ensure predictable returns.
+ * Override file_exists to ensure predictable returns, -1 checks the actual
+ * file system.
  */
 int
 path_is_valid(char *filepath)
 {
-	(void)filepath;
+	struct stat sb;
+
+	if (test_file_exists == -1)
+		return (stat(filepath, &sb) == 0);
+
 	return (test_file_exists);
 }
 
@@ -122,25 +171,6 @@ bad:
 	return (0);
 }
 
-static int
-assert_wstring_equals(const wchar_t *value, const wchar_t *expected)
-{
-	if (value == NULL && expected != NULL)
-		goto bad;
-	if (value != NULL && expected == NULL)
-		goto bad;
-
-	if (wcscmp(value, expected) == 0)
-		return (1);
-
-bad:
-	snprintf(details, sizeof(details),
-	    "    wide strings do not match:\n"
-	    "           value=\"%ls\"\n"
-	    "        expected=\"%ls\"", value, expected);
-	return (0);
-}
-
 static int
 assert_int_equals(int value, int expected)
 {